@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+
+/**
+ * Number of heap allocations made through the global operator new since startup
+ *
+ * Only counted when built with COUNT_ALLOCATIONS, which replaces the global operator new/delete; always
+ * 0 otherwise. Meant to check that the frame loop reaches zero allocations per frame in steady state.
+ */
+uint64_t get_allocation_count();
@@ -11,6 +11,19 @@ struct GL_AttribElement
     int32_t normalized;
     uint32_t data_size;
     uint32_t stride;
+    uint32_t offset;
+};
+
+
+/**
+ * Flat description of a vertex layout, shared by runtime (`GL_AttribArray`) and compile-time
+ * (`GL_VertexLayout`) layouts so a VAO is configured from a single table either way
+ */
+struct GL_LayoutTable
+{
+    const GL_AttribElement* elements;
+    uint32_t count;
+    uint32_t stride;
 };
 
 
@@ -31,4 +44,5 @@ public:
     inline const GL_AttribElement& get(uint32_t idx) const { return m_layout[idx]; }
     inline uint32_t get_count() const { return (uint32_t)m_layout.size(); }
     inline uint32_t get_stride() const { return m_stride; }
+    inline GL_LayoutTable get_table() const { return { m_layout.data(), get_count(), m_stride }; }
 };
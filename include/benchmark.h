@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+
+struct BenchmarkOptions
+{
+    // Quads per side of the mesh optimizer's large grid mesh (two triangles each)
+    uint32_t grid_size = 512;
+    // Objects in the culling benchmarks
+    uint32_t object_count = 1000000;
+    // Software renderer frame size
+    uint32_t frame_width = 1920;
+    uint32_t frame_height = 1080;
+};
+
+
+/**
+ * CPU benchmarks, started with `--benchmark`; they need no window or GL context, so they also run on
+ * build machines without a GPU or Mesa
+ *
+ * Timed benchmarks report the median of several runs after a warm-up run. Results are logged rather than
+ * checked against baselines, since timings only compare between runs on the same machine.
+ */
+class BenchmarkSuite
+{
+private:
+    BenchmarkOptions m_options;
+
+private:
+    void run_mesh_optimizer(uint32_t grid_size);
+    void run_frustum_culling();
+    void run_bvh();
+    void run_software_renderer();
+
+public:
+    explicit BenchmarkSuite(const BenchmarkOptions& options);
+
+    BenchmarkSuite(const BenchmarkSuite&) = delete;
+    BenchmarkSuite& operator=(const BenchmarkSuite&) = delete;
+
+    void run();
+};
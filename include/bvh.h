@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "frustum_culling.h"
+
+
+/**
+ * Flattened BVH node (32 bytes, two per cache line); interior nodes have `object_count` 0 and their
+ * children stored next to each other at `first` and `first + 1`, leaves own `object_count` entries of
+ * the object reference array starting at `first`
+ */
+struct BVH_Node
+{
+    float bounds_min[3];
+    uint32_t first;
+    float bounds_max[3];
+    uint32_t object_count;
+};
+
+
+// Contiguous run of the object reference array
+struct BVH_RefRange
+{
+    uint32_t first;
+    uint32_t count;
+};
+
+
+struct BVH_RayHit
+{
+    uint32_t object_index;
+    float distance;
+};
+
+
+struct BVH_Stats
+{
+    uint32_t node_count;
+    uint32_t leaf_count;
+    uint32_t max_depth;
+    size_t memory_size;
+    double build_ms;
+};
+
+
+/**
+ * Bounding volume hierarchy over object AABBs, for culling and queries on large, mostly static scenes
+ *
+ * Built top-down with a binned surface area heuristic; moving objects are handled by `set_bounds` and
+ * `refit`, which keeps the topology and only recomputes node bounds, so a full `build` is worth
+ * repeating once the tree has degraded. `cull` finds the same visible objects as `FrustumCuller::cull`,
+ * but in tree order rather than ascending; a subtree fully inside the frustum is emitted as one copy of
+ * its object reference range, which every node keeps next to the tree (out of the nodes, so traversal
+ * stays at two nodes per cache line).
+ */
+class BVH
+{
+private:
+    std::vector<BVH_Node> m_nodes;
+    // Per node, the object references of its whole subtree
+    std::vector<BVH_RefRange> m_subtree_refs;
+    std::vector<uint32_t> m_object_refs;
+    std::vector<float> m_object_bounds;
+    BVH_Stats m_stats;
+
+private:
+    void update_node_bounds(BVH_Node& node) const;
+
+public:
+    static const uint32_t MAX_LEAF_SIZE = 4;
+
+    BVH();
+
+    // `object_bounds` holds 6 floats per object; min x/y/z followed by max x/y/z
+    void build(const float* object_bounds, uint32_t object_count);
+
+    void set_bounds(uint32_t object_index, const float bounds_min[3], const float bounds_max[3]);
+    void refit();
+
+    uint32_t cull(const Frustum& frustum, std::vector<uint32_t>& visible) const;
+
+    // Nearest object whose AABB the ray hits within `max_distance`; `direction` need not be normalized
+    bool raycast(const float origin[3], const float direction[3], float max_distance, BVH_RayHit& hit) const;
+
+    inline const BVH_Stats& get_stats() const { return m_stats; }
+    inline uint32_t get_object_count() const { return (uint32_t)m_object_refs.size(); }
+    inline const std::vector<BVH_Node>& get_nodes() const { return m_nodes; }
+};
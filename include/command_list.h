@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "mesh_pool.h"
+#include "shader_program.h"
+#include "vertex_format.h"
+
+
+enum class GL_CommandType : uint16_t
+{
+    BIND_PROGRAM,
+    BIND_VERTEX_FORMAT,
+    BIND_UNIFORM_RANGE,
+    BIND_TEXTURE,
+    SET_UNIFORM_MAT4,
+    DRAW_INDEXED,
+};
+
+
+// Every command starts with its type and its size in bytes (header included)
+struct GL_CommandHeader
+{
+    GL_CommandType type;
+    uint16_t size;
+};
+
+
+struct GL_CmdBindProgram
+{
+    GL_CommandHeader header;
+    GL_ShaderProgram* shader_program;
+};
+
+
+struct GL_CmdBindVertexFormat
+{
+    GL_CommandHeader header;
+    uint32_t vertex_buffer_id;
+    uint32_t index_buffer_id;
+    const GL_VertexFormat* vertex_format;
+};
+
+
+struct GL_CmdBindUniformRange
+{
+    GL_CommandHeader header;
+    uint32_t binding_index;
+    uint32_t buffer_id;
+    uint32_t offset;
+    uint32_t size;
+};
+
+
+struct GL_CmdBindTexture
+{
+    GL_CommandHeader header;
+    uint32_t texture_unit;
+    uint32_t texture_id;
+};
+
+
+// Written into the bound program's uniform shadow copy; uploaded by the next draw
+struct GL_CmdSetUniformMat4
+{
+    GL_CommandHeader header;
+    uint32_t name_id;
+    float matrix[16];
+};
+
+
+struct GL_CmdDrawIndexed
+{
+    GL_CommandHeader header;
+    uint32_t gl_index_type;
+    uint32_t index_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t instance_count;
+    uint32_t base_instance;
+};
+
+
+/**
+ * Linear buffer of POD render commands, recorded without touching GL
+ *
+ * Lists can be filled on any thread (one list per thread) and are replayed on the GL thread by
+ * `GL_Renderer::submit`, in the order they are passed, through the renderer's state cache. Commands are
+ * 8-byte aligned and hold raw pointers, so every referenced object must outlive the submission.
+ */
+class CommandList
+{
+private:
+    std::vector<uint64_t> m_data;
+    uint32_t m_size;
+    uint32_t m_command_count;
+
+private:
+    void* allocate(GL_CommandType type, uint32_t command_size);
+
+public:
+    CommandList();
+
+    // Clears the commands, keeping the memory
+    void reset();
+    void reserve(uint32_t byte_count);
+
+    void bind_program(GL_ShaderProgram* shader_program);
+    void bind_vertex_format(const GL_VertexFormat* vertex_format, uint32_t vertex_buffer_id, uint32_t index_buffer_id);
+    void bind_uniform_range(uint32_t binding_index, uint32_t buffer_id, uint32_t offset, uint32_t size);
+    void bind_texture(uint32_t texture_unit, uint32_t texture_id);
+    void set_uniform_mat4(uint32_t name_id, const float* matrix);
+    void draw_indexed(uint32_t gl_index_type, uint32_t index_count, uint32_t first_index, int32_t base_vertex,
+        uint32_t instance_count = 1, uint32_t base_instance = 0);
+
+    // Binds the pool's buffers and draws one of its meshes
+    void draw_mesh(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool, GL_MeshHandle mesh_handle);
+
+    inline const uint8_t* get_data() const { return (const uint8_t*)m_data.data(); }
+    inline uint32_t get_size() const { return m_size; }
+    inline uint32_t get_command_count() const { return m_command_count; }
+};
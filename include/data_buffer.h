@@ -20,8 +20,11 @@ public:
     ~GL_DataBuffer();
 
     void set_data(uint32_t gl_buffer_type, uint32_t data_count, const T* buffer_data, uint32_t gl_buffer_usage);
+    // Overwrites `data_count` elements starting at element `first`, without reallocating the buffer
+    void update_data(uint32_t first, uint32_t data_count, const T* buffer_data);
 
     void bind() const;
+    void bind_base(uint32_t gl_buffer_type, uint32_t binding_index) const;
     void unbind() const;
 
     inline uint32_t get_id() const { return m_gl_id;  }
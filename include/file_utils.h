@@ -1,6 +1,44 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 
 std::string read_file(const std::string& file_path);
+
+
+/**
+ * Read-only memory mapping of a whole file (mmap / CreateFileMapping)
+ */
+class MappedFile
+{
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+    bool m_open;
+#if defined(_WIN32)
+    void* m_file_handle;
+    void* m_mapping_handle;
+#else
+    int m_file_descriptor;
+#endif
+
+public:
+    MappedFile();
+    MappedFile(const std::string& file_path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& file_path);
+    void close();
+
+    inline bool is_open() const { return m_open; }
+    inline const uint8_t* get_data() const { return m_data; }
+    inline size_t get_size() const { return m_size; }
+};
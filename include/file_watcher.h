@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+/**
+ * Watches a set of files for modification; changes are collected by `poll_changes`, without a thread
+ *
+ * NOTE: on Linux this is backed by a non-blocking inotify descriptor (watching the parent directory, so
+ * editors which save through a rename are still picked up) drained on each poll; every other platform
+ * falls back to comparing file timestamps, at most once per poll interval. Not thread-safe: use it from
+ * a single thread.
+ */
+class FileWatcher
+{
+private:
+    struct WatchEntry
+    {
+        std::string file_path;
+        std::filesystem::file_time_type last_write_time;
+    };
+
+    // One inotify watch per directory, shared by every watched file inside it
+    struct WatchDirectory
+    {
+        int32_t watch_descriptor;
+        uint32_t file_count;
+    };
+
+private:
+    std::unordered_map<std::string, WatchEntry> m_watched;
+    std::unordered_set<std::string> m_changed;
+    std::chrono::steady_clock::time_point m_last_poll_time;
+
+    int32_t m_inotify_fd;
+    std::unordered_map<std::string, WatchDirectory> m_watch_directories;
+    std::unordered_map<int32_t, std::string> m_watch_descriptors;
+
+private:
+    bool read_notifications();
+    void poll_timestamps();
+
+public:
+    FileWatcher();
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    void watch(const std::string& file_path);
+    void unwatch(const std::string& file_path);
+
+    void poll_changes(std::vector<std::string>& changed_paths);
+
+    static std::string normalize_path(const std::string& file_path);
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+
+/**
+ * Bump allocator whose memory is only released all at once by `reset`
+ *
+ * Allocations which don't fit in the block spill into extra blocks for the rest of the frame; `reset`
+ * then regrows the main block to the frame's total, so the arena settles on one block and stops
+ * allocating after the first few frames.
+ */
+class FrameArena
+{
+private:
+    std::unique_ptr<uint8_t[]> m_block;
+    size_t m_capacity;
+    size_t m_offset;
+    std::vector<std::unique_ptr<uint8_t[]>> m_overflow_blocks;
+    size_t m_overflow_size;
+
+public:
+    explicit FrameArena(size_t capacity);
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void reset();
+
+    template<typename T>
+    inline T* allocate_array(size_t count) { return (T*)allocate(count * sizeof(T), alignof(T)); }
+
+    inline size_t get_used() const { return m_offset + m_overflow_size; }
+    inline size_t get_capacity() const { return m_capacity; }
+};
+
+
+// `std::pmr` adaptor; deallocation is a no-op, memory comes back when the arena is reset
+class FrameArenaResource : public std::pmr::memory_resource
+{
+private:
+    FrameArena* m_arena;
+
+private:
+    void* do_allocate(size_t size, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t size, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit FrameArenaResource(FrameArena* arena);
+};
+
+
+static constexpr uint32_t FRAME_ARENA_BUFFER_COUNT = 2;
+static constexpr size_t FRAME_ARENA_INITIAL_CAPACITY = 256 * 1024;
+
+
+/**
+ * Per-frame scratch memory: one arena per job system worker (the main thread is worker 0), so workers
+ * allocate without synchronization
+ *
+ * Arenas are double-buffered: `begin_frame` resets the set used two frames ago, so data handed to the
+ * render thread stays valid while it replays the previous frame.
+ *
+ * NOTE: the render thread must run at most one frame behind (two frame packets); only job system workers
+ * allocate from the frame arenas
+ */
+class FrameAllocator
+{
+private:
+    struct WorkerArena
+    {
+        FrameArena arena;
+        FrameArenaResource resource;
+
+        WorkerArena();
+    };
+
+private:
+    std::vector<std::unique_ptr<WorkerArena>> m_worker_arenas[FRAME_ARENA_BUFFER_COUNT];
+    uint32_t m_frame_idx;
+
+private:
+    FrameAllocator();
+
+    WorkerArena& get_worker_arena();
+
+public:
+    FrameAllocator(const FrameAllocator&) = delete;
+    FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+    static FrameAllocator& get();
+
+    // Main thread, once per frame and while no jobs are running
+    void begin_frame();
+
+    inline FrameArena& get_thread_arena() { return get_worker_arena().arena; }
+    inline std::pmr::memory_resource* get_thread_resource() { return &get_worker_arena().resource; }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+
+// std140 layout of the `FrameTime` uniform block (see `GL_Renderer::set_frame_time`)
+struct GL_FrameTimeBlock
+{
+    float time;
+    float delta_time;
+    float smoothed_delta_time;
+    float alpha;
+    uint32_t frame_index;
+    uint32_t padding[3];
+};
+
+
+/**
+ * Wall-clock frame timing on `std::chrono::steady_clock`, with a fixed-timestep accumulator
+ *
+ * `tick` is called once per frame and measures the time since the previous tick; long frames (window
+ * drags, breakpoints) are clamped to `max_delta_time` so the simulation never tries to catch up on them.
+ * The frame delta is added to an accumulator from which `step` takes whole fixed steps; state advanced in
+ * fixed steps is deterministic, and `get_alpha` gives how far the frame lies between the last two steps
+ * so the rendered state can be interpolated between them.
+ */
+class FrameClock
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point m_start_time;
+    Clock::time_point m_last_tick;
+    double m_time;
+    double m_delta_time;
+    double m_smoothed_delta_time;
+    double m_max_delta_time;
+    double m_fixed_delta_time;
+    double m_accumulator;
+    uint64_t m_frame_index;
+    uint64_t m_step_index;
+
+public:
+    explicit FrameClock(double fixed_delta_time = 1.0 / 60.0, double max_delta_time = 0.25);
+
+    void tick();
+
+    // Takes one fixed step off the accumulator; call in a loop until it returns false
+    bool step();
+
+    // Seconds since construction, as of the last tick
+    inline double get_time() const { return m_time; }
+    inline double get_delta_time() const { return m_delta_time; }
+    // Exponential moving average of the frame delta, for display and adaptive quality
+    inline double get_smoothed_delta_time() const { return m_smoothed_delta_time; }
+    inline double get_fixed_delta_time() const { return m_fixed_delta_time; }
+    // Simulated time: whole fixed steps taken so far
+    inline double get_step_time() const { return m_step_index * m_fixed_delta_time; }
+    inline float get_alpha() const { return (float)(m_accumulator / m_fixed_delta_time); }
+    inline uint64_t get_frame_index() const { return m_frame_index; }
+    inline uint64_t get_step_index() const { return m_step_index; }
+
+    GL_FrameTimeBlock get_time_block() const;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "renderer.h"
+
+
+static constexpr uint32_t GL_FRAMEBUFFER_MAX_COLOR_TARGETS = 4;
+
+
+struct GL_RenderTargetDesc
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t gl_internal_format;
+    // 1 for single-sampled targets
+    uint32_t samples;
+    // Texture that can be bound for sampling (multisampled: `sampler2DMS`), else a renderbuffer
+    bool sampled;
+
+    inline bool operator==(const GL_RenderTargetDesc& other) const
+    {
+        return width == other.width && height == other.height && gl_internal_format == other.gl_internal_format &&
+            samples == other.samples && sampled == other.sampled;
+    }
+};
+
+
+/**
+ * One framebuffer image: an immutable texture or renderbuffer of fixed size, format and sample count
+ */
+class GL_RenderTarget
+{
+private:
+    uint32_t m_gl_id;
+    // Never reused, unlike GL ids and heap addresses, so a framebuffer can tell a recreated target apart
+    uint64_t m_serial;
+    GL_RenderTargetDesc m_desc;
+
+    static uint64_t s_next_serial;
+
+public:
+    explicit GL_RenderTarget(const GL_RenderTargetDesc& desc);
+
+    ~GL_RenderTarget();
+
+    GL_RenderTarget(const GL_RenderTarget&) = delete;
+    GL_RenderTarget& operator=(const GL_RenderTarget&) = delete;
+
+    // Sampled targets only
+    void gl_bind(uint32_t gl_texture_slot = 0) const;
+
+    // Attachment point for the format: color, depth, stencil or depth-stencil
+    uint32_t get_gl_attachment(uint32_t color_idx = 0) const;
+    uint32_t get_gl_target() const;
+
+    inline uint32_t get_id() const { return m_gl_id; }
+    inline uint64_t get_serial() const { return m_serial; }
+    inline const GL_RenderTargetDesc& get_desc() const { return m_desc; }
+    inline uint32_t get_width() const { return m_desc.width; }
+    inline uint32_t get_height() const { return m_desc.height; }
+    inline uint32_t get_samples() const { return m_desc.samples; }
+};
+
+
+/**
+ * Framebuffer object over up to `GL_FRAMEBUFFER_MAX_COLOR_TARGETS` color targets and one depth/stencil
+ * target, all of the same size and sample count
+ *
+ * Targets are only referenced (typically owned by a `GL_RenderTargetPool`) and attached on the next
+ * `bind`, which also checks completeness and sets the viewport. Attachments are compared by target serial,
+ * so a target the pool deleted and recreated at the same address (or with the same GL id) is re-attached. `resolve` blits into another framebuffer
+ * (or the default one), which is the MSAA resolve for multisampled sources (those need equal sizes;
+ * single-sampled color is scaled with linear filtering). `invalidate` tells the driver attachments'
+ * contents are no longer needed, so tiled and compressing GPUs can skip writing them back.
+ */
+class GL_Framebuffer
+{
+private:
+    uint32_t m_gl_id;
+    const GL_RenderTarget* m_color_targets[GL_FRAMEBUFFER_MAX_COLOR_TARGETS];
+    const GL_RenderTarget* m_depth_target;
+    // Serials of the targets currently attached (color targets, then depth), 0 for none
+    uint64_t m_attached_serials[GL_FRAMEBUFFER_MAX_COLOR_TARGETS + 1];
+
+private:
+    void update_attachments();
+    const GL_RenderTarget* get_any_target() const;
+    void blit(uint32_t target_gl_id, uint32_t target_width, uint32_t target_height, uint32_t gl_buffer_mask) const;
+
+public:
+    GL_Framebuffer();
+
+    ~GL_Framebuffer();
+
+    GL_Framebuffer(const GL_Framebuffer&) = delete;
+    GL_Framebuffer& operator=(const GL_Framebuffer&) = delete;
+
+    // nullptr detaches
+    void set_color_target(uint32_t color_idx, const GL_RenderTarget* target);
+    void set_depth_target(const GL_RenderTarget* target);
+
+    // Binds for drawing and reading and sets the viewport to the targets' size
+    void bind();
+    static void bind_default(uint32_t width, uint32_t height);
+
+    void resolve(GL_Framebuffer& target, uint32_t gl_buffer_mask = GL_COLOR_BUFFER_BIT);
+    void resolve_to_default(uint32_t gl_buffer_mask = GL_COLOR_BUFFER_BIT);
+
+    // Discards the color (every attached target) and/or depth/stencil contents in `gl_buffer_mask`
+    void invalidate(uint32_t gl_buffer_mask);
+
+    // RGBA8 pixels of a single-sampled color target, bottom row first
+    void read_pixels(uint32_t color_idx, uint8_t* rgba);
+
+    uint32_t get_width() const;
+    uint32_t get_height() const;
+
+    inline uint32_t get_id() const { return m_gl_id; }
+    inline const GL_RenderTarget* get_color_target(uint32_t color_idx) const { return m_color_targets[color_idx]; }
+    inline const GL_RenderTarget* get_depth_target() const { return m_depth_target; }
+};
+
+
+/**
+ * Reuses render targets across frames: `acquire` hands out an idle target with the same description (or
+ * creates one), `release` returns it; `end_frame` deletes targets left idle for a few frames, so targets
+ * of an old window size don't linger after a resize
+ */
+class GL_RenderTargetPool
+{
+private:
+    struct Entry
+    {
+        std::unique_ptr<GL_RenderTarget> target;
+        bool in_use;
+        uint64_t last_used_frame;
+    };
+
+private:
+    std::vector<Entry> m_entries;
+    uint64_t m_frame_index;
+
+public:
+    GL_RenderTargetPool();
+
+    GL_RenderTargetPool(const GL_RenderTargetPool&) = delete;
+    GL_RenderTargetPool& operator=(const GL_RenderTargetPool&) = delete;
+
+    GL_RenderTarget* acquire(const GL_RenderTargetDesc& desc);
+    void release(const GL_RenderTarget* target);
+    void end_frame();
+
+    inline uint32_t get_target_count() const { return (uint32_t)m_entries.size(); }
+};
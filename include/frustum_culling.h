@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+
+/**
+ * Six normalized frustum planes (left, right, bottom, top, near, far) as `a*x + b*y + c*z + d`, with
+ * the normals pointing into the frustum
+ */
+struct Frustum
+{
+    float planes[6][4];
+
+    // Extracts the planes from a column-major (OpenGL convention) view-projection matrix
+    static Frustum from_matrix(const float* view_projection);
+};
+
+
+/**
+ * Visibility culling of object bounds against a frustum
+ *
+ * Bounds are stored structure-of-arrays (center, AABB half-extents and bounding sphere radius per
+ * component) so the plane tests run over 8 objects per iteration with AVX2, or 4 with SSE. An object is
+ * culled if either of its bounding volumes is fully outside any plane, so every test uses the tighter
+ * of the two. Object indices are stable; `cull` writes the visible indices, in ascending order.
+ */
+class FrustumCuller
+{
+private:
+    std::vector<float> m_center_x, m_center_y, m_center_z;
+    std::vector<float> m_extent_x, m_extent_y, m_extent_z;
+    std::vector<float> m_radius;
+    uint32_t m_count;
+
+private:
+    uint32_t cull_range(const Frustum& frustum, uint32_t begin, uint32_t end, uint32_t* visible) const;
+
+public:
+    FrustumCuller();
+
+    void reserve(uint32_t count);
+    void clear();
+
+    uint32_t add(const float center[3], const float extents[3]);
+    uint32_t add_sphere(const float center[3], float radius);
+
+    void set(uint32_t index, const float center[3], const float extents[3]);
+    void set_sphere(uint32_t index, const float center[3], float radius);
+
+    /**
+     * Writes the indices of every object intersecting the frustum into `visible` and returns their count;
+     * the objects are split into up to `thread_count` job system ranges (0 uses one per worker)
+     */
+    uint32_t cull(const Frustum& frustum, std::vector<uint32_t>& visible, uint32_t thread_count = 1) const;
+
+    inline uint32_t get_count() const { return m_count; }
+};
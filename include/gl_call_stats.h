@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+
+/**
+ * Optional GL call instrumentation, enabled by building with GL_CALL_STATS
+ *
+ * Every `GL_CALL` site registers itself once, then counts its calls and the CPU time spent inside the
+ * wrapped call (error checks excluded). `gl_call_stats_end_frame` folds the frame's numbers into the
+ * totals; `gl_call_stats_report` prints the most expensive GL functions and the most frequent call sites
+ * per frame. Without GL_CALL_STATS no site registers and both functions do nothing.
+ *
+ * NOTE: like GL itself, only meant to be used from the thread owning the context
+ */
+uint32_t gl_register_call_site(const char* call, const char* source_file, uint32_t line_number);
+void gl_call_begin();
+void gl_call_end(uint32_t call_site);
+
+// Returns the number of GL calls made during the frame
+uint64_t gl_call_stats_end_frame();
+void gl_call_stats_report(uint32_t max_entries = 12);
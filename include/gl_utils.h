@@ -1,10 +1,74 @@
 #pragma once
 
+#define GLEW_STATIC
+
+#include <cstddef>
 #include <cstdint>
+#include <GL/glew.h>
+
+
+/**
+ * Storage types for packed vertex attributes (see vertex_packing.h for converters)
+ */
+struct GL_Half
+{
+    uint16_t bits;
+};
+
+struct GL_Packed_2_10_10_10
+{
+    uint32_t bits;
+};
+
+// Layout of one `glMultiDrawElementsIndirect` command, as written by the GPU culling pass
+struct GL_DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instance_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t base_instance;
+};
+
+
+/**
+ * Compile-time mapping of C++ types to GL data types
+ *
+ * NOTE: not all GL types are supported (such as `FIXED`); unsupported types map to 0
+ */
+template<typename T>
+struct GL_TypeTraits
+{
+    static constexpr uint32_t gl_type = 0;
+};
+
+template<> struct GL_TypeTraits<signed char> { static constexpr uint32_t gl_type = GL_BYTE; };
+template<> struct GL_TypeTraits<unsigned char> { static constexpr uint32_t gl_type = GL_UNSIGNED_BYTE; };
+template<> struct GL_TypeTraits<short> { static constexpr uint32_t gl_type = GL_SHORT; };
+template<> struct GL_TypeTraits<unsigned short> { static constexpr uint32_t gl_type = GL_UNSIGNED_SHORT; };
+template<> struct GL_TypeTraits<int32_t> { static constexpr uint32_t gl_type = GL_INT; };
+template<> struct GL_TypeTraits<uint32_t> { static constexpr uint32_t gl_type = GL_UNSIGNED_INT; };
+template<> struct GL_TypeTraits<float> { static constexpr uint32_t gl_type = GL_FLOAT; };
+template<> struct GL_TypeTraits<double> { static constexpr uint32_t gl_type = GL_DOUBLE; };
+template<> struct GL_TypeTraits<GL_Half> { static constexpr uint32_t gl_type = GL_HALF_FLOAT; };
+template<> struct GL_TypeTraits<GL_Packed_2_10_10_10> { static constexpr uint32_t gl_type = GL_INT_2_10_10_10_REV; };
+
+
+/**
+ * Packed types store a whole vector in a single value, so their size doesn't scale with component count
+ */
+template<typename T>
+constexpr bool is_gl_packed_type = false;
+
+template<>
+constexpr bool is_gl_packed_type<GL_Packed_2_10_10_10> = true;
 
 
 template<typename T>
-uint32_t get_gl_type();
+constexpr uint32_t get_gl_type()
+{
+    return GL_TypeTraits<T>::gl_type;
+}
 
 
 size_t get_gl_type_size(uint32_t gl_type);
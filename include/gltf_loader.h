@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "data_buffer.h"
+#include "file_utils.h"
+#include "mesh_data.h"
+
+
+/**
+ * View of a glTF accessor; `data` points straight into the mapped file (or decoded data URI)
+ */
+struct GLTF_Accessor
+{
+    const uint8_t* data;
+    uint32_t count;
+    uint32_t component_type;
+    uint32_t component_count;
+    uint32_t byte_stride;
+    bool normalized;
+    int32_t buffer_view;
+    uint32_t byte_offset;
+};
+
+
+struct GLTF_BufferView
+{
+    const uint8_t* data;
+    uint32_t byte_length;
+    uint32_t byte_stride;
+    uint32_t target;
+};
+
+
+struct GLTF_Primitive
+{
+    GLTF_Accessor position;
+    GLTF_Accessor normal;
+    GLTF_Accessor uv;
+    GLTF_Accessor indices;
+};
+
+
+struct GLTF_Mesh
+{
+    std::string name;
+    std::vector<GLTF_Primitive> primitives;
+};
+
+
+/**
+ * glTF 2.0 loader (.gltf with external/data URI buffers and binary .glb)
+ *
+ * Binary buffers are memory mapped and never copied on the CPU: buffer views can be uploaded straight
+ * from the mapping into GL buffers, and accessors describe offsets/strides into those views. Only
+ * triangle-list primitives with POSITION/NORMAL/TEXCOORD_0 are exposed; sparse accessors, skins,
+ * morph targets and materials are ignored.
+ */
+class GLTF_Model
+{
+private:
+    MappedFile m_file;
+    std::vector<MappedFile> m_external_buffers;
+    std::vector<std::vector<uint8_t>> m_embedded_buffers;
+    std::vector<GLTF_BufferView> m_buffer_views;
+    std::vector<GLTF_Mesh> m_meshes;
+
+public:
+    bool load(const std::string& file_path);
+
+    // Uploads a buffer view directly from the mapped file (no intermediate copy)
+    void upload_buffer_view(uint32_t view_idx, GL_DataBuffer<unsigned char>& data_buffer, uint32_t gl_buffer_type, uint32_t gl_buffer_usage) const;
+
+    // Converts a primitive into an interleaved `MeshData` (for the mesh pipeline and pools)
+    bool get_mesh_data(uint32_t mesh_idx, uint32_t primitive_idx, MeshData& mesh_data) const;
+
+    inline const std::vector<GLTF_BufferView>& get_buffer_views() const { return m_buffer_views; }
+    inline const std::vector<GLTF_Mesh>& get_meshes() const { return m_meshes; }
+};
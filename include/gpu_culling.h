@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "data_buffer.h"
+#include "frustum_culling.h"
+#include "gl_utils.h"
+#include "shader_program.h"
+
+
+/**
+ * One cullable object as laid out in the culling SSBO (std430); bounds as in `FrustumCuller`, plus the
+ * index range of its mesh, typically a `GL_MeshRange` out of a `GL_MeshPool`
+ */
+struct GL_GpuCullObject
+{
+    float center[3];
+    float radius;
+    float extents[3];
+    uint32_t index_count;
+    uint32_t first_index;
+    int32_t base_vertex;
+    uint32_t padding[2];
+};
+
+static_assert(sizeof(GL_GpuCullObject) == 48, "GL_GpuCullObject must match the std430 layout in cull.comp");
+
+
+// Uniform block of cull.comp (std140)
+struct GL_GpuCullParams
+{
+    float frustum_planes[6][4];
+    float view_projection[16];
+    float hiz_size[2];
+    uint32_t object_count;
+    uint32_t occlusion_enabled;
+};
+
+
+/**
+ * GPU-driven culling; a compute pass tests every object against the frustum and, optionally, a Hi-Z
+ * depth pyramid of the previous frame, and appends a `GL_DrawElementsIndirectCommand` per visible object
+ * through an atomic counter, so the results never come back to the CPU
+ *
+ * Commands carry the object index as `base_instance`. Draw them with `GL_Renderer::draw_indirect`, which
+ * reads the draw count from `get_count_buffer` when ARB_indirect_parameters is available; otherwise the
+ * command buffer is cleared before each pass and all `get_max_draw_count` commands are submitted, the
+ * unused ones with an instance count of 0.
+ */
+class GL_GpuCuller
+{
+private:
+    GL_ShaderProgram m_cull_program;
+    GL_ShaderProgram m_hiz_program;
+    GL_DataBuffer<unsigned char> m_object_buffer;
+    GL_DataBuffer<unsigned char> m_params_buffer;
+    GL_DataBuffer<GL_DrawElementsIndirectCommand> m_command_buffer;
+    GL_DataBuffer<uint32_t> m_count_buffer;
+    uint32_t m_object_count;
+
+    uint32_t m_hiz_texture_id;
+    uint32_t m_hiz_width, m_hiz_height, m_hiz_levels;
+
+public:
+    GL_GpuCuller(const std::string& cull_shader_path, const std::string& hiz_shader_path);
+
+    ~GL_GpuCuller();
+
+    GL_GpuCuller(const GL_GpuCuller&) = delete;
+    GL_GpuCuller& operator=(const GL_GpuCuller&) = delete;
+
+    void set_objects(const GL_GpuCullObject* objects, uint32_t object_count);
+
+    // Builds the max-depth pyramid from a depth texture (sampled with texelFetch, so any depth format works)
+    void build_hiz(uint32_t depth_texture_id, uint32_t width, uint32_t height);
+
+    void cull(const Frustum& frustum, const float* view_projection, bool occlusion);
+
+    inline const GL_DataBuffer<GL_DrawElementsIndirectCommand>* get_command_buffer() const { return &m_command_buffer; }
+    inline const GL_DataBuffer<uint32_t>* get_count_buffer() const { return &m_count_buffer; }
+    inline uint32_t get_max_draw_count() const { return m_object_count; }
+    inline uint32_t get_hiz_texture_id() const { return m_hiz_texture_id; }
+};
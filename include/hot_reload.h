@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_watcher.h"
+#include "job_system.h"
+#include "shader_program.h"
+#include "texture_2d.h"
+
+
+/**
+ * Reloads shader programs and textures whose source files change on disk
+ *
+ * While a reloader exists, every shader program created from files and every texture loaded through
+ * `GL_Texture2D::load_image` registers itself with it, and unregisters when destroyed; `track` is only
+ * needed for objects loaded before the reloader. Only one reloader may exist at a time, and loads must
+ * happen on the GL thread, like `update`.
+ *
+ * Files are re-read and images re-decoded as job system jobs; the results are swapped into the tracked
+ * objects by `update`, which must be called on the GL thread between frames.
+ */
+class HotReloader
+{
+private:
+    struct PendingShader
+    {
+        GL_ShaderProgram* shader_program;
+        std::vector<std::string> stage_sources;
+        std::chrono::steady_clock::time_point change_time;
+    };
+
+    struct PendingTexture
+    {
+        GL_Texture2D* texture;
+        GL_ImageData image_data;
+        std::chrono::steady_clock::time_point change_time;
+    };
+
+private:
+    FileWatcher m_file_watcher;
+    std::unordered_multimap<std::string, GL_ShaderProgram*> m_shader_programs;
+    std::unordered_multimap<std::string, GL_Texture2D*> m_textures;
+    std::vector<std::string> m_changed_paths;
+
+    JobCounter m_job_counter;
+
+    std::mutex m_pending_mutex;
+    std::vector<PendingShader> m_pending_shaders;
+    std::vector<PendingTexture> m_pending_textures;
+
+    static HotReloader* s_active;
+
+private:
+    void unwatch_unused(const std::vector<std::string>& file_paths);
+    void reload_shader(GL_ShaderProgram* shader_program);
+    void reload_texture(GL_Texture2D* texture);
+
+public:
+    HotReloader();
+
+    ~HotReloader();
+
+    void track(GL_ShaderProgram* shader_program);
+    void track(GL_Texture2D* texture);
+    void untrack(GL_ShaderProgram* shader_program);
+    void untrack(GL_Texture2D* texture);
+
+    void update();
+
+    // Called by the load entry points and destructors of reloadable objects; no-ops without a reloader
+    static void notify_loaded(GL_ShaderProgram* shader_program);
+    static void notify_loaded(GL_Texture2D* texture);
+    static void notify_destroyed(GL_ShaderProgram* shader_program);
+    static void notify_destroyed(GL_Texture2D* texture);
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+
+/**
+ * Element buffer whose index type is chosen at upload time; indices are always supplied as 32-bit and
+ * narrowed to the smallest of `GL_UNSIGNED_BYTE`/`GL_UNSIGNED_SHORT`/`GL_UNSIGNED_INT` that can address
+ * every referenced vertex, so draws dispatch on the stored GL type instead of a template parameter
+ */
+class GL_IndexBuffer
+{
+private:
+    uint32_t m_gl_id;
+    uint32_t m_gl_index_type;
+    uint32_t m_index_count;
+    uint32_t m_buffer_size;
+
+public:
+    GL_IndexBuffer();
+    GL_IndexBuffer(uint32_t index_count, const uint32_t* index_data, uint32_t gl_buffer_usage);
+
+    ~GL_IndexBuffer();
+
+    GL_IndexBuffer(const GL_IndexBuffer&) = delete;
+    GL_IndexBuffer& operator=(const GL_IndexBuffer&) = delete;
+
+    void set_data(uint32_t index_count, const uint32_t* index_data, uint32_t gl_buffer_usage);
+
+    void bind() const;
+    void unbind() const;
+
+    // The narrowest GL index type that can address `vertex_count` vertices
+    static uint32_t select_index_type(uint32_t vertex_count);
+
+    inline uint32_t get_id() const { return m_gl_id; }
+    inline uint32_t get_index_type() const { return m_gl_index_type; }
+    inline uint32_t get_count() const { return m_index_count; }
+    inline uint32_t get_buffer_size() const { return m_buffer_size; }
+};
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+struct Job;
+
+
+/**
+ * Counts unfinished jobs; jobs submitted with a counter increment it and decrement it when done, and
+ * jobs submitted with it as their dependency are held back until it reaches zero; it may be destroyed as
+ * soon as `wait` on it returns
+ */
+class JobCounter
+{
+private:
+    std::atomic<uint32_t> m_value;
+    std::mutex m_mutex;
+    Job* m_continuations;
+
+    friend class JobSystem;
+
+public:
+    JobCounter();
+
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    inline bool is_done() const { return m_value.load(std::memory_order_acquire) == 0; }
+};
+
+
+static constexpr uint32_t JOB_STORAGE_SIZE = 64;
+
+
+/**
+ * One unit of work; the callable is stored inline (or on the heap when larger than the storage) and
+ * jobs are recycled through per-worker free lists, so submitting doesn't allocate in steady state
+ */
+struct Job
+{
+    // Runs the callable when `run` is set, then destroys it
+    void (*invoke)(Job* job, bool run);
+    JobCounter* counter;
+    Job* next;
+    uint32_t owner_idx;
+    alignas(16) uint8_t storage[JOB_STORAGE_SIZE];
+};
+
+
+/**
+ * Chase-Lev work-stealing deque of fixed capacity; the owning worker pushes and pops at the bottom,
+ * other workers steal from the top
+ */
+class JobDeque
+{
+private:
+    static constexpr int64_t CAPACITY = 4096;
+
+    alignas(64) std::atomic<int64_t> m_top;
+    alignas(64) std::atomic<int64_t> m_bottom;
+    std::unique_ptr<std::atomic<Job*>[]> m_jobs;
+
+public:
+    JobDeque();
+
+    // Returns false when the deque is full
+    bool push(Job* job);
+    Job* pop();
+    Job* steal();
+};
+
+
+/**
+ * Work-stealing job scheduler
+ *
+ * One worker thread per hardware thread, minus one for the main thread, which is worker 0 and runs jobs
+ * while it waits on a counter. Jobs submitted from a worker go to the bottom of its own deque; idle
+ * workers steal from the top of the others'. Threads outside the pool submit through a shared queue.
+ * There is always at least one background worker, even on a single hardware thread: the main thread
+ * only runs jobs while waiting, so jobs from outside the pool would otherwise never start.
+ *
+ * GL calls must stay on the thread owning the context: `run_on_gl_thread` queues a function for the next
+ * `process_gl_thread_jobs`, which the render thread calls once per frame.
+ *
+ * NOTE: the first call to `get` must come from the main thread
+ */
+class JobSystem
+{
+private:
+    // Jobs are freed to their owner: directly when it runs them, else through its lock-free returned stack
+    struct alignas(64) JobPool
+    {
+        Job* free_jobs;
+        std::atomic<Job*> returned_jobs;
+    };
+
+private:
+    std::vector<std::unique_ptr<JobDeque>> m_deques;
+    std::unique_ptr<JobPool[]> m_job_pools;
+    std::vector<std::thread> m_workers;
+    std::atomic<bool> m_running;
+
+    std::mutex m_injection_mutex;
+    std::vector<Job*> m_injection_queue;
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_condition;
+    std::atomic<uint32_t> m_queued_count;
+
+    std::mutex m_gl_thread_mutex;
+    std::vector<std::function<void()>> m_gl_thread_jobs;
+
+private:
+    JobSystem();
+
+    void worker_loop(uint32_t worker_idx);
+    Job* allocate_job();
+    void free_job(Job* job);
+    void enqueue(Job* job, JobCounter* counter, JobCounter* dependency);
+    void schedule(Job* job);
+    Job* find_job();
+    void execute(Job* job);
+
+public:
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static JobSystem& get();
+
+    // Index of the calling worker (0 is the main thread), or UINT32_MAX outside the pool
+    static uint32_t get_worker_index();
+
+    // Queues `function`; it starts only once `dependency` (if any) is done
+    template<typename F>
+    void submit(F&& function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr)
+    {
+        using Function = std::decay_t<F>;
+
+        Job* job = allocate_job();
+        if constexpr (sizeof(Function) <= JOB_STORAGE_SIZE && alignof(Function) <= 16)
+        {
+            new (job->storage) Function(std::forward<F>(function));
+            job->invoke = [](Job* job, bool run) {
+                Function* stored_function = std::launder((Function*)job->storage);
+                if (run)
+                    (*stored_function)();
+                stored_function->~Function();
+            };
+        }
+        else
+        {
+            *(Function**)job->storage = new Function(std::forward<F>(function));
+            job->invoke = [](Job* job, bool run) {
+                Function* stored_function = *(Function**)job->storage;
+                if (run)
+                    (*stored_function)();
+                delete stored_function;
+            };
+        }
+        enqueue(job, counter, dependency);
+    }
+
+    // Runs other jobs on the calling thread until `counter` reaches zero
+    void wait(JobCounter& counter);
+
+    /**
+     * Calls `range_function(begin, end)` over `[0, count)` split into ranges of at least `min_grain`
+     * items, about four per worker so stealing can even out uneven ranges; returns once every range is done
+     */
+    template<typename F>
+    void parallel_for(size_t count, F&& range_function, size_t min_grain = 1)
+    {
+        if (!count)
+            return;
+
+        size_t target_range_count = (size_t)m_deques.size() * 4;
+        size_t grain = std::max(std::max<size_t>(min_grain, 1), (count + target_range_count - 1) / target_range_count);
+        if (grain >= count)
+        {
+            range_function((size_t)0, count);
+            return;
+        }
+
+        // The calling thread takes the first range itself
+        JobCounter counter;
+        for (size_t begin = grain; begin < count; begin += grain)
+        {
+            size_t end = std::min(count, begin + grain);
+            submit([&range_function, begin, end]() { range_function(begin, end); }, &counter);
+        }
+        range_function((size_t)0, grain);
+        wait(counter);
+    }
+
+    void run_on_gl_thread(std::function<void()> function);
+    void process_gl_thread_jobs();
+
+    inline uint32_t get_worker_count() const { return (uint32_t)m_deques.size(); }
+};
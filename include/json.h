@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+/**
+ * Minimal JSON DOM; enough for asset metadata such as glTF, not a general purpose library
+ */
+class JsonValue
+{
+public:
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object,
+    };
+
+private:
+    Type m_type;
+    bool m_bool;
+    double m_number;
+    std::string m_string;
+    std::vector<JsonValue> m_array;
+    std::vector<std::pair<std::string, JsonValue>> m_object;
+
+    friend class JsonParser;
+
+public:
+    JsonValue();
+
+    const JsonValue* find(std::string_view key) const;
+
+    double get_number(std::string_view key, double default_value) const;
+    std::string_view get_string(std::string_view key, std::string_view default_value = "") const;
+    bool get_bool(std::string_view key, bool default_value) const;
+
+    inline Type get_type() const { return m_type; }
+    inline bool is_null() const { return m_type == Type::Null; }
+    inline bool as_bool() const { return m_bool; }
+    inline double as_number() const { return m_number; }
+    inline const std::string& as_string() const { return m_string; }
+    inline const std::vector<JsonValue>& as_array() const { return m_array; }
+    inline const std::vector<std::pair<std::string, JsonValue>>& as_object() const { return m_object; }
+    inline size_t get_size() const { return m_type == Type::Array ? m_array.size() : m_object.size(); }
+    inline const JsonValue& operator[](size_t idx) const { return m_array[idx]; }
+};
+
+
+bool parse_json(std::string_view text, JsonValue& value);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include "simd_utils.h"
+
+
+// Column-major 4x4 matrix (OpenGL convention); `m[column * 4 + row]`
+struct alignas(16) Mat4
+{
+    float m[16];
+};
+
+
+Mat4 mat4_identity();
+
+// Translation, rotation (unit quaternion x/y/z/w) and scale; equivalent to T * R * S
+Mat4 mat4_from_trs(const float translation[3], const float rotation[4], const float scale[3]);
+
+Mat4 mat4_perspective(float fov_y, float aspect_ratio, float near_plane, float far_plane);
+Mat4 mat4_look_at(const float eye[3], const float target[3], const float up[3]);
+
+void quat_from_axis_angle(const float axis[3], float angle, float rotation[4]);
+
+
+inline Mat4 mat4_multiply(const Mat4& lhs, const Mat4& rhs)
+{
+    Mat4 result;
+#if defined(SIMD_SSE2)
+    // Each result column is a linear combination of the lhs columns
+    __m128 lhs_columns[4] = { _mm_load_ps(&lhs.m[0]), _mm_load_ps(&lhs.m[4]), _mm_load_ps(&lhs.m[8]), _mm_load_ps(&lhs.m[12]) };
+    for (uint32_t column = 0; column < 4; column++)
+    {
+        const float* rhs_column = &rhs.m[column * 4];
+        __m128 result_column = _mm_mul_ps(lhs_columns[0], _mm_set1_ps(rhs_column[0]));
+        result_column = _mm_add_ps(result_column, _mm_mul_ps(lhs_columns[1], _mm_set1_ps(rhs_column[1])));
+        result_column = _mm_add_ps(result_column, _mm_mul_ps(lhs_columns[2], _mm_set1_ps(rhs_column[2])));
+        result_column = _mm_add_ps(result_column, _mm_mul_ps(lhs_columns[3], _mm_set1_ps(rhs_column[3])));
+        _mm_store_ps(&result.m[column * 4], result_column);
+    }
+#else
+    for (uint32_t column = 0; column < 4; column++)
+    {
+        for (uint32_t row = 0; row < 4; row++)
+        {
+            float sum = 0.0f;
+            for (uint32_t k = 0; k < 4; k++)
+                sum += lhs.m[k * 4 + row] * rhs.m[column * 4 + k];
+            result.m[column * 4 + row] = sum;
+        }
+    }
+#endif
+    return result;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "vertex_layout.h"
+
+
+/**
+ * CPU-side mesh produced by the asset loaders; `MeshVertexLayout` describes `vertices` for
+ * `GL_VertexFormatCache`/`GL_VertexArray`, and `indices` is a triangle list
+ */
+struct MeshVertex
+{
+    float position[3];
+    float normal[3];
+    float uv[2];
+};
+
+using MeshVertexLayout = GL_VertexLayout<GL_Attrib<float, 3>, GL_Attrib<float, 3>, GL_Attrib<float, 2>>;
+static_assert(MeshVertexLayout::matches<MeshVertex,
+    GL_VERTEX_MEMBER(MeshVertex, position), GL_VERTEX_MEMBER(MeshVertex, normal), GL_VERTEX_MEMBER(MeshVertex, uv)>(),
+    "MeshVertexLayout does not match MeshVertex");
+
+
+struct MeshData
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices;
+};
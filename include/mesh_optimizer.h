@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "mesh_data.h"
+
+
+struct MeshCacheStats
+{
+    float acmr;  // average cache miss ratio; transformed vertices per triangle (0.5 ideal, 3 worst)
+    float atvr;  // average transformed vertex ratio; transformed vertices per vertex (1 ideal)
+};
+
+
+struct MeshOptimizeReport
+{
+    uint32_t vertex_count_before, vertex_count_after;
+    MeshCacheStats cache_before, cache_after;
+    uint32_t index_gl_type;
+    double optimize_ms;
+};
+
+
+// Simulates a FIFO post-transform cache of `cache_size` entries over a triangle list
+MeshCacheStats analyze_vertex_cache(const uint32_t* indices, size_t index_count, uint32_t vertex_count, uint32_t cache_size = 16);
+
+
+// Merges bit-identical vertices through a hash index and rewrites the index buffer
+void deduplicate_vertices(MeshData& mesh_data);
+
+
+// Reorders triangles for post-transform cache locality (Forsyth's linear-speed algorithm)
+void optimize_vertex_cache(std::vector<uint32_t>& indices, uint32_t vertex_count);
+
+
+/**
+ * Reorders cache-optimized triangles to reduce overdraw; the index buffer is split into clusters at
+ * cache flush points and clusters facing away from the mesh centre are drawn first (Sander et al.)
+ */
+void optimize_overdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices, uint32_t cache_size = 16);
+
+
+// Reorders vertices in order of first use by the index buffer and drops unreferenced vertices
+void optimize_vertex_fetch(MeshData& mesh_data);
+
+
+// Full pipeline; deduplicate, vertex cache, overdraw and vertex fetch, in that order
+MeshOptimizeReport optimize_mesh(MeshData& mesh_data);
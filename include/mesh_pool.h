@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "range_allocator.h"
+
+
+typedef uint32_t GL_MeshHandle;
+
+
+struct GL_MeshRange
+{
+    uint32_t base_vertex;
+    uint32_t vertex_count;
+    uint32_t first_index;
+    uint32_t index_count;
+};
+
+
+struct GL_MeshPoolStats
+{
+    uint32_t mesh_count;
+    uint32_t vertex_used, vertex_capacity;
+    uint32_t index_used, index_capacity;
+    float vertex_fragmentation;
+    float index_fragmentation;
+};
+
+
+/**
+ * Stores many meshes of one vertex layout in a single vertex buffer and a single (32-bit) index buffer
+ *
+ * Each mesh gets a vertex range and an index range from a free-list suballocator; indices stay relative
+ * to the mesh and are drawn with `glDrawElementsBaseVertex`, so meshes can be moved by `defragment`
+ * (or `grow`) without rewriting index data. Buffers use immutable storage when available.
+ *
+ * The pool never grows on its own: `add_mesh` returns `INVALID_HANDLE` when the mesh doesn't fit, and
+ * the caller decides whether to `grow` and retry. Every method issues GL calls, so the pool must only be
+ * used on the thread owning the GL context.
+ *
+ * NOTE: growing and defragmenting replace the GL buffers; call `GL_Renderer::invalidate_state` afterwards
+ */
+class GL_MeshPool
+{
+private:
+    uint32_t m_vertex_stride;
+    uint32_t m_vertex_buffer_id;
+    uint32_t m_index_buffer_id;
+    RangeAllocator m_vertex_allocator;
+    RangeAllocator m_index_allocator;
+
+    std::vector<GL_MeshRange> m_meshes;
+    std::vector<bool> m_mesh_alive;
+    std::vector<GL_MeshHandle> m_free_handles;
+
+private:
+    uint32_t create_buffer(uint32_t buffer_size);
+    void reallocate(uint32_t vertex_capacity, uint32_t index_capacity);
+
+public:
+    static constexpr GL_MeshHandle INVALID_HANDLE = UINT32_MAX;
+
+    GL_MeshPool(uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity);
+
+    ~GL_MeshPool();
+
+    GL_MeshPool(const GL_MeshPool&) = delete;
+    GL_MeshPool& operator=(const GL_MeshPool&) = delete;
+
+    // Returns `INVALID_HANDLE` (uploading nothing) when the free ranges can't hold the mesh
+    GL_MeshHandle add_mesh(const void* vertex_data, uint32_t vertex_count, const uint32_t* index_data, uint32_t index_count);
+    void remove_mesh(GL_MeshHandle mesh_handle);
+
+    // Doubles the capacities (compacting live meshes) until `vertex_count` more vertices and `index_count` more indices fit
+    void grow(uint32_t vertex_count, uint32_t index_count);
+    void defragment();
+
+    GL_MeshPoolStats get_stats() const;
+    void print_stats() const;
+
+    inline const GL_MeshRange& get_range(GL_MeshHandle mesh_handle) const { return m_meshes[mesh_handle]; }
+    inline uint32_t get_vertex_stride() const { return m_vertex_stride; }
+    inline uint32_t get_vertex_buffer_id() const { return m_vertex_buffer_id; }
+    inline uint32_t get_index_buffer_id() const { return m_index_buffer_id; }
+};
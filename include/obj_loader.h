@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "mesh_data.h"
+
+
+/**
+ * Loads a Wavefront OBJ file into an indexed triangle mesh
+ *
+ * The file is memory mapped and split into line-aligned chunks which are parsed in parallel (no
+ * iostreams, hand-rolled number parsing); polygons are fan-triangulated and identical
+ * position/uv/normal triples are merged into one vertex. Materials, groups and smoothing groups are
+ * ignored. The file is split into at most `thread_count` chunks (0 uses one per job system worker).
+ */
+bool load_obj(const std::string& file_path, MeshData& mesh_data, uint32_t thread_count = 0);
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+enum class ProfileEventType : uint32_t
+{
+    ZONE,
+    COUNTER,
+};
+
+
+// Names are stored by pointer and must outlive the profiler (string literals)
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t timestamp;
+    uint64_t value;
+    ProfileEventType type;
+};
+
+
+/**
+ * Fixed-capacity ring of events with a single writer; once full, the oldest events are overwritten
+ *
+ * The writer publishes each event by advancing the write index with release ordering, so recording
+ * never takes a lock. Readers copy the newest events and drop any the writer may have overwritten
+ * while they were copying.
+ */
+class ProfileTrack
+{
+private:
+    static constexpr uint64_t CAPACITY = 1 << 16;
+
+    std::string m_name;
+    uint32_t m_track_id;
+    std::unique_ptr<ProfileEvent[]> m_events;
+    std::atomic<uint64_t> m_write_index;
+
+    friend class Profiler;
+
+public:
+    ProfileTrack(std::string name, uint32_t track_id);
+
+    ProfileTrack(const ProfileTrack&) = delete;
+    ProfileTrack& operator=(const ProfileTrack&) = delete;
+
+    void push(const ProfileEvent& event);
+    // Appends the retained events, oldest first
+    void copy_events(std::vector<ProfileEvent>& events) const;
+};
+
+
+/**
+ * Instrumentation: CPU zones, counters and GPU zones (see `GL_GpuProfiler`) recorded into per-thread
+ * tracks, exported as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+ *
+ * Each thread records into its own track, created on its first event; timestamps are nanoseconds of
+ * `std::chrono::steady_clock` since the profiler was created. The tracks keep the most recent events,
+ * so the export covers the last stretch of the run.
+ */
+class Profiler
+{
+private:
+    std::chrono::steady_clock::time_point m_start_time;
+    std::atomic<bool> m_enabled;
+    std::atomic<uint64_t> m_uploaded_bytes;
+
+    std::mutex m_tracks_mutex;
+    std::vector<std::unique_ptr<ProfileTrack>> m_tracks;
+
+private:
+    Profiler();
+
+public:
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static Profiler& get();
+
+    // Tracks live as long as the profiler
+    ProfileTrack* create_track(const std::string& name);
+    ProfileTrack* get_thread_track();
+    void set_thread_name(const std::string& name);
+
+    inline uint64_t now() const { return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start_time).count(); }
+
+    void record_zone(const char* name, uint64_t begin_time, uint64_t end_time);
+    void record_counter(const char* name, uint64_t value);
+
+    // Bytes uploaded to GL buffers and textures since the last `take_uploaded_bytes`
+    inline void count_upload(uint64_t byte_count) { m_uploaded_bytes.fetch_add(byte_count, std::memory_order_relaxed); }
+    inline uint64_t take_uploaded_bytes() { return m_uploaded_bytes.exchange(0, std::memory_order_relaxed); }
+
+    bool write_chrome_trace(const std::string& file_path);
+
+    inline void set_enabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    inline bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+};
+
+
+// Records the enclosing scope as a zone on the calling thread's track
+class ProfileZone
+{
+private:
+    const char* m_name;
+    uint64_t m_begin_time;
+
+public:
+    explicit ProfileZone(const char* name);
+
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+
+
+/**
+ * GPU zones through `glQueryCounter(GL_TIMESTAMP)` query pairs
+ *
+ * Queries are pooled per frame across `FRAME_LATENCY` frames; `begin_frame` reads back the frame issued
+ * `FRAME_LATENCY` frames ago only if its results are available, and otherwise drops it, so the CPU never
+ * waits on the GPU. GPU timestamps are mapped onto the profiler's clock with an offset measured at
+ * creation and recorded on a "GPU" track.
+ *
+ * NOTE: GL thread only
+ */
+class GL_GpuProfiler
+{
+private:
+    static constexpr uint32_t FRAME_LATENCY = 4;
+    static constexpr uint32_t MAX_ZONES_PER_FRAME = 64;
+
+    struct GpuFrame
+    {
+        uint32_t query_ids[MAX_ZONES_PER_FRAME * 2];
+        const char* zone_names[MAX_ZONES_PER_FRAME];
+        uint32_t zone_count;
+        uint32_t last_query_id;
+    };
+
+private:
+    GpuFrame m_frames[FRAME_LATENCY];
+    uint32_t m_frame_idx;
+    int64_t m_gpu_time_offset;
+    ProfileTrack* m_track;
+    uint32_t m_dropped_frames;
+
+public:
+    GL_GpuProfiler();
+
+    ~GL_GpuProfiler();
+
+    GL_GpuProfiler(const GL_GpuProfiler&) = delete;
+    GL_GpuProfiler& operator=(const GL_GpuProfiler&) = delete;
+
+    void begin_frame();
+
+    // Returns a zone index for `end_zone`, or UINT32_MAX when the frame is out of queries
+    uint32_t begin_zone(const char* name);
+    void end_zone(uint32_t zone_idx);
+
+    inline uint32_t get_dropped_frames() const { return m_dropped_frames; }
+};
+
+
+class GL_GpuZone
+{
+private:
+    GL_GpuProfiler* m_gpu_profiler;
+    uint32_t m_zone_idx;
+
+public:
+    GL_GpuZone(GL_GpuProfiler* gpu_profiler, const char* name);
+
+    ~GL_GpuZone();
+
+    GL_GpuZone(const GL_GpuZone&) = delete;
+    GL_GpuZone& operator=(const GL_GpuZone&) = delete;
+};
+
+
+#define PROFILE_GPU_ZONE(gpu_profiler, name) GL_GpuZone PROFILE_CONCAT(gpu_zone_, __LINE__)(gpu_profiler, name)
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+
+/**
+ * Best-fit free-list allocator over an abstract range of `capacity` units (vertices, indices, bytes, ...)
+ *
+ * Free blocks are tracked both by offset (for coalescing on free) and by size (for best-fit lookups),
+ * so allocate/free are O(log n) in the number of free blocks
+ */
+class RangeAllocator
+{
+private:
+    std::map<uint32_t, uint32_t> m_free_by_offset;
+    std::multimap<uint32_t, uint32_t> m_free_by_size;
+    uint32_t m_capacity;
+    uint32_t m_used;
+
+private:
+    void insert_free(uint32_t offset, uint32_t size);
+    void erase_free(std::map<uint32_t, uint32_t>::iterator it);
+
+public:
+    static constexpr uint32_t INVALID_OFFSET = UINT32_MAX;
+
+    RangeAllocator(uint32_t capacity = 0);
+
+    void reset(uint32_t capacity);
+
+    uint32_t allocate(uint32_t size);
+    void free(uint32_t offset, uint32_t size);
+
+    uint32_t get_largest_free() const;
+    float get_fragmentation() const;
+
+    inline uint32_t get_capacity() const { return m_capacity; }
+    inline uint32_t get_used() const { return m_used; }
+    inline uint32_t get_free() const { return m_capacity - m_used; }
+    inline uint32_t get_free_block_count() const { return (uint32_t)m_free_by_offset.size(); }
+};
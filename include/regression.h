@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "framebuffer.h"
+#include "render_queue.h"
+#include "renderer.h"
+#include "shader_program.h"
+#include "software_renderer.h"
+#include "texture_2d.h"
+#include "vertex_format.h"
+#include "mesh_pool.h"
+
+
+struct RegressionOptions
+{
+    // Overwrite the reference images and baselines instead of checking against them
+    bool record = false;
+    std::string reference_directory = "./res/regression/";
+    std::string output_directory = "./regression_output/";
+
+    // Per-pixel YIQ color distance (0-1) above which a pixel counts as different
+    float color_threshold = 0.1f;
+    // Fraction of differing pixels above which an image fails
+    float max_mismatch_fraction = 0.001f;
+    // Allowed frame time increase over the local baseline (0.5 = 50%), on top of a small absolute slack
+    float frame_time_tolerance = 0.5f;
+};
+
+
+struct RegressionBaseline
+{
+    uint32_t draw_calls;
+    uint32_t state_changes;
+    uint64_t gl_calls;
+    double frame_time_ms;
+};
+
+
+struct RegressionCapture
+{
+    std::vector<uint8_t> pixels;
+    RegressionBaseline stats;
+    // Heap allocations over all timed frames (COUNT_ALLOCATIONS builds)
+    uint64_t allocations;
+};
+
+
+/**
+ * Golden-image and performance regression run, started with `--regression` (`--regression-record` to
+ * re-record), meant for headless Mesa (llvmpipe) in CI
+ *
+ * Each scene renders into an offscreen framebuffer for a number of timed frames (each ending in
+ * `glFinish`); the last frame is read back and compared with its reference image using a perceptual
+ * (YIQ) color distance, and its draw calls, state changes and GL calls (GL_CALL_STATS builds) must not
+ * exceed the recorded baseline. Failing scenes write their image and a difference mask to the output
+ * directory.
+ *
+ * Software renderer scenes are checked against the image of the matching GL scene, so a change in either
+ * backend's output shows up as a mismatch. GPU culling is checked against the CPU culler's result instead
+ * of an image.
+ *
+ * Frame times only compare on the machine that recorded them, so they go to `frame_times.txt` (not
+ * committed) next to the committed `baselines.txt`; the median frame time is only checked against the
+ * baseline plus tolerance once a local recording exists.
+ */
+class RegressionSuite
+{
+private:
+    RegressionOptions m_options;
+    GL_RenderTarget m_color_target;
+    GL_Framebuffer m_framebuffer;
+    std::unordered_map<std::string, RegressionBaseline> m_baselines;
+    // Per-machine median frame times (ms), empty when none were recorded here
+    std::unordered_map<std::string, double> m_frame_times;
+    std::vector<std::pair<std::string, RegressionBaseline>> m_recorded_baselines;
+    uint32_t m_failure_count;
+
+    GL_Renderer m_renderer;
+    GL_VertexFormatCache m_vertex_formats;
+    const GL_VertexFormat* m_vertex_format;
+    GL_MeshPool m_mesh_pool;
+    GL_MeshHandle m_quad_mesh;
+    GL_ShaderProgram m_textured_program;
+    GL_ShaderProgram m_instanced_program;
+    GL_Texture2D m_texture0, m_texture1;
+
+    SoftwareRenderer m_software_renderer;
+    SoftwareTexture m_software_texture0, m_software_texture1;
+
+private:
+    template<typename F>
+    RegressionCapture capture(F&& draw_frame);
+    template<typename F>
+    RegressionCapture capture_software(F&& draw_frame);
+    // `reference_name` compares against another scene's image (not rewritten when recording)
+    void check(const std::string& scene_name, const RegressionCapture& capture, const std::string& reference_name = "");
+    void fail(const std::string& scene_name, const char* reason);
+
+    void load_baselines();
+    void save_baselines() const;
+
+    void run_textured_quads();
+    void run_batching(RenderCulling culling);
+    void run_instancing();
+    void run_gpu_culling();
+    void run_software_textured_quads();
+
+public:
+    static constexpr uint32_t WIDTH = 256;
+    static constexpr uint32_t HEIGHT = 256;
+
+    explicit RegressionSuite(const RegressionOptions& options);
+
+    RegressionSuite(const RegressionSuite&) = delete;
+    RegressionSuite& operator=(const RegressionSuite&) = delete;
+
+    // Renders and checks every scene; returns the number of failed checks
+    uint32_t run();
+};
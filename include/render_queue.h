@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "bvh.h"
+#include "command_list.h"
+#include "frustum_culling.h"
+#include "mat4.h"
+#include "renderer.h"
+#include "scene.h"
+#include "scene_components.h"
+#include "transform_system.h"
+
+
+enum class RenderCulling
+{
+    // SoA frustum test over every candidate, split over the job system
+    FLAT,
+    // BVH over the candidates, refit every frame and rebuilt whenever their count changes
+    BVH,
+};
+
+
+struct RenderItem
+{
+    uint64_t sort_key;
+    const GL_VertexFormat* vertex_format;
+    const GL_MeshPool* mesh_pool;
+    GL_MeshHandle mesh;
+    GL_ShaderProgram* shader_program;
+    uint32_t transform_index;
+};
+
+
+/**
+ * Per-frame list of visible draws gathered from a scene
+ *
+ * `gather` queries every entity with transform, mesh, material and bounds components chunk by chunk,
+ * streaming world-space bounds into a frustum culler alongside a parallel array of candidate draws; the
+ * visible candidates are then sorted by shader program, vertex format and mesh pool, so the recorded
+ * commands change GL state as rarely as possible. With `RenderCulling::BVH` the bounds go into a BVH
+ * instead, which pays off for large scenes where few objects move and few are visible.
+ *
+ * `record` splits the sorted items into contiguous slices and fills one command list per slice on the
+ * job system (computing each item's MVP there); the lists are then replayed in order on the GL thread
+ * through `GL_Renderer::submit`.
+ */
+class RenderQueue
+{
+private:
+    RenderCulling m_culling;
+    FrustumCuller m_culler;
+    BVH m_bvh;
+    std::vector<float> m_object_bounds;
+    std::vector<RenderItem> m_candidates;
+    std::vector<uint32_t> m_visible;
+    std::vector<RenderItem> m_items;
+
+public:
+    RenderQueue();
+
+    // Takes effect on the next `gather`; `thread_count` only applies to flat culling
+    inline void set_culling(RenderCulling culling) { m_culling = culling; }
+
+    void gather(Scene& scene, const TransformSystem& transforms, const Frustum& frustum, uint32_t thread_count = 1);
+    // Resizes `command_lists` to the number of slices; previous contents are reset, memory is reused
+    void record(const TransformSystem& transforms, const Mat4& view_projection, std::vector<CommandList>& command_lists) const;
+
+    inline const std::vector<RenderItem>& get_items() const { return m_items; }
+    inline uint32_t get_candidate_count() const { return (uint32_t)m_candidates.size(); }
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "command_list.h"
+#include "frame_clock.h"
+
+
+struct GLFWwindow;
+
+
+// Everything the render thread needs to draw one frame; filled on the simulation thread
+struct FramePacket
+{
+    uint64_t frame_index;
+    GL_FrameTimeBlock frame_time;
+    // Window framebuffer size; GLFW only allows querying it on the main thread
+    uint32_t framebuffer_width;
+    uint32_t framebuffer_height;
+    std::vector<CommandList> command_lists;
+};
+
+
+/**
+ * Thread owning the GL context, fed by the simulation (main) thread through a small ring of frame packets
+ *
+ * The main thread acquires a free packet, records the frame into it and submits it; the render thread
+ * renders submitted packets in order and hands them back. With two packets the simulation runs at most
+ * one frame ahead of the GPU-facing thread (three: two frames), so input is never buffered deeper than
+ * that, while event handling and simulation no longer wait behind a vsynced swap.
+ *
+ * The window's context is made current on the render thread for its whole lifetime and is handed back
+ * to the constructing thread on destruction. Jobs queued with `JobSystem::run_on_gl_thread` run on the
+ * render thread before each frame.
+ */
+class RenderThread
+{
+private:
+    GLFWwindow* m_window;
+    std::function<void(FramePacket&)> m_render_function;
+    std::thread m_thread;
+    bool m_running;
+
+    std::vector<std::unique_ptr<FramePacket>> m_packets;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    // Both sized to the packet count up front, so recycling packets never allocates
+    std::vector<FramePacket*> m_free_packets;
+    std::vector<FramePacket*> m_ready_packets;
+    uint64_t m_submitted_count;
+    uint64_t m_started_count;
+    uint64_t m_rendered_count;
+
+private:
+    void render_loop();
+
+public:
+    RenderThread(GLFWwindow* window, uint32_t packet_count, std::function<void(FramePacket&)> render_function);
+
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Blocks while every packet is queued or being rendered
+    FramePacket* acquire_packet();
+    void submit_packet(FramePacket* packet);
+
+    // Blocks until every submitted packet has been rendered
+    void flush();
+};
@@ -5,14 +5,33 @@
 #include <cstdint>
 #include <GL/glew.h>
 #include "vertex_array.h"
+#include "command_list.h"
 #include "data_buffer.h"
+#include "gl_call_stats.h"
+#include "frame_clock.h"
+#include "gl_utils.h"
+#include "index_buffer.h"
 #include "shader_program.h"
+#include "vertex_format.h"
+#include "mesh_pool.h"
 
 
 #define ASSERT(x) if (!(x)) __debugbreak();
+#if defined(GL_CALL_STATS)
+#define GL_CALL_CONCAT_IMPL(a, b) a##b
+#define GL_CALL_CONCAT(a, b) GL_CALL_CONCAT_IMPL(a, b)
+// The site id is a static local, so it's registered once and safe to jump over from case labels
+#define GL_CALL(x) static const uint32_t GL_CALL_CONCAT(gl_call_site_, __LINE__) = gl_register_call_site(#x, __FILE__, __LINE__);\
+    gl_clear_error();\
+    gl_call_begin();\
+    x;\
+    gl_call_end(GL_CALL_CONCAT(gl_call_site_, __LINE__));\
+    ASSERT(gl_log_call(#x, __FILE__, __LINE__))
+#else
 #define GL_CALL(x) gl_clear_error();\
     x;\
     ASSERT(gl_log_call(#x, __FILE__, __LINE__))
+#endif
 
 
 void gl_clear_error();
@@ -21,11 +40,79 @@ void gl_clear_error();
 bool gl_log_call(const char* function, const char* source_file, uint32_t line_number);
 
 
+// Uniform buffer binding reserved for the `FrameTime` block; command lists shouldn't bind over it
+static constexpr uint32_t GL_FRAME_TIME_BINDING = 1;
+
+
+struct GL_RenderStats
+{
+    uint32_t draw_calls;
+    uint32_t vertex_array_binds;
+    uint32_t vertex_buffer_binds;
+    uint32_t program_binds;
+};
+
+
 class GL_Renderer
 {
+private:
+    const GL_VertexFormat* m_bound_vertex_format;
+    uint32_t m_bound_vertex_buffer;
+    uint32_t m_bound_index_buffer;
+    GL_RenderStats m_frame_stats;
+    GL_DataBuffer<unsigned char> m_frame_time_buffer;
+
+private:
+    void bind_vertex_format(const GL_VertexFormat* vertex_format, uint32_t vertex_buffer_id, uint32_t index_buffer_id);
+    void bind_shader_program(GL_ShaderProgram* shader_program);
+
 public:
-    void clear();
+    GL_Renderer();
+
+    void clear(uint32_t gl_buffer_mask = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    /**
+     * Uploads the frame's timing to the `FrameTime` uniform block (std140, binding `GL_FRAME_TIME_BINDING`);
+     * called once per frame before drawing, instead of setting a time uniform on every program bind
+     */
+    void set_frame_time(const GL_FrameTimeBlock& time_block);
 
     template<typename T, typename K>
     void draw(const GL_VertexArray<T>* vertex_array, const GL_DataBuffer<K>* index_buffer, GL_ShaderProgram* shader_program);
+
+    /**
+     * Draws through a shared vertex format; the format VAO and buffer bindings are left bound between
+     * draws, so consecutive meshes with the same layout only rebind their buffers
+     *
+     * NOTE: buffer uploads never touch the bound VAO, but binding an element buffer directly (`bind` or
+     * `unbind` on an index buffer) does; call `invalidate_state` after doing so
+     */
+    template<typename T, typename K>
+    void draw(const GL_VertexFormat* vertex_format, const GL_DataBuffer<T>* vertex_buffer, const GL_DataBuffer<K>* index_buffer, GL_ShaderProgram* shader_program);
+
+    // As above, with the index type read from the buffer at runtime (8, 16 or 32-bit)
+    template<typename T>
+    void draw(const GL_VertexFormat* vertex_format, const GL_DataBuffer<T>* vertex_buffer, const GL_IndexBuffer* index_buffer, GL_ShaderProgram* shader_program);
+
+    // Draws one mesh out of a mesh pool; meshes in the same pool never rebind buffers between draws
+    void draw(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool, GL_MeshHandle mesh_handle, GL_ShaderProgram* shader_program);
+
+    /**
+     * Draws GPU-generated commands over a mesh pool (see `GL_GpuCuller`); with ARB_indirect_parameters the
+     * draw count is read from `count_buffer`, otherwise all `max_draw_count` commands are submitted
+     */
+    void draw_indirect(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool,
+        const GL_DataBuffer<GL_DrawElementsIndirectCommand>* command_buffer, const GL_DataBuffer<uint32_t>* count_buffer,
+        uint32_t max_draw_count, GL_ShaderProgram* shader_program);
+
+    /**
+     * Replays command lists in order; program binds are skipped when the program is already bound, and
+     * vertex format binds go through the same cache as the draw calls above
+     */
+    void submit(const CommandList* command_lists, uint32_t list_count);
+
+    void invalidate_state();
+
+    inline const GL_RenderStats& get_frame_stats() const { return m_frame_stats; }
+    inline void reset_frame_stats() { m_frame_stats = {}; }
 };
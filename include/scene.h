@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "frame_arena.h"
+#include "job_system.h"
+
+
+typedef uint32_t EntityHandle;
+
+
+static constexpr uint32_t SCENE_CHUNK_SIZE = 16 * 1024;
+static constexpr uint32_t SCENE_MAX_COMPONENT_TYPES = 64;
+
+
+// Registers a component type (size and alignment) and returns its id; use `scene_component_id<T>` instead
+uint32_t register_scene_component(uint32_t component_size, uint32_t component_alignment);
+
+
+/**
+ * Id of a component type, assigned on first use; components are moved between chunks with memcpy, so
+ * they have to be trivially copyable
+ */
+template<typename T>
+uint32_t scene_component_id()
+{
+    static_assert(std::is_trivially_copyable_v<T>, "Scene components must be trivially copyable");
+    static const uint32_t component_id = register_scene_component(sizeof(T), alignof(T));
+    return component_id;
+}
+
+
+template<typename... Ts>
+uint64_t scene_signature()
+{
+    return (0ull | ... | (1ull << scene_component_id<Ts>()));
+}
+
+
+struct alignas(64) SceneChunkStorage
+{
+    uint8_t bytes[SCENE_CHUNK_SIZE];
+};
+
+
+struct SceneChunk
+{
+    std::unique_ptr<SceneChunkStorage> storage;
+    uint32_t count;
+};
+
+
+/**
+ * All entities with exactly one set of component types
+ *
+ * Each chunk holds `capacity` entities as one array per component type (plus the entity handles), so
+ * iterating a component streams through contiguous memory. Rows are kept packed by moving the archetype's
+ * last entity into any removed row.
+ */
+struct SceneArchetype
+{
+    uint64_t signature;
+    uint32_t capacity;
+    std::vector<uint32_t> component_types;
+    uint32_t component_offsets[SCENE_MAX_COMPONENT_TYPES];
+    std::vector<SceneChunk> chunks;
+};
+
+
+struct SceneEntityRecord
+{
+    uint32_t archetype;
+    uint32_t chunk;
+    uint32_t row;
+};
+
+
+/**
+ * Entity-component scene with archetype/chunk storage
+ *
+ * Queries are resolved to the list of archetypes containing every requested component (cached per set
+ * of components) and iterate chunk by chunk, handing the callback one contiguous array per component.
+ *
+ * NOTE: creating/destroying entities and adding/removing components moves rows between chunks; don't do
+ * it while iterating
+ */
+class Scene
+{
+private:
+    std::vector<SceneArchetype> m_archetypes;
+    std::unordered_map<uint64_t, uint32_t> m_archetype_index;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_query_cache;
+
+    std::vector<SceneEntityRecord> m_entities;
+    std::vector<EntityHandle> m_free_handles;
+    uint32_t m_entity_count;
+
+private:
+    uint32_t get_archetype(uint64_t signature);
+    void allocate_row(EntityHandle entity, uint32_t archetype_idx);
+    void release_row(const SceneEntityRecord& record);
+    void move_entity(EntityHandle entity, uint64_t signature);
+    void* get_component(EntityHandle entity, uint32_t component_type) const;
+    const std::vector<uint32_t>& match_archetypes(uint64_t signature);
+
+    template<typename T>
+    static inline T* get_array(const SceneArchetype& archetype, const SceneChunk& chunk)
+    {
+        return (T*)(chunk.storage->bytes + archetype.component_offsets[scene_component_id<T>()]);
+    }
+
+public:
+    static constexpr EntityHandle INVALID_HANDLE = UINT32_MAX;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    Scene();
+
+    Scene(const Scene&) = delete;
+    Scene& operator=(const Scene&) = delete;
+
+    EntityHandle create(uint64_t signature = 0);
+    void destroy(EntityHandle entity);
+
+    template<typename... Ts>
+    EntityHandle create(const Ts&... components)
+    {
+        EntityHandle entity = create(scene_signature<Ts...>());
+        ((*get<Ts>(entity) = components), ...);
+        return entity;
+    }
+
+    // Adds the component, or overwrites it if the entity already has one
+    template<typename T>
+    void add(EntityHandle entity, const T& component)
+    {
+        uint64_t signature = m_archetypes[m_entities[entity].archetype].signature;
+        uint64_t component_bit = 1ull << scene_component_id<T>();
+        if (!(signature & component_bit))
+            move_entity(entity, signature | component_bit);
+        *get<T>(entity) = component;
+    }
+
+    template<typename T>
+    void remove(EntityHandle entity)
+    {
+        uint64_t signature = m_archetypes[m_entities[entity].archetype].signature;
+        uint64_t component_bit = 1ull << scene_component_id<T>();
+        if (signature & component_bit)
+            move_entity(entity, signature & ~component_bit);
+    }
+
+    // Returns nullptr when the entity doesn't have the component
+    template<typename T>
+    inline T* get(EntityHandle entity) const { return (T*)get_component(entity, scene_component_id<T>()); }
+
+    template<typename T>
+    inline bool has(EntityHandle entity) const { return get_component(entity, scene_component_id<T>()) != nullptr; }
+
+    /**
+     * Calls `function(count, entities, Ts* components...)` once per non-empty chunk of every archetype with
+     * all of `Ts`; each array holds `count` elements
+     */
+    template<typename... Ts, typename F>
+    void for_each_chunk(F&& function)
+    {
+        for (uint32_t archetype_idx : match_archetypes(scene_signature<Ts...>()))
+        {
+            const SceneArchetype& archetype = m_archetypes[archetype_idx];
+            for (const SceneChunk& chunk : archetype.chunks)
+            {
+                if (chunk.count)
+                    function(chunk.count, (const EntityHandle*)chunk.storage->bytes, get_array<Ts>(archetype, chunk)...);
+            }
+        }
+    }
+
+    // Calls `function(entity, Ts& components...)` for every entity with all of `Ts`
+    template<typename... Ts, typename F>
+    void for_each(F&& function)
+    {
+        for_each_chunk<Ts...>([&function](uint32_t count, const EntityHandle* entities, Ts*... components) {
+            for (uint32_t row = 0; row < count; row++)
+                function(entities[row], components[row]...);
+        });
+    }
+
+    /**
+     * As `for_each_chunk`, with chunks run as job system ranges of at least `min_chunks_per_job` chunks;
+     * the callback must only write the components of the chunk it was given; the chunk list lives in the
+     * calling worker's frame arena
+     */
+    template<typename... Ts, typename F>
+    void parallel_for_each_chunk(F&& function, size_t min_chunks_per_job = 1)
+    {
+        std::pmr::vector<std::pair<const SceneArchetype*, const SceneChunk*>> chunks(FrameAllocator::get().get_thread_resource());
+        for (uint32_t archetype_idx : match_archetypes(scene_signature<Ts...>()))
+        {
+            for (const SceneChunk& chunk : m_archetypes[archetype_idx].chunks)
+            {
+                if (chunk.count)
+                    chunks.emplace_back(&m_archetypes[archetype_idx], &chunk);
+            }
+        }
+
+        JobSystem::get().parallel_for(chunks.size(), [&chunks, &function](size_t begin, size_t end) {
+            for (size_t chunk_idx = begin; chunk_idx < end; chunk_idx++)
+            {
+                const auto& [archetype, chunk] = chunks[chunk_idx];
+                function(chunk->count, (const EntityHandle*)chunk->storage->bytes, get_array<Ts>(*archetype, *chunk)...);
+            }
+        }, min_chunks_per_job);
+    }
+
+    // Number of entities with all of `Ts`
+    template<typename... Ts>
+    uint32_t count()
+    {
+        uint32_t entity_count = 0;
+        for (uint32_t archetype_idx : match_archetypes(scene_signature<Ts...>()))
+        {
+            for (const SceneChunk& chunk : m_archetypes[archetype_idx].chunks)
+                entity_count += chunk.count;
+        }
+        return entity_count;
+    }
+
+    inline bool is_alive(EntityHandle entity) const { return entity < m_entities.size() && m_entities[entity].archetype != INVALID_INDEX; }
+    inline uint32_t get_entity_count() const { return m_entity_count; }
+    inline uint32_t get_archetype_count() const { return (uint32_t)m_archetypes.size(); }
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include "mesh_pool.h"
+#include "shader_program.h"
+#include "transform_system.h"
+#include "vertex_format.h"
+
+
+// Components read by `RenderQueue::gather`
+
+struct TransformComponent
+{
+    TransformHandle transform;
+};
+
+
+struct MeshComponent
+{
+    const GL_VertexFormat* vertex_format;
+    const GL_MeshPool* mesh_pool;
+    GL_MeshHandle mesh;
+};
+
+
+struct MaterialComponent
+{
+    GL_ShaderProgram* shader_program;
+};
+
+
+// Local-space AABB; transformed by the entity's world matrix when gathered
+struct BoundsComponent
+{
+    float center[3];
+    float extents[3];
+};
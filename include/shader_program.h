@@ -2,18 +2,77 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 
+struct GL_UniformValue
+{
+    uint32_t gl_type;
+    union
+    {
+        int32_t i[16];
+        float f[16];
+    };
+};
+
+
+struct GL_UniformSlot
+{
+    uint32_t name_id;
+    int32_t location;
+    bool dirty;
+    GL_UniformValue value;
+};
+
+
+struct GL_UniformStats
+{
+    uint32_t uploads;
+    uint32_t redundant;
+};
+
+
+// One shader stage source file (GL_VERTEX_SHADER, GL_TESS_CONTROL_SHADER, ..., GL_COMPUTE_SHADER)
+struct GL_ShaderStage
+{
+    uint32_t gl_shader_type;
+    std::string file_path;
+};
+
+
+/**
+ * Program linked from any valid set of stages; either a graphics pipeline (vertex, optional tessellation
+ * control/evaluation and geometry, fragment) or a single compute stage
+ *
+ * NOTE: uniform writes only update a CPU-side shadow copy; changed values are uploaded in a single pass
+ * when the program is next bound, and writes which don't change the value are skipped entirely
+ */
 class GL_ShaderProgram
 {
 private:
     uint32_t m_gl_id;
-    std::unordered_map<const char*, int32_t> m_uniform_location_cache;
+    uint32_t m_sort_id;
+    std::vector<GL_ShaderStage> m_stages;
+    uint32_t m_work_group_size[3];
+    std::vector<GL_UniformSlot> m_uniform_slots;
+    std::unordered_map<uint32_t, uint32_t> m_uniform_slot_index;
+    std::vector<uint32_t> m_dirty_slots;
+
+    static GL_UniformStats s_frame_stats;
+    static uint32_t s_next_sort_id;
+
+    // Command list replay flushes uniforms without rebinding the program
+    friend class GL_Renderer;
 
 private:
     uint32_t compile_shader(uint32_t gl_shader_type, const char* shader_source);
-    int32_t get_uniform_location(const std::string& uniform_name);
+    uint32_t link_program(const std::vector<std::string>& stage_sources);
+    void swap_program(uint32_t gl_program_id);
+    int32_t get_uniform_location(uint32_t name_id);
+    void set_uniform(uint32_t name_id, const GL_UniformValue& value);
+    void flush_uniforms();
 
 public:
     GL_ShaderProgram();
@@ -21,14 +80,45 @@ public:
 
     ~GL_ShaderProgram();
 
+    void create(const std::vector<GL_ShaderStage>& stages);
     void create(const std::string& vert_file_path, const std::string& frag_file_path);
+    void create_compute(const std::string& comp_file_path);
 
-    void set_uniform_1i(const std::string& uniform_name, int32_t value);
-    void set_uniform_1f(const std::string& uniform_name, float value);
-    void set_uniform_4f(const std::string& uniform_name, float v0, float v1, float v2, float v3);
+    // Relinks from new sources, one per stage in `get_stages` order; the current program is kept on failure
+    bool reload(const std::vector<std::string>& stage_sources);
 
-    void bind() const;
+    void set_uniform_1i(uint32_t name_id, int32_t value);
+    void set_uniform_1f(uint32_t name_id, float value);
+    void set_uniform_4f(uint32_t name_id, float v0, float v1, float v2, float v3);
+    // Column-major 4x4 matrix
+    void set_uniform_mat4(uint32_t name_id, const float* matrix);
+
+    void set_uniform_1i(std::string_view uniform_name, int32_t value);
+    void set_uniform_1f(std::string_view uniform_name, float value);
+    void set_uniform_4f(std::string_view uniform_name, float v0, float v1, float v2, float v3);
+    void set_uniform_mat4(std::string_view uniform_name, const float* matrix);
+
+    void bind();
     void unbind() const;
 
+    /**
+     * Compute dispatch; each binds the program (flushing uniforms) first. `dispatch_invocations` rounds
+     * a total invocation count up to whole work groups of the shader's `local_size`
+     */
+    void dispatch(uint32_t group_count_x, uint32_t group_count_y = 1, uint32_t group_count_z = 1);
+    void dispatch_invocations(uint32_t invocation_count_x, uint32_t invocation_count_y = 1, uint32_t invocation_count_z = 1);
+    void dispatch_indirect(uint32_t dispatch_buffer_id, uint32_t byte_offset = 0);
+
+    static void bind_storage_buffer(uint32_t binding_index, uint32_t buffer_id);
+    static void bind_image(uint32_t image_unit, uint32_t texture_id, uint32_t gl_access, uint32_t gl_format, uint32_t level = 0);
+    static void memory_barrier(uint32_t gl_barrier_bits);
+
     inline uint32_t get_id() const { return m_gl_id; }
+    // Fixed at construction, unlike the GL id a reload replaces; safe to read from any thread
+    inline uint32_t get_sort_id() const { return m_sort_id; }
+    inline const std::vector<GL_ShaderStage>& get_stages() const { return m_stages; }
+    inline const uint32_t* get_work_group_size() const { return m_work_group_size; }
+
+    static inline const GL_UniformStats& get_frame_stats() { return s_frame_stats; }
+    static inline void reset_frame_stats() { s_frame_stats = {}; }
 };
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * SIMD feature detection shared by the vectorized code paths
+ *
+ * NOTE: MSVC only defines `__AVX2__` when building with `/arch:AVX2`; every AVX2 CPU also supports F16C
+ */
+#if defined(__AVX2__)
+#define SIMD_AVX2 1
+#endif
+
+#if defined(__F16C__) || defined(SIMD_AVX2)
+#define SIMD_F16C 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SIMD_SSE2 1
+#endif
+
+#if defined(SIMD_AVX2) || defined(SIMD_F16C)
+#include <immintrin.h>
+#elif defined(SIMD_SSE2)
+#include <emmintrin.h>
+#endif
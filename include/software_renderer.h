@@ -0,0 +1,211 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "attrib_array.h"
+#include "texture_2d.h"
+
+
+static constexpr uint32_t SOFTWARE_MAX_ATTRIBUTES = 8;
+static constexpr uint32_t SOFTWARE_MAX_VARYINGS = 8;
+static constexpr uint32_t SOFTWARE_TILE_SIZE = 8;
+static constexpr uint32_t SOFTWARE_BIN_SIZE = 64;
+
+
+// Vertex shader output: clip-space position and the values interpolated across the triangle
+struct SoftwareVertex
+{
+    float position[4];
+    float varyings[SOFTWARE_MAX_VARYINGS];
+};
+
+
+// One row of a tile; lanes not set in `mask` hold no fragment
+struct SoftwareFragments
+{
+    uint32_t mask;
+    float x[SOFTWARE_TILE_SIZE];
+    float y[SOFTWARE_TILE_SIZE];
+    float z[SOFTWARE_TILE_SIZE];
+    float varyings[SOFTWARE_MAX_VARYINGS][SOFTWARE_TILE_SIZE];
+};
+
+
+struct SoftwareColors
+{
+    float rgba[4][SOFTWARE_TILE_SIZE];
+};
+
+
+// Attributes are decoded to floats, missing components filled as (0, 0, 0, 1)
+typedef void (*SoftwareVertexShader)(const void* uniforms, const float (*attributes)[4], SoftwareVertex& vertex);
+typedef void (*SoftwareFragmentShader)(const void* uniforms, const SoftwareFragments& fragments, SoftwareColors& colors);
+
+
+/**
+ * C++ stand-in for a shader program; both callbacks run concurrently on the job system workers, so they
+ * must only read `uniforms`
+ *
+ * `uniform_size` bytes of uniforms are copied at each draw, like GL uniform state, so the struct must be
+ * trivially copyable; whatever it points at (textures) must live until the draw is flushed.
+ */
+struct SoftwareShader
+{
+    SoftwareVertexShader vertex_shader;
+    SoftwareFragmentShader fragment_shader;
+    uint32_t varying_count;
+    uint32_t uniform_size;
+};
+
+
+// CPU-side mesh data; the layout is the same table `GL_VertexFormat`/`GL_AttribArray` configure VAOs from
+struct SoftwareMesh
+{
+    GL_LayoutTable layout;
+    const uint8_t* vertex_data;
+    uint32_t vertex_count;
+    const uint32_t* index_data;
+    uint32_t index_count;
+};
+
+
+/**
+ * RGBA8 texture sampled like a `GL_Texture2D` (bilinear, clamped to the edge); built from the same
+ * decoded image data, so rows are in upload order (`v` = 0 is the first row)
+ */
+class SoftwareTexture
+{
+private:
+    std::vector<uint32_t> m_texels;
+    int32_t m_width;
+    int32_t m_height;
+
+public:
+    SoftwareTexture();
+    explicit SoftwareTexture(const GL_ImageData& image_data);
+
+    void load_image(const std::string& image_file_path, bool flip_vertically = false);
+    void set_image(const GL_ImageData& image_data);
+    void sample(float u, float v, float* rgba) const;
+    // Samples a fragment row; lanes outside `mask` may or may not be sampled
+    void sample(const float* u, const float* v, uint32_t mask, float (*rgba)[SOFTWARE_TILE_SIZE]) const;
+
+    inline int32_t get_width() const { return m_width; }
+    inline int32_t get_height() const { return m_height; }
+};
+
+
+struct SoftwareRenderStats
+{
+    uint32_t draw_calls;
+    uint32_t triangles;
+    uint32_t fragments;
+};
+
+
+// Screen-space triangle ready for rasterization
+struct SoftwareTriangle
+{
+    // Edge k is opposite vertex k, evaluated from its lexicographically smaller endpoint
+    float edge_x[3], edge_y[3], edge_dx[3], edge_dy[3], edge_sign[3];
+    uint32_t top_left_mask;
+    float inverse_area;
+    float z[3];
+    float inverse_w[3];
+    float varyings[3][SOFTWARE_MAX_VARYINGS];
+    int32_t min_x, min_y, max_x, max_y;
+    uint32_t draw_idx;
+    bool valid;
+};
+
+
+// State of a queued draw, as captured by `SoftwareRenderer::draw`
+struct SoftwareDraw
+{
+    SoftwareShader shader;
+    // Into the renderer's frame uniform data
+    size_t uniform_offset;
+    bool depth_test;
+};
+
+
+/**
+ * CPU rasterizer with the draw model of `GL_Renderer`, for GPU-less rendering (thumbnails, build farms)
+ * and as a reference for the GL output
+ *
+ * Rasterization is deferred to `flush`. `draw` runs vertex shading and clipping (near/far planes) with
+ * triangle setup as two job system passes, then bins the triangles in submission order into 64x64 pixel
+ * bins; `flush` rasterizes every bin once for all draws queued since the last flush, bins in parallel,
+ * 8x8 tiles at a time, evaluating the edge functions one 8-pixel row per step (AVX2 when available). So
+ * a frame of many small draws still spreads over every worker, and a bin's pixels stay in cache across
+ * draws. Edges are always evaluated from the same endpoint and use a top-left fill rule, so triangles
+ * sharing an edge never leave gaps or overlap.
+ *
+ * Matches the GL conventions: window origin at the bottom-left, pixel centers at half coordinates,
+ * counter-clockwise front faces, depth in [0, 1]. Depth testing (LESS) and back-face culling are off by
+ * default, like the GL state the renderer leaves.
+ *
+ * It is deliberately not a drop-in `GL_Renderer`: there is no renderer interface to implement, and the GL
+ * draw path takes GPU objects (mesh pool handles, shader programs, command lists), so this takes CPU-side
+ * meshes and C++ shaders instead. It needs no GL context; `--benchmark` renders a 1080p scene with it
+ * before any window is created.
+ *
+ * `clear` is deferred the same way and applied to each bin just before its triangles, so it runs in
+ * parallel and leaves the bin's pixels in cache; it covers every pixel, so it also drops unflushed draws.
+ *
+ * NOTE: `draw` and `flush` must be called from the main thread or a job system worker; `get_pixels` reads
+ * the result of the last `flush`
+ */
+class SoftwareRenderer
+{
+private:
+    uint32_t m_width;
+    uint32_t m_height;
+    std::vector<uint32_t> m_color_buffer;
+    std::vector<float> m_depth_buffer;
+    bool m_depth_test;
+    bool m_cull_back_faces;
+
+    // Applied per bin by the next `flush`, right before the bin's triangles
+    bool m_clear_pending;
+    uint32_t m_clear_color;
+    float m_clear_depth;
+
+    uint32_t m_bin_columns;
+    uint32_t m_bin_rows;
+    std::vector<std::vector<uint32_t>> m_bins;
+    std::vector<SoftwareVertex> m_vertices;
+    // Triangles of every queued draw, binned by index
+    std::vector<SoftwareTriangle> m_triangles;
+    std::vector<SoftwareDraw> m_draws;
+    std::vector<uint8_t> m_uniform_data;
+
+    SoftwareRenderStats m_frame_stats;
+
+private:
+    void setup_triangles(const SoftwareVertex* const vertices[3], uint32_t varying_count, SoftwareTriangle* triangles) const;
+    void setup_triangle(const SoftwareVertex* const vertices[3], uint32_t varying_count, SoftwareTriangle& triangle) const;
+    uint32_t rasterize_bin(uint32_t bin_idx);
+    void discard_draws();
+
+public:
+    SoftwareRenderer(uint32_t width, uint32_t height);
+
+    void resize(uint32_t width, uint32_t height);
+    void clear(float red, float green, float blue, float alpha, float depth = 1.0f);
+
+    void draw(const SoftwareMesh& mesh, const SoftwareShader& shader, const void* uniforms);
+    void flush();
+
+    inline void set_depth_test(bool depth_test) { m_depth_test = depth_test; }
+    inline void set_cull_back_faces(bool cull_back_faces) { m_cull_back_faces = cull_back_faces; }
+
+    // RGBA8, bottom row first (the `glReadPixels` layout)
+    inline const uint8_t* get_pixels() const { return (const uint8_t*)m_color_buffer.data(); }
+    inline uint32_t get_width() const { return m_width; }
+    inline uint32_t get_height() const { return m_height; }
+
+    inline const SoftwareRenderStats& get_frame_stats() const { return m_frame_stats; }
+    inline void reset_frame_stats() { m_frame_stats = {}; }
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "software_renderer.h"
+
+
+// Uniforms of `software_example_shader`
+struct SoftwareExampleUniforms
+{
+    float model_view_projection[16];
+    float color[4];
+    float time;
+    const SoftwareTexture* texture0;
+    const SoftwareTexture* texture1;
+};
+
+
+/**
+ * Port of res/shaders/example.vert/.frag: position (attribute 0) and uv (attribute 1) in, the pulsing
+ * color blended with both textures out
+ */
+extern const SoftwareShader software_example_shader;
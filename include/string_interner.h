@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Maps strings to small, stable integer IDs (shared across the whole program)
+ *
+ * NOTE: IDs are never released; intern names (uniforms, attributes, ...) and not per-frame data
+ */
+uint32_t intern_string(std::string_view string);
+
+
+const std::string& get_interned_string(uint32_t string_id);
@@ -5,13 +5,23 @@
 #include "renderer.h"
 
 
+struct GL_ImageData
+{
+    unsigned char* pixels;
+    int32_t width, height, channels;
+};
+
+
 class GL_Texture2D
 {
 private:
     uint32_t m_gl_id;
     std::string m_file_path;
 
-    unsigned char* m_image_buffer;
+    uint32_t m_gl_texture_slot;
+    bool m_flip_vertically, m_transparent;
+    int32_t m_requested_channels;
+
     int32_t m_width, m_height, m_channels;
 
 public:
@@ -21,10 +31,17 @@ public:
     ~GL_Texture2D();
 
     void load_image(uint32_t gl_texture_slot, const std::string& image_file_path, bool flip_vertically = false, bool transparent = false, int32_t channels = 0);
+    void upload_image(const GL_ImageData& image_data);
+
+    static GL_ImageData decode_image(const std::string& image_file_path, bool flip_vertically, int32_t channels);
+    static void free_image(GL_ImageData& image_data);
 
     void gl_bind(uint32_t gl_texture_slot = 0) const;
     void gl_unbind() const;
 
+    inline const std::string& get_file_path() const { return m_file_path; }
+    inline bool get_flip_vertically() const { return m_flip_vertically; }
+    inline int32_t get_requested_channels() const { return m_requested_channels; }
     inline int32_t get_width() const { return m_width; }
     inline int32_t get_height() const { return m_height; }
     inline int32_t get_channels() const { return m_channels; }
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "data_buffer.h"
+#include "mat4.h"
+
+
+typedef uint32_t TransformHandle;
+
+
+/**
+ * Transform hierarchy with local TRS stored structure-of-arrays
+ *
+ * Nodes are kept in depth-first pre-order, so every parent precedes its children and every subtree is a
+ * contiguous range; `update` computes world matrices in one linear pass. Changing a node flags it and
+ * marks its ancestors as having a dirty subtree, and the pass skips whole clean subtrees by their size.
+ * Creating, destroying or re-parenting nodes only flags the order, which is rebuilt at the next update.
+ *
+ * World matrices which changed during an update are tracked as one contiguous range, so `upload` only
+ * streams that span of the instance buffer (one Mat4 per node, in `get_index` order).
+ */
+class TransformSystem
+{
+private:
+    // Local TRS, SoA
+    std::vector<float> m_position_x, m_position_y, m_position_z;
+    std::vector<float> m_rotation_x, m_rotation_y, m_rotation_z, m_rotation_w;
+    std::vector<float> m_scale_x, m_scale_y, m_scale_z;
+
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_subtree_sizes;
+    std::vector<uint8_t> m_local_dirty;
+    std::vector<uint8_t> m_subtree_dirty;
+    std::vector<uint8_t> m_world_changed;
+    std::vector<uint8_t> m_alive;
+    std::vector<Mat4> m_world;
+
+    std::vector<TransformHandle> m_index_to_handle;
+    std::vector<uint32_t> m_handle_to_index;
+    std::vector<TransformHandle> m_free_handles;
+    bool m_order_dirty;
+
+    uint32_t m_changed_begin, m_changed_end;
+    uint32_t m_uploaded_count;
+
+private:
+    void mark_dirty(uint32_t index);
+    void rebuild_order();
+
+public:
+    static constexpr TransformHandle INVALID_HANDLE = UINT32_MAX;
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    TransformSystem();
+
+    void reserve(uint32_t count);
+
+    TransformHandle create(TransformHandle parent = INVALID_HANDLE);
+    // Destroys the node and its whole subtree
+    void destroy(TransformHandle handle);
+    void set_parent(TransformHandle handle, TransformHandle parent);
+
+    void set_position(TransformHandle handle, float x, float y, float z);
+    void set_rotation(TransformHandle handle, float x, float y, float z, float w);
+    void set_scale(TransformHandle handle, float x, float y, float z);
+
+    void update();
+
+    // Streams the world matrices changed by the last `update` (all of them when the buffer is too small)
+    void upload(GL_DataBuffer<float>* instance_buffer);
+
+    inline uint32_t get_index(TransformHandle handle) const { return m_handle_to_index[handle]; }
+    inline const Mat4& get_world(TransformHandle handle) const { return m_world[m_handle_to_index[handle]]; }
+    inline const Mat4* get_world_matrices() const { return m_world.data(); }
+    inline uint32_t get_count() const { return (uint32_t)m_index_to_handle.size(); }
+};
@@ -18,6 +18,7 @@ public:
     ~GL_VertexArray();
 
     void set_buffer(GL_AttribArray* attrib_array, GL_DataBuffer<T>* data_buffer);
+    void set_buffer(const GL_LayoutTable& layout, GL_DataBuffer<T>* data_buffer);
 
     void bind() const;
     void unbind() const;
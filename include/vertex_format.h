@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "attrib_array.h"
+
+
+uint64_t hash_layout(const GL_LayoutTable& layout);
+
+
+/**
+ * VAO which only describes a vertex format (ARB_vertex_attrib_binding); vertex data is attached at draw
+ * time through binding point 0 with `glBindVertexBuffer`, so every mesh with the same layout shares it
+ */
+class GL_VertexFormat
+{
+private:
+    uint32_t m_gl_id;
+    uint64_t m_hash;
+    uint32_t m_stride;
+    std::vector<GL_AttribElement> m_elements;
+
+public:
+    GL_VertexFormat(const GL_LayoutTable& layout);
+
+    ~GL_VertexFormat();
+
+    GL_VertexFormat(const GL_VertexFormat&) = delete;
+    GL_VertexFormat& operator=(const GL_VertexFormat&) = delete;
+
+    bool matches(const GL_LayoutTable& layout) const;
+
+    void bind() const;
+    void unbind() const;
+
+    inline uint32_t get_id() const { return m_gl_id; }
+    inline uint64_t get_hash() const { return m_hash; }
+    inline uint32_t get_stride() const { return m_stride; }
+};
+
+
+class GL_VertexFormatCache
+{
+private:
+    std::unordered_multimap<uint64_t, std::unique_ptr<GL_VertexFormat>> m_formats;
+
+public:
+    const GL_VertexFormat* get(const GL_LayoutTable& layout);
+
+    void clear();
+
+    inline uint32_t get_count() const { return (uint32_t)m_formats.size(); }
+};
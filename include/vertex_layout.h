@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include "attrib_array.h"
+#include "gl_utils.h"
+
+
+/**
+ * Compile-time vertex attribute description
+ */
+template<typename T, uint32_t Count, bool Normalized = false>
+struct GL_Attrib
+{
+    static_assert(GL_TypeTraits<T>::gl_type, "Unsupported vertex attribute type");
+    static_assert(Count >= 1 && Count <= 4, "Vertex attributes must have 1-4 components");
+    static_assert(!is_gl_packed_type<T> || Count == 4, "Packed vertex attributes must have 4 components");
+
+    using type = T;
+    static constexpr uint32_t component_count = Count;
+    static constexpr bool normalized = Normalized;
+    static constexpr uint32_t size = is_gl_packed_type<T> ? (uint32_t)sizeof(T) : Count * (uint32_t)sizeof(T);
+};
+
+
+/**
+ * A vertex struct member as checked by `GL_VertexLayout::matches`; spelled through `GL_VERTEX_MEMBER`
+ */
+template<typename T, size_t Offset>
+struct GL_VertexMember
+{
+    using type = T;
+    static constexpr uint32_t offset = (uint32_t)Offset;
+};
+
+#define GL_VERTEX_MEMBER(vertex, member) GL_VertexMember<decltype(vertex::member), offsetof(vertex, member)>
+
+
+/**
+ * Compile-time vertex layout; strides, offsets and GL types are computed by the compiler and stored in a
+ * static table which can be handed straight to `GL_VertexArray::set_buffer`
+ *
+ * Usage:
+ *     using QuadLayout = GL_VertexLayout<GL_Attrib<float, 2>, GL_Attrib<float, 2>>;
+ *     static_assert(QuadLayout::matches<QuadVertex, GL_VERTEX_MEMBER(QuadVertex, position), GL_VERTEX_MEMBER(QuadVertex, uv)>());
+ */
+template<typename... Attribs>
+struct GL_VertexLayout
+{
+    static_assert(sizeof...(Attribs) > 0, "Vertex layouts need at least one attribute");
+
+    static constexpr uint32_t count = (uint32_t)sizeof...(Attribs);
+    static constexpr uint32_t stride = (Attribs::size + ...);
+
+    static constexpr std::array<uint32_t, count> offsets = []() {
+        std::array<uint32_t, count> attrib_offsets = {};
+        uint32_t attrib_sizes[count] = { Attribs::size... };
+        uint32_t attrib_offset = 0;
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            attrib_offsets[idx] = attrib_offset;
+            attrib_offset += attrib_sizes[idx];
+        }
+        return attrib_offsets;
+    }();
+
+    static constexpr std::array<GL_AttribElement, count> elements = []() {
+        std::array<GL_AttribElement, count> attrib_elements = { GL_AttribElement{
+            Attribs::component_count,
+            GL_TypeTraits<typename Attribs::type>::gl_type,
+            Attribs::normalized ? GL_TRUE : GL_FALSE,
+            (uint32_t)sizeof(typename Attribs::type),
+            Attribs::size,
+            0 }... };
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            attrib_elements[idx].offset = offsets[idx];
+        }
+        return attrib_elements;
+    }();
+
+    /**
+     * True when `Vertex` can be uploaded as-is: one member per attribute, in order, each at the attribute's
+     * offset with its size and component type (arrays of it, or the packed type itself), and no padding
+     */
+    template<typename Vertex, typename... Members>
+    static constexpr bool matches()
+    {
+        static_assert(sizeof...(Members) == count, "Vertex layouts are matched against one member per attribute");
+
+        if (sizeof(Vertex) != stride || !std::is_standard_layout_v<Vertex> || !std::is_trivially_copyable_v<Vertex>)
+            return false;
+        if (!((sizeof(typename Members::type) == Attribs::size &&
+            std::is_same_v<std::remove_all_extents_t<typename Members::type>, typename Attribs::type>) && ...))
+            return false;
+
+        uint32_t member_offsets[count] = { Members::offset... };
+        for (uint32_t idx = 0; idx < count; idx++)
+        {
+            if (member_offsets[idx] != offsets[idx])
+                return false;
+        }
+        return true;
+    }
+
+    static constexpr GL_LayoutTable get_table()
+    {
+        return { elements.data(), count, stride };
+    }
+};
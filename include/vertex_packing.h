@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "gl_utils.h"
+#include "vertex_layout.h"
+
+
+/**
+ * Bulk float -> packed vertex attribute converters (AVX2/F16C and SSE2 paths with scalar fallbacks)
+ *
+ * NOTE: snorm values follow the GL 4.2+ convention, `f = max(c / (2^(b-1) - 1), -1)`, so 0 and +-1 are exact
+ */
+void pack_half(const float* src, GL_Half* dst, size_t count);
+void pack_snorm16(const float* src, int16_t* dst, size_t count);
+void pack_snorm8(const float* src, int8_t* dst, size_t count);
+void pack_unorm16(const float* src, uint16_t* dst, size_t count);
+
+// Packs `count` vectors of `src_components` (3 or 4) floats; a missing w component is packed as 0
+void pack_snorm_2_10_10_10(const float* src, uint32_t src_components, GL_Packed_2_10_10_10* dst, size_t count);
+
+float unpack_half(GL_Half value);
+
+
+/**
+ * Half-bandwidth mesh vertex: half float position (w padding), 2_10_10_10 normal and half float UV
+ */
+struct GL_PackedVertex
+{
+    GL_Half position[4];
+    GL_Packed_2_10_10_10 normal;
+    GL_Half uv[2];
+};
+
+using GL_PackedVertexLayout = GL_VertexLayout<GL_Attrib<GL_Half, 4>, GL_Attrib<GL_Packed_2_10_10_10, 4, true>, GL_Attrib<GL_Half, 2>>;
+static_assert(GL_PackedVertexLayout::matches<GL_PackedVertex,
+    GL_VERTEX_MEMBER(GL_PackedVertex, position), GL_VERTEX_MEMBER(GL_PackedVertex, normal), GL_VERTEX_MEMBER(GL_PackedVertex, uv)>(),
+    "GL_PackedVertexLayout does not match GL_PackedVertex");
+
+
+// Packs separate position (xyz), normal (xyz) and uv streams into interleaved `GL_PackedVertex` data
+void pack_vertices(const float* positions, const float* normals, const float* uvs, GL_PackedVertex* dst, size_t count);
@@ -1,6 +1,14 @@
 #version 460 core
 
-uniform float u_time;
+layout(std140, binding = 1) uniform FrameTime
+{
+    float u_time;
+    float u_delta_time;
+    float u_smoothed_delta_time;
+    float u_alpha;
+    uint u_frame_index;
+};
+
 uniform vec4 u_color;
 uniform sampler2D u_texture0;
 uniform sampler2D u_texture1;
@@ -5,10 +5,12 @@ layout(location = 1) in vec2 uv;
 
 out vec2 v_uv;
 
+uniform mat4 u_model_view_projection;
+
 
 void main()
 {
     v_uv = uv;
 
-    gl_Position = position;
+    gl_Position = u_model_view_projection * position;
 }
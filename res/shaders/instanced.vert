@@ -0,0 +1,21 @@
+#version 460 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 uv;
+
+layout(std430, binding = 0) readonly buffer Instances
+{
+    mat4 u_world[];
+};
+
+out vec2 v_uv;
+
+uniform mat4 u_view_projection;
+
+
+void main()
+{
+    v_uv = uv;
+
+    gl_Position = u_view_projection * u_world[gl_BaseInstance + gl_InstanceID] * position;
+}
@@ -0,0 +1,122 @@
+#include "allocation_counter.h"
+
+#if defined(COUNT_ALLOCATIONS)
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+
+static std::atomic<uint64_t> s_allocation_count(0);
+
+
+static void* counted_allocate(size_t size)
+{
+    s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+
+static void* counted_allocate_aligned(size_t size, size_t alignment)
+{
+    s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+#if defined(_WIN32)
+    return _aligned_malloc(size ? size : 1, alignment);
+#else
+    // aligned_alloc requires a size multiple of the alignment
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+
+static void counted_free_aligned(void* pointer)
+{
+#if defined(_WIN32)
+    _aligned_free(pointer);
+#else
+    free(pointer);
+#endif
+}
+
+
+void* operator new(size_t size)
+{
+    if (void* pointer = counted_allocate(size))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(size);
+}
+
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return counted_allocate(size);
+}
+
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    if (void* pointer = counted_allocate_aligned(size, (size_t)alignment))
+        return pointer;
+    throw std::bad_alloc();
+}
+
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return counted_allocate_aligned(size, (size_t)alignment);
+}
+
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return counted_allocate_aligned(size, (size_t)alignment);
+}
+
+
+void operator delete(void* pointer) noexcept { free(pointer); }
+void operator delete[](void* pointer) noexcept { free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete(void* pointer, size_t, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, size_t, std::align_val_t) noexcept { counted_free_aligned(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { counted_free_aligned(pointer); }
+
+
+uint64_t get_allocation_count()
+{
+    return s_allocation_count.load(std::memory_order_relaxed);
+}
+
+#else
+
+uint64_t get_allocation_count()
+{
+    return 0;
+}
+
+#endif
@@ -19,14 +19,16 @@ void GL_AttribArray::push(uint32_t count, bool normalized)
     uint32_t gl_type = get_gl_type<T>();
     ASSERT(gl_type);
     uint32_t data_size = (uint32_t)sizeof(T);
-    uint32_t stride = count * data_size;
+    uint32_t stride = is_gl_packed_type<T> ? data_size : count * data_size;
+    ASSERT(!is_gl_packed_type<T> || count == 4);
 
     m_layout.push_back({
         count,
         gl_type,
         normalized ? GL_TRUE : GL_FALSE,
         data_size,
-        stride});
+        stride,
+        m_stride});
     m_stride += stride;
 }
 
@@ -39,4 +41,6 @@ template void GL_AttribArray::push<int32_t>(uint32_t, bool);
 template void GL_AttribArray::push<uint32_t>(uint32_t, bool);
 template void GL_AttribArray::push<float>(uint32_t, bool);
 template void GL_AttribArray::push<double>(uint32_t, bool);
+template void GL_AttribArray::push<GL_Half>(uint32_t, bool);
+template void GL_AttribArray::push<GL_Packed_2_10_10_10>(uint32_t, bool);
 template void GL_AttribArray::push<int32_t>(uint32_t, bool);
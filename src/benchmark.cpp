@@ -0,0 +1,303 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include "bvh.h"
+#include "frustum_culling.h"
+#include "gl_utils.h"
+#include "job_system.h"
+#include "mat4.h"
+#include "mesh_optimizer.h"
+#include "software_shaders.h"
+#include "vertex_layout.h"
+
+
+static const uint32_t BENCHMARK_RUN_COUNT = 9;
+static const uint32_t BENCHMARK_RAY_COUNT = 10000;
+// Textured quads in the software renderer frame, each covering about twice its grid cell
+static const uint32_t BENCHMARK_QUAD_COLUMNS = 32;
+static const uint32_t BENCHMARK_QUAD_ROWS = 18;
+static const float BENCHMARK_QUAD_SCALE = 1.4f;
+// Objects are scattered through a cube of this half size around the camera
+static const float BENCHMARK_WORLD_EXTENT = 500.0f;
+
+
+// Fixed-seed xorshift32, so every run benchmarks the same data
+static uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+template<typename T>
+static void shuffle(std::vector<T>& values, uint32_t& random_state)
+{
+    for (size_t value_idx = values.size(); value_idx > 1; value_idx--)
+        std::swap(values[value_idx - 1], values[next_random(random_state) % value_idx]);
+}
+
+
+// Median of `BENCHMARK_RUN_COUNT` timed runs, after one warm-up run
+template<typename F>
+static double measure_ms(F&& function)
+{
+    function();
+
+    std::vector<double> times;
+    for (uint32_t run_idx = 0; run_idx < BENCHMARK_RUN_COUNT; run_idx++)
+    {
+        std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+        function();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin_time).count());
+    }
+    std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+    return times[times.size() / 2];
+}
+
+
+// Object AABBs as 6 floats each (center x/y/z followed by half extents x/y/z), randomly placed and sized
+static std::vector<float> make_object_bounds(uint32_t object_count)
+{
+    uint32_t random_state = 0x9E3779B9u;
+    auto random_float = [&random_state](float min, float max) {
+        return min + (max - min) * (next_random(random_state) >> 8) / (float)(1 << 24);
+    };
+
+    std::vector<float> object_bounds((size_t)object_count * 6);
+    for (uint32_t object_idx = 0; object_idx < object_count; object_idx++)
+    {
+        float* bounds = &object_bounds[(size_t)object_idx * 6];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            bounds[axis] = random_float(-BENCHMARK_WORLD_EXTENT, BENCHMARK_WORLD_EXTENT);
+            bounds[3 + axis] = random_float(0.5f, 2.0f);
+        }
+    }
+    return object_bounds;
+}
+
+
+// 60 degree (vertical) 16:9 camera at the origin looking down +x, seeing about a tenth of the objects
+static Frustum make_frustum()
+{
+    const float eye[3] = { 0.0f, 0.0f, 0.0f };
+    const float target[3] = { 1.0f, 0.0f, 0.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    Mat4 view_projection = mat4_multiply(mat4_perspective(1.0472f, 16.0f / 9.0f, 0.1f, BENCHMARK_WORLD_EXTENT * 2.0f), mat4_look_at(eye, target, up));
+    return Frustum::from_matrix(view_projection.m);
+}
+
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& options) :
+    m_options(options)
+{
+}
+
+
+/**
+ * Vertex cache statistics before and after the full optimization pipeline, on a grid mesh whose quads
+ * and vertices are shuffled to stand in for an asset exported in arbitrary order
+ */
+void BenchmarkSuite::run_mesh_optimizer(uint32_t grid_size)
+{
+    uint32_t vertex_count = (grid_size + 1) * (grid_size + 1);
+    uint32_t random_state = 0x2545F491u;
+
+    std::vector<uint32_t> vertex_order(vertex_count);
+    for (uint32_t vertex_idx = 0; vertex_idx < vertex_count; vertex_idx++)
+        vertex_order[vertex_idx] = vertex_idx;
+    shuffle(vertex_order, random_state);
+
+    MeshData mesh_data;
+    mesh_data.vertices.resize(vertex_count);
+    for (uint32_t row = 0; row <= grid_size; row++)
+    {
+        for (uint32_t column = 0; column <= grid_size; column++)
+        {
+            float u = column / (float)grid_size, v = row / (float)grid_size;
+            mesh_data.vertices[vertex_order[row * (grid_size + 1) + column]] = { { u * 2.0f - 1.0f, v * 2.0f - 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { u, v } };
+        }
+    }
+
+    std::vector<uint32_t> quad_order(grid_size * grid_size);
+    for (uint32_t quad_idx = 0; quad_idx < (uint32_t)quad_order.size(); quad_idx++)
+        quad_order[quad_idx] = quad_idx;
+    shuffle(quad_order, random_state);
+    for (uint32_t quad_idx : quad_order)
+    {
+        uint32_t corner = (quad_idx / grid_size) * (grid_size + 1) + quad_idx % grid_size;
+        uint32_t v0 = vertex_order[corner], v1 = vertex_order[corner + 1];
+        uint32_t v2 = vertex_order[corner + grid_size + 1], v3 = vertex_order[corner + grid_size + 2];
+        mesh_data.indices.insert(mesh_data.indices.end(), { v0, v1, v2, v2, v1, v3 });
+    }
+
+    MeshOptimizeReport report = optimize_mesh(mesh_data);
+    fprintf(stdout, "INFO | Benchmark > [mesh_optimizer] %u triangles, %u -> %u vertices; ACMR %.3f -> %.3f, ATVR %.3f -> %.3f; %zu-bit indices; %.2f ms\n",
+        grid_size * grid_size * 2, report.vertex_count_before, report.vertex_count_after,
+        report.cache_before.acmr, report.cache_after.acmr, report.cache_before.atvr, report.cache_after.atvr,
+        get_gl_type_size(report.index_gl_type) * 8, report.optimize_ms);
+}
+
+
+// Flat SoA culling over every object, on one thread and on every job system worker
+void BenchmarkSuite::run_frustum_culling()
+{
+    std::vector<float> object_bounds = make_object_bounds(m_options.object_count);
+    FrustumCuller culler;
+    culler.reserve(m_options.object_count);
+    for (uint32_t object_idx = 0; object_idx < m_options.object_count; object_idx++)
+        culler.add(&object_bounds[(size_t)object_idx * 6], &object_bounds[(size_t)object_idx * 6 + 3]);
+
+    Frustum frustum = make_frustum();
+    std::vector<uint32_t> visible;
+    uint32_t worker_count = JobSystem::get().get_worker_count();
+    double single_thread_ms = measure_ms([&]() { culler.cull(frustum, visible, 1); });
+    double multi_thread_ms = measure_ms([&]() { culler.cull(frustum, visible, 0); });
+
+    fprintf(stdout, "INFO | Benchmark > [frustum_culling] %u objects, %zu visible; %.3f ms on 1 thread, %.3f ms on %u worker(s)\n",
+        m_options.object_count, visible.size(), single_thread_ms, multi_thread_ms, worker_count);
+}
+
+
+// BVH build, node memory, hierarchical culling (against the flat culler's result), refit and ray queries
+void BenchmarkSuite::run_bvh()
+{
+    // Min/max bounds, as the BVH takes them
+    std::vector<float> object_bounds = make_object_bounds(m_options.object_count);
+    for (uint32_t object_idx = 0; object_idx < m_options.object_count; object_idx++)
+    {
+        float* bounds = &object_bounds[(size_t)object_idx * 6];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            float center = bounds[axis], extent = bounds[3 + axis];
+            bounds[axis] = center - extent;
+            bounds[3 + axis] = center + extent;
+        }
+    }
+
+    // One timed build; at this size it takes long enough to be stable
+    BVH bvh;
+    bvh.build(object_bounds.data(), m_options.object_count);
+    const BVH_Stats& stats = bvh.get_stats();
+
+    Frustum frustum = make_frustum();
+    std::vector<uint32_t> visible, flat_visible;
+    double cull_ms = measure_ms([&]() { bvh.cull(frustum, visible); });
+    double refit_ms = measure_ms([&]() { bvh.refit(); });
+
+    FrustumCuller culler;
+    culler.reserve(m_options.object_count);
+    for (uint32_t object_idx = 0; object_idx < m_options.object_count; object_idx++)
+    {
+        const float* bounds = &object_bounds[(size_t)object_idx * 6];
+        float center[3], extents[3];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            center[axis] = 0.5f * (bounds[axis] + bounds[3 + axis]);
+            extents[axis] = 0.5f * (bounds[3 + axis] - bounds[axis]);
+        }
+        culler.add(center, extents);
+    }
+    culler.cull(frustum, flat_visible);
+    // The BVH emits objects in tree order
+    std::vector<uint32_t> sorted_visible = visible;
+    std::sort(sorted_visible.begin(), sorted_visible.end());
+
+    // Rays from the origin in random directions
+    uint32_t random_state = 0x68E31DA4u;
+    std::vector<float> directions(BENCHMARK_RAY_COUNT * 3);
+    for (float& direction : directions)
+        direction = (next_random(random_state) >> 8) / (float)(1 << 23) - 1.0f;
+    uint32_t hit_count = 0;
+    double raycast_ms = measure_ms([&]() {
+        const float origin[3] = { 0.0f, 0.0f, 0.0f };
+        hit_count = 0;
+        for (uint32_t ray_idx = 0; ray_idx < BENCHMARK_RAY_COUNT; ray_idx++)
+        {
+            BVH_RayHit hit;
+            hit_count += bvh.raycast(origin, &directions[ray_idx * 3], BENCHMARK_WORLD_EXTENT, hit);
+        }
+    });
+
+    fprintf(stdout, "INFO | Benchmark > [bvh] %u objects; build %.2f ms, %u nodes (depth %u), %.2f MB; refit %.3f ms\n",
+        m_options.object_count, stats.build_ms, stats.node_count, stats.max_depth, stats.memory_size / (1024.0 * 1024.0), refit_ms);
+    fprintf(stdout, "INFO | Benchmark > [bvh] cull %.3f ms, %zu visible (%s the flat culler); %u rays in %.3f ms, %u hit(s)\n",
+        cull_ms, visible.size(), sorted_visible == flat_visible ? "matches" : "differs from", BENCHMARK_RAY_COUNT, raycast_ms, hit_count);
+}
+
+
+// Frame of overlapping textured quads through the example shader port, rendered without a GL context
+void BenchmarkSuite::run_software_renderer()
+{
+    static const float quad_vertex_data[] = {
+        -0.5f,   0.5f,   0.0f, 1.0f,
+         0.5f,   0.5f,   1.0f, 1.0f,
+        -0.5f,  -0.5f,   0.0f, 0.0f,
+         0.5f,  -0.5f,   1.0f, 0.0f,
+    };
+    static const uint32_t quad_index_data[] = { 0, 1, 2, 2, 1, 3 };
+    const SoftwareMesh quad_mesh = {
+        GL_VertexLayout<GL_Attrib<float, 2>, GL_Attrib<float, 2>>::get_table(),
+        (const uint8_t*)quad_vertex_data, 4, quad_index_data, 6
+    };
+
+    SoftwareTexture texture0, texture1;
+    texture0.load_image("./res/textures/uv_texture.jpg", true);
+    texture1.load_image("./res/textures/fug.png", true);
+
+    // Model-view-projection of every quad, in clip space directly
+    std::vector<SoftwareExampleUniforms> quad_uniforms(BENCHMARK_QUAD_COLUMNS * BENCHMARK_QUAD_ROWS);
+    for (uint32_t quad_idx = 0; quad_idx < (uint32_t)quad_uniforms.size(); quad_idx++)
+    {
+        SoftwareExampleUniforms& uniforms = quad_uniforms[quad_idx];
+        uniforms = {};
+        uniforms.color[0] = 0.03f;
+        uniforms.color[1] = 0.67f;
+        uniforms.color[2] = 0.92f;
+        uniforms.color[3] = 1.0f;
+        uniforms.texture0 = &texture0;
+        uniforms.texture1 = &texture1;
+
+        const float cell_size[2] = { 2.0f / BENCHMARK_QUAD_COLUMNS, 2.0f / BENCHMARK_QUAD_ROWS };
+        const float position[3] = {
+            -1.0f + (quad_idx % BENCHMARK_QUAD_COLUMNS + 0.5f) * cell_size[0], -1.0f + (quad_idx / BENCHMARK_QUAD_COLUMNS + 0.5f) * cell_size[1], 0.0f
+        };
+        const float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        const float scale[3] = { cell_size[0] * BENCHMARK_QUAD_SCALE, cell_size[1] * BENCHMARK_QUAD_SCALE, 1.0f };
+        Mat4 model = mat4_from_trs(position, rotation, scale);
+        memcpy(uniforms.model_view_projection, model.m, sizeof(uniforms.model_view_projection));
+    }
+
+    SoftwareRenderer software_renderer(m_options.frame_width, m_options.frame_height);
+    double frame_ms = measure_ms([&]() {
+        software_renderer.reset_frame_stats();
+        software_renderer.clear(0.0f, 0.0f, 0.0f, 0.0f);
+        for (const SoftwareExampleUniforms& uniforms : quad_uniforms)
+            software_renderer.draw(quad_mesh, software_example_shader, &uniforms);
+        software_renderer.flush();
+    });
+
+    const SoftwareRenderStats& stats = software_renderer.get_frame_stats();
+    fprintf(stdout, "INFO | Benchmark > [software_renderer] %ux%u, %u draw call(s), %u triangles, %u fragments; %.3f ms on %u worker(s)\n",
+        m_options.frame_width, m_options.frame_height, stats.draw_calls, stats.triangles, stats.fragments, frame_ms,
+        JobSystem::get().get_worker_count());
+}
+
+
+void BenchmarkSuite::run()
+{
+    fprintf(stdout, "INFO | Benchmark > Running CPU benchmarks\n");
+
+    // Small enough for 16-bit indices, then the large mesh
+    run_mesh_optimizer(128);
+    run_mesh_optimizer(m_options.grid_size);
+    run_frustum_culling();
+    run_bvh();
+    run_software_renderer();
+}
@@ -0,0 +1,417 @@
+#include "bvh.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+
+static const uint32_t BVH_BIN_COUNT = 16;
+// Traversal stack entries kept on the stack; deeper trees fall back to a heap allocation
+static const uint32_t BVH_STACK_SIZE = 128;
+
+
+struct BVH_Bin
+{
+    float bounds_min[3];
+    float bounds_max[3];
+    uint32_t count;
+};
+
+
+static inline void reset_bounds(float bounds_min[3], float bounds_max[3])
+{
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        bounds_min[axis] = INFINITY;
+        bounds_max[axis] = -INFINITY;
+    }
+}
+
+
+static inline void grow_bounds(float bounds_min[3], float bounds_max[3], const float other_min[3], const float other_max[3])
+{
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        bounds_min[axis] = std::min(bounds_min[axis], other_min[axis]);
+        bounds_max[axis] = std::max(bounds_max[axis], other_max[axis]);
+    }
+}
+
+
+static inline float half_surface_area(const float bounds_min[3], const float bounds_max[3])
+{
+    float extent_x = bounds_max[0] - bounds_min[0];
+    float extent_y = bounds_max[1] - bounds_min[1];
+    float extent_z = bounds_max[2] - bounds_min[2];
+    return extent_x < 0.0f ? 0.0f : extent_x * extent_y + extent_y * extent_z + extent_z * extent_x;
+}
+
+
+/**
+ * Tests an AABB against the planes in `plane_mask`; returns false if it is outside one of them, otherwise
+ * clears the planes it is fully inside of from the mask
+ */
+static inline bool intersects_planes(const Frustum& frustum, const float bounds_min[3], const float bounds_max[3], uint32_t& plane_mask)
+{
+    for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+    {
+        if (!(plane_mask & (1u << plane_idx)))
+            continue;
+
+        const float* plane = frustum.planes[plane_idx];
+        float distance = plane[3], radius = 0.0f;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            float center = 0.5f * (bounds_min[axis] + bounds_max[axis]);
+            float extent = 0.5f * (bounds_max[axis] - bounds_min[axis]);
+            distance += plane[axis] * center;
+            radius += std::fabs(plane[axis]) * extent;
+        }
+
+        if (distance < -radius)
+            return false;
+        if (distance >= radius)
+            plane_mask &= ~(1u << plane_idx);
+    }
+
+    return true;
+}
+
+
+BVH::BVH() :
+    m_stats({})
+{
+}
+
+
+void BVH::update_node_bounds(BVH_Node& node) const
+{
+    reset_bounds(node.bounds_min, node.bounds_max);
+    for (uint32_t ref_idx = node.first; ref_idx < node.first + node.object_count; ref_idx++)
+    {
+        const float* object_bounds = &m_object_bounds[m_object_refs[ref_idx] * 6];
+        grow_bounds(node.bounds_min, node.bounds_max, object_bounds, object_bounds + 3);
+    }
+}
+
+
+void BVH::build(const float* object_bounds, uint32_t object_count)
+{
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    m_object_bounds.assign(object_bounds, object_bounds + (size_t)object_count * 6);
+    m_object_refs.resize(object_count);
+    for (uint32_t object_idx = 0; object_idx < object_count; object_idx++)
+        m_object_refs[object_idx] = object_idx;
+
+    std::vector<float> centroids((size_t)object_count * 3);
+    for (uint32_t object_idx = 0; object_idx < object_count; object_idx++)
+    {
+        for (uint32_t axis = 0; axis < 3; axis++)
+            centroids[object_idx * 3 + axis] = 0.5f * (object_bounds[object_idx * 6 + axis] + object_bounds[object_idx * 6 + 3 + axis]);
+    }
+
+    m_nodes.clear();
+    m_nodes.reserve(object_count ? object_count * 2 - 1 : 1);
+    m_nodes.push_back({ {}, 0, {}, object_count });
+    m_subtree_refs.clear();
+    m_subtree_refs.reserve(m_nodes.capacity());
+    m_subtree_refs.push_back({ 0, object_count });
+    update_node_bounds(m_nodes[0]);
+
+    m_stats = {};
+    struct BuildEntry { uint32_t node_idx, depth; };
+    std::vector<BuildEntry> build_stack = { { 0, 1 } };
+    while (!build_stack.empty())
+    {
+        BuildEntry entry = build_stack.back();
+        build_stack.pop_back();
+        m_stats.max_depth = std::max(m_stats.max_depth, entry.depth);
+
+        BVH_Node& node = m_nodes[entry.node_idx];
+        if (node.object_count <= MAX_LEAF_SIZE)
+        {
+            m_stats.leaf_count++;
+            continue;
+        }
+
+        // Bin object centroids along each axis of the centroid bounds
+        float centroid_min[3], centroid_max[3];
+        reset_bounds(centroid_min, centroid_max);
+        for (uint32_t ref_idx = node.first; ref_idx < node.first + node.object_count; ref_idx++)
+        {
+            const float* centroid = &centroids[m_object_refs[ref_idx] * 3];
+            grow_bounds(centroid_min, centroid_max, centroid, centroid);
+        }
+
+        float best_cost = INFINITY;
+        uint32_t best_axis = 0, best_split = 0;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            float axis_extent = centroid_max[axis] - centroid_min[axis];
+            if (axis_extent <= 0.0f)
+                continue;
+
+            BVH_Bin bins[BVH_BIN_COUNT];
+            for (BVH_Bin& bin : bins)
+            {
+                reset_bounds(bin.bounds_min, bin.bounds_max);
+                bin.count = 0;
+            }
+
+            float bin_scale = BVH_BIN_COUNT / axis_extent;
+            for (uint32_t ref_idx = node.first; ref_idx < node.first + node.object_count; ref_idx++)
+            {
+                uint32_t object_idx = m_object_refs[ref_idx];
+                uint32_t bin_idx = std::min(BVH_BIN_COUNT - 1, (uint32_t)((centroids[object_idx * 3 + axis] - centroid_min[axis]) * bin_scale));
+                const float* bounds = &m_object_bounds[object_idx * 6];
+                grow_bounds(bins[bin_idx].bounds_min, bins[bin_idx].bounds_max, bounds, bounds + 3);
+                bins[bin_idx].count++;
+            }
+
+            // Sweep from both ends to get the cost of splitting after every bin
+            float left_areas[BVH_BIN_COUNT - 1], right_areas[BVH_BIN_COUNT - 1];
+            uint32_t left_counts[BVH_BIN_COUNT - 1], right_counts[BVH_BIN_COUNT - 1];
+            float left_min[3], left_max[3], right_min[3], right_max[3];
+            reset_bounds(left_min, left_max);
+            reset_bounds(right_min, right_max);
+            uint32_t left_count = 0, right_count = 0;
+            for (uint32_t split = 0; split < BVH_BIN_COUNT - 1; split++)
+            {
+                const BVH_Bin& left_bin = bins[split];
+                grow_bounds(left_min, left_max, left_bin.bounds_min, left_bin.bounds_max);
+                left_count += left_bin.count;
+                left_areas[split] = half_surface_area(left_min, left_max);
+                left_counts[split] = left_count;
+
+                const BVH_Bin& right_bin = bins[BVH_BIN_COUNT - 1 - split];
+                grow_bounds(right_min, right_max, right_bin.bounds_min, right_bin.bounds_max);
+                right_count += right_bin.count;
+                right_areas[BVH_BIN_COUNT - 2 - split] = half_surface_area(right_min, right_max);
+                right_counts[BVH_BIN_COUNT - 2 - split] = right_count;
+            }
+
+            for (uint32_t split = 0; split < BVH_BIN_COUNT - 1; split++)
+            {
+                if (!left_counts[split] || !right_counts[split])
+                    continue;
+
+                float cost = left_counts[split] * left_areas[split] + right_counts[split] * right_areas[split];
+                if (cost < best_cost)
+                {
+                    best_cost = cost;
+                    best_axis = axis;
+                    best_split = split;
+                }
+            }
+        }
+
+        // Keep the node as a leaf when no split beats testing every object (unit traversal cost)
+        float leaf_cost = node.object_count * half_surface_area(node.bounds_min, node.bounds_max);
+        if (best_cost == INFINITY || (node.object_count <= MAX_LEAF_SIZE * 4 && best_cost >= leaf_cost))
+        {
+            m_stats.leaf_count++;
+            continue;
+        }
+
+        // Partition the object references in place around the chosen bin boundary
+        float bin_scale = BVH_BIN_COUNT / (centroid_max[best_axis] - centroid_min[best_axis]);
+        uint32_t* refs_begin = &m_object_refs[node.first];
+        uint32_t* refs_split = std::partition(refs_begin, refs_begin + node.object_count,
+            [&centroids, &centroid_min, best_axis, best_split, bin_scale](uint32_t object_idx) {
+                uint32_t bin_idx = std::min(BVH_BIN_COUNT - 1, (uint32_t)((centroids[object_idx * 3 + best_axis] - centroid_min[best_axis]) * bin_scale));
+                return bin_idx <= best_split;
+            });
+
+        uint32_t left_count = (uint32_t)(refs_split - refs_begin);
+        uint32_t first = node.first;
+        uint32_t object_count = node.object_count;
+        uint32_t left_idx = (uint32_t)m_nodes.size();
+
+        node.first = left_idx;
+        node.object_count = 0;
+        m_nodes.push_back({ {}, first, {}, left_count });
+        m_nodes.push_back({ {}, first + left_count, {}, object_count - left_count });
+        m_subtree_refs.push_back({ first, left_count });
+        m_subtree_refs.push_back({ first + left_count, object_count - left_count });
+        update_node_bounds(m_nodes[left_idx]);
+        update_node_bounds(m_nodes[left_idx + 1]);
+
+        build_stack.push_back({ left_idx + 1, entry.depth + 1 });
+        build_stack.push_back({ left_idx, entry.depth + 1 });
+    }
+
+    m_nodes.shrink_to_fit();
+    m_subtree_refs.shrink_to_fit();
+    m_stats.node_count = (uint32_t)m_nodes.size();
+    m_stats.memory_size = m_nodes.size() * (sizeof(BVH_Node) + sizeof(BVH_RefRange)) + m_object_refs.size() * sizeof(uint32_t);
+    m_stats.build_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    fprintf(stdout, "INFO | BVH > Built %u objects; %u nodes (%u leaves, depth %u), %.2f MB in %.2fms\n",
+        object_count, m_stats.node_count, m_stats.leaf_count, m_stats.max_depth,
+        m_stats.memory_size / (1024.0 * 1024.0), m_stats.build_ms);
+}
+
+
+void BVH::set_bounds(uint32_t object_index, const float bounds_min[3], const float bounds_max[3])
+{
+    float* object_bounds = &m_object_bounds[object_index * 6];
+    for (uint32_t axis = 0; axis < 3; axis++)
+    {
+        object_bounds[axis] = bounds_min[axis];
+        object_bounds[3 + axis] = bounds_max[axis];
+    }
+}
+
+
+void BVH::refit()
+{
+    // Children are always stored after their parent, so a reverse sweep visits them first
+    for (size_t node_idx = m_nodes.size(); node_idx-- > 0;)
+    {
+        BVH_Node& node = m_nodes[node_idx];
+        if (node.object_count)
+        {
+            update_node_bounds(node);
+            continue;
+        }
+
+        const BVH_Node& left = m_nodes[node.first];
+        const BVH_Node& right = m_nodes[node.first + 1];
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            node.bounds_min[axis] = std::min(left.bounds_min[axis], right.bounds_min[axis]);
+            node.bounds_max[axis] = std::max(left.bounds_max[axis], right.bounds_max[axis]);
+        }
+    }
+}
+
+
+uint32_t BVH::cull(const Frustum& frustum, std::vector<uint32_t>& visible) const
+{
+    visible.clear();
+    if (m_nodes.empty() || m_object_refs.empty())
+        return 0;
+
+    /**
+     * Each stack entry carries the planes its parent wasn't already fully inside of; once a node is inside
+     * every plane its whole subtree is visible and is emitted as one range copy, without visiting it. Every
+     * pop pushes at most two children, so the stack never holds more than `max_depth + 1` entries.
+     */
+    struct CullEntry { uint32_t node_idx, plane_mask; };
+    CullEntry local_stack[BVH_STACK_SIZE];
+    std::vector<CullEntry> heap_stack;
+    CullEntry* cull_stack = local_stack;
+    if (m_stats.max_depth + 1 > BVH_STACK_SIZE)
+    {
+        heap_stack.resize(m_stats.max_depth + 1);
+        cull_stack = heap_stack.data();
+    }
+    uint32_t stack_size = 0;
+    cull_stack[stack_size++] = { 0, 0x3f };
+
+    while (stack_size)
+    {
+        CullEntry entry = cull_stack[--stack_size];
+        const BVH_Node& node = m_nodes[entry.node_idx];
+
+        uint32_t plane_mask = entry.plane_mask;
+        if (!intersects_planes(frustum, node.bounds_min, node.bounds_max, plane_mask))
+            continue;
+
+        if (!plane_mask)
+        {
+            const BVH_RefRange& refs = m_subtree_refs[entry.node_idx];
+            visible.insert(visible.end(), m_object_refs.begin() + refs.first, m_object_refs.begin() + refs.first + refs.count);
+            continue;
+        }
+
+        if (node.object_count)
+        {
+            // Objects in a partially visible leaf are tested against the planes the leaf straddles
+            for (uint32_t ref_idx = node.first; ref_idx < node.first + node.object_count; ref_idx++)
+            {
+                const float* object_bounds = &m_object_bounds[m_object_refs[ref_idx] * 6];
+                uint32_t object_plane_mask = plane_mask;
+                if (intersects_planes(frustum, object_bounds, object_bounds + 3, object_plane_mask))
+                    visible.push_back(m_object_refs[ref_idx]);
+            }
+            continue;
+        }
+
+        cull_stack[stack_size++] = { node.first + 1, plane_mask };
+        cull_stack[stack_size++] = { node.first, plane_mask };
+    }
+
+    return (uint32_t)visible.size();
+}
+
+
+bool BVH::raycast(const float origin[3], const float direction[3], float max_distance, BVH_RayHit& hit) const
+{
+    if (m_nodes.empty() || m_object_refs.empty())
+        return false;
+
+    float inverse_direction[3];
+    for (uint32_t axis = 0; axis < 3; axis++)
+        inverse_direction[axis] = 1.0f / direction[axis];
+
+    // Slab test; returns the entry distance, or INFINITY on a miss
+    auto intersect = [&origin, &inverse_direction](const float bounds_min[3], const float bounds_max[3], float closest) {
+        float t_near = 0.0f, t_far = closest;
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            float t0 = (bounds_min[axis] - origin[axis]) * inverse_direction[axis];
+            float t1 = (bounds_max[axis] - origin[axis]) * inverse_direction[axis];
+            t_near = std::max(t_near, std::min(t0, t1));
+            t_far = std::min(t_far, std::max(t0, t1));
+        }
+        return t_near <= t_far ? t_near : INFINITY;
+    };
+
+    hit = { UINT32_MAX, max_distance };
+    uint32_t local_stack[BVH_STACK_SIZE];
+    std::vector<uint32_t> heap_stack;
+    uint32_t* ray_stack = local_stack;
+    if (m_stats.max_depth + 1 > BVH_STACK_SIZE)
+    {
+        heap_stack.resize(m_stats.max_depth + 1);
+        ray_stack = heap_stack.data();
+    }
+    uint32_t stack_size = 0;
+    if (intersect(m_nodes[0].bounds_min, m_nodes[0].bounds_max, hit.distance) != INFINITY)
+        ray_stack[stack_size++] = 0;
+
+    while (stack_size)
+    {
+        const BVH_Node& node = m_nodes[ray_stack[--stack_size]];
+        if (node.object_count)
+        {
+            for (uint32_t ref_idx = node.first; ref_idx < node.first + node.object_count; ref_idx++)
+            {
+                const float* object_bounds = &m_object_bounds[m_object_refs[ref_idx] * 6];
+                float distance = intersect(object_bounds, object_bounds + 3, hit.distance);
+                if (distance < hit.distance)
+                    hit = { m_object_refs[ref_idx], distance };
+            }
+            continue;
+        }
+
+        // Visit the nearer child first so the hit distance shrinks early
+        float left_distance = intersect(m_nodes[node.first].bounds_min, m_nodes[node.first].bounds_max, hit.distance);
+        float right_distance = intersect(m_nodes[node.first + 1].bounds_min, m_nodes[node.first + 1].bounds_max, hit.distance);
+        uint32_t near_idx = node.first, far_idx = node.first + 1;
+        if (right_distance < left_distance)
+        {
+            std::swap(left_distance, right_distance);
+            std::swap(near_idx, far_idx);
+        }
+
+        if (right_distance != INFINITY)
+            ray_stack[stack_size++] = far_idx;
+        if (left_distance != INFINITY)
+            ray_stack[stack_size++] = near_idx;
+    }
+
+    return hit.object_index != UINT32_MAX;
+}
@@ -0,0 +1,104 @@
+#include "command_list.h"
+#include <algorithm>
+#include <cstring>
+#include "renderer.h"
+
+
+static const uint32_t COMMAND_ALIGNMENT = sizeof(uint64_t);
+
+
+CommandList::CommandList() :
+    m_size(0), m_command_count(0)
+{
+}
+
+
+void CommandList::reset()
+{
+    m_size = 0;
+    m_command_count = 0;
+}
+
+
+void CommandList::reserve(uint32_t byte_count)
+{
+    m_data.reserve((byte_count + COMMAND_ALIGNMENT - 1) / COMMAND_ALIGNMENT);
+}
+
+
+void* CommandList::allocate(GL_CommandType type, uint32_t command_size)
+{
+    uint32_t aligned_size = (command_size + COMMAND_ALIGNMENT - 1) / COMMAND_ALIGNMENT * COMMAND_ALIGNMENT;
+    if (m_size + aligned_size > m_data.size() * COMMAND_ALIGNMENT)
+        m_data.resize(std::max<size_t>(m_data.size() * 2, (m_size + aligned_size) / COMMAND_ALIGNMENT));
+
+    GL_CommandHeader* header = (GL_CommandHeader*)((uint8_t*)m_data.data() + m_size);
+    header->type = type;
+    header->size = (uint16_t)aligned_size;
+    m_size += aligned_size;
+    m_command_count++;
+    return header;
+}
+
+
+void CommandList::bind_program(GL_ShaderProgram* shader_program)
+{
+    GL_CmdBindProgram* command = (GL_CmdBindProgram*)allocate(GL_CommandType::BIND_PROGRAM, sizeof(GL_CmdBindProgram));
+    command->shader_program = shader_program;
+}
+
+
+void CommandList::bind_vertex_format(const GL_VertexFormat* vertex_format, uint32_t vertex_buffer_id, uint32_t index_buffer_id)
+{
+    GL_CmdBindVertexFormat* command = (GL_CmdBindVertexFormat*)allocate(GL_CommandType::BIND_VERTEX_FORMAT, sizeof(GL_CmdBindVertexFormat));
+    command->vertex_buffer_id = vertex_buffer_id;
+    command->index_buffer_id = index_buffer_id;
+    command->vertex_format = vertex_format;
+}
+
+
+void CommandList::bind_uniform_range(uint32_t binding_index, uint32_t buffer_id, uint32_t offset, uint32_t size)
+{
+    GL_CmdBindUniformRange* command = (GL_CmdBindUniformRange*)allocate(GL_CommandType::BIND_UNIFORM_RANGE, sizeof(GL_CmdBindUniformRange));
+    command->binding_index = binding_index;
+    command->buffer_id = buffer_id;
+    command->offset = offset;
+    command->size = size;
+}
+
+
+void CommandList::bind_texture(uint32_t texture_unit, uint32_t texture_id)
+{
+    GL_CmdBindTexture* command = (GL_CmdBindTexture*)allocate(GL_CommandType::BIND_TEXTURE, sizeof(GL_CmdBindTexture));
+    command->texture_unit = texture_unit;
+    command->texture_id = texture_id;
+}
+
+
+void CommandList::set_uniform_mat4(uint32_t name_id, const float* matrix)
+{
+    GL_CmdSetUniformMat4* command = (GL_CmdSetUniformMat4*)allocate(GL_CommandType::SET_UNIFORM_MAT4, sizeof(GL_CmdSetUniformMat4));
+    command->name_id = name_id;
+    memcpy(command->matrix, matrix, sizeof(command->matrix));
+}
+
+
+void CommandList::draw_indexed(uint32_t gl_index_type, uint32_t index_count, uint32_t first_index, int32_t base_vertex,
+    uint32_t instance_count, uint32_t base_instance)
+{
+    GL_CmdDrawIndexed* command = (GL_CmdDrawIndexed*)allocate(GL_CommandType::DRAW_INDEXED, sizeof(GL_CmdDrawIndexed));
+    command->gl_index_type = gl_index_type;
+    command->index_count = index_count;
+    command->first_index = first_index;
+    command->base_vertex = base_vertex;
+    command->instance_count = instance_count;
+    command->base_instance = base_instance;
+}
+
+
+void CommandList::draw_mesh(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool, GL_MeshHandle mesh_handle)
+{
+    const GL_MeshRange& mesh_range = mesh_pool->get_range(mesh_handle);
+    bind_vertex_format(vertex_format, mesh_pool->get_vertex_buffer_id(), mesh_pool->get_index_buffer_id());
+    draw_indexed(GL_UNSIGNED_INT, mesh_range.index_count, mesh_range.first_index, (int32_t)mesh_range.base_vertex);
+}
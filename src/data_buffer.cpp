@@ -1,6 +1,18 @@
 #include "data_buffer.h"
 #include "renderer.h"
 #include <cstdio>
+#include "gl_utils.h"
+#include "profiler.h"
+
+
+/**
+ * NOTE: element buffer uploads go through GL_COPY_WRITE_BUFFER (as in GL_IndexBuffer), since binding
+ * GL_ELEMENT_ARRAY_BUFFER would change the element buffer of whichever VAO the renderer left bound
+ */
+static inline uint32_t get_upload_target(uint32_t gl_buffer_type)
+{
+    return gl_buffer_type == GL_ELEMENT_ARRAY_BUFFER ? GL_COPY_WRITE_BUFFER : gl_buffer_type;
+}
 
 
 template<typename T>
@@ -37,6 +49,12 @@ void GL_DataBuffer<T>::set_data(uint32_t gl_buffer_type, uint32_t data_count, co
          */
     case GL_ARRAY_BUFFER:
     case GL_ELEMENT_ARRAY_BUFFER:
+    case GL_UNIFORM_BUFFER:
+    case GL_SHADER_STORAGE_BUFFER:
+    case GL_ATOMIC_COUNTER_BUFFER:
+    case GL_DRAW_INDIRECT_BUFFER:
+    case GL_DISPATCH_INDIRECT_BUFFER:
+    case GL_PARAMETER_BUFFER_ARB:
         break;
 
     default:
@@ -54,8 +72,31 @@ void GL_DataBuffer<T>::set_data(uint32_t gl_buffer_type, uint32_t data_count, co
     m_data_size = (uint32_t)sizeof(T);
     m_buffer_size = m_data_count * m_data_size;
 
-    GL_CALL(glBindBuffer(m_gl_buffer_type, m_gl_id));
-    GL_CALL(glBufferData(m_gl_buffer_type, m_buffer_size, buffer_data, gl_buffer_usage));
+    uint32_t gl_upload_target = get_upload_target(m_gl_buffer_type);
+    GL_CALL(glBindBuffer(gl_upload_target, m_gl_id));
+    GL_CALL(glBufferData(gl_upload_target, m_buffer_size, buffer_data, gl_buffer_usage));
+    if (gl_upload_target == GL_COPY_WRITE_BUFFER)
+    {
+        GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    }
+    if (buffer_data)
+        Profiler::get().count_upload(m_buffer_size);
+}
+
+
+template<typename T>
+void GL_DataBuffer<T>::update_data(uint32_t first, uint32_t data_count, const T* buffer_data)
+{
+    ASSERT(first + data_count <= m_data_count);
+
+    uint32_t gl_upload_target = get_upload_target(m_gl_buffer_type);
+    GL_CALL(glBindBuffer(gl_upload_target, m_gl_id));
+    GL_CALL(glBufferSubData(gl_upload_target, (GLintptr)first * m_data_size, (GLsizeiptr)data_count * m_data_size, buffer_data));
+    if (gl_upload_target == GL_COPY_WRITE_BUFFER)
+    {
+        GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    }
+    Profiler::get().count_upload((uint64_t)data_count * m_data_size);
 }
 
 
@@ -66,6 +107,14 @@ void GL_DataBuffer<T>::bind() const
 }
 
 
+template<typename T>
+void GL_DataBuffer<T>::bind_base(uint32_t gl_buffer_type, uint32_t binding_index) const
+{
+    // Indexed targets (GL_UNIFORM_BUFFER, GL_SHADER_STORAGE_BUFFER, GL_ATOMIC_COUNTER_BUFFER)
+    GL_CALL(glBindBufferBase(gl_buffer_type, binding_index, m_gl_id));
+}
+
+
 template<typename T>
 void GL_DataBuffer<T>::unbind() const
 {
@@ -81,4 +130,7 @@ template class GL_DataBuffer<int32_t>;
 template class GL_DataBuffer<uint32_t>;
 template class GL_DataBuffer<float>;
 template class GL_DataBuffer<double>;
+template class GL_DataBuffer<GL_Half>;
+template class GL_DataBuffer<GL_Packed_2_10_10_10>;
+template class GL_DataBuffer<GL_DrawElementsIndirectCommand>;
 template class GL_DataBuffer<int32_t>;
@@ -1,10 +1,28 @@
 #include "file_utils.h"
+#include <cstdio>
 #include <sstream>
 #include <fstream>
+#include <utility>
+#include "profiler.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 
 std::string read_file(const std::string& file_path)
 {
+    PROFILE_ZONE("read_file");
+
     std::fstream file_stream(file_path);
     std::string line;
     std::stringstream string_stream;
@@ -16,3 +34,139 @@ std::string read_file(const std::string& file_path)
 
     return string_stream.str();
 }
+
+
+MappedFile::MappedFile() :
+    m_data(nullptr), m_size(0), m_open(false),
+#if defined(_WIN32)
+    m_file_handle(INVALID_HANDLE_VALUE), m_mapping_handle(nullptr)
+#else
+    m_file_descriptor(-1)
+#endif
+{
+}
+
+
+MappedFile::MappedFile(const std::string& file_path) :
+    MappedFile()
+{
+    open(file_path);
+}
+
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+
+MappedFile::MappedFile(MappedFile&& other) noexcept :
+    MappedFile()
+{
+    *this = std::move(other);
+}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_open, other.m_open);
+#if defined(_WIN32)
+        std::swap(m_file_handle, other.m_file_handle);
+        std::swap(m_mapping_handle, other.m_mapping_handle);
+#else
+        std::swap(m_file_descriptor, other.m_file_descriptor);
+#endif
+    }
+
+    return *this;
+}
+
+
+bool MappedFile::open(const std::string& file_path)
+{
+    close();
+
+#if defined(_WIN32)
+    m_file_handle = CreateFileA(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file_handle == INVALID_HANDLE_VALUE)
+    {
+        fprintf(stderr, "ERROR | Failed to open file: %s\n", file_path.c_str());
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(m_file_handle, &file_size);
+    m_size = (size_t)file_size.QuadPart;
+    m_open = true;
+    if (!m_size)
+        return true;
+
+    m_mapping_handle = CreateFileMappingA(m_file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping_handle)
+        m_data = (const uint8_t*)MapViewOfFile(m_mapping_handle, FILE_MAP_READ, 0, 0, 0);
+#else
+    m_file_descriptor = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_file_descriptor < 0)
+    {
+        fprintf(stderr, "ERROR | Failed to open file: %s\n", file_path.c_str());
+        return false;
+    }
+
+    struct stat file_stat;
+    fstat(m_file_descriptor, &file_stat);
+    m_size = (size_t)file_stat.st_size;
+    m_open = true;
+    if (!m_size)
+        return true;
+
+    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file_descriptor, 0);
+    if (mapping != MAP_FAILED)
+    {
+        m_data = (const uint8_t*)mapping;
+        // Advice values are enumerators, not flags: each one needs its own call. Failing is only a lost hint
+        if (madvise(mapping, m_size, MADV_SEQUENTIAL) != 0)
+            fprintf(stdout, "WARN | madvise(MADV_SEQUENTIAL) failed for %s: %s\n", file_path.c_str(), strerror(errno));
+        if (madvise(mapping, m_size, MADV_WILLNEED) != 0)
+            fprintf(stdout, "WARN | madvise(MADV_WILLNEED) failed for %s: %s\n", file_path.c_str(), strerror(errno));
+    }
+#endif
+
+    if (!m_data)
+    {
+        fprintf(stderr, "ERROR | Failed to map file: %s\n", file_path.c_str());
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+
+void MappedFile::close()
+{
+#if defined(_WIN32)
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping_handle)
+        CloseHandle(m_mapping_handle);
+    if (m_file_handle != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file_handle);
+    m_mapping_handle = nullptr;
+    m_file_handle = INVALID_HANDLE_VALUE;
+#else
+    if (m_data)
+        munmap((void*)m_data, m_size);
+    if (m_file_descriptor >= 0)
+        ::close(m_file_descriptor);
+    m_file_descriptor = -1;
+#endif
+
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
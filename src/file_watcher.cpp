@@ -0,0 +1,170 @@
+#include "file_watcher.h"
+#include <cstdio>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+
+static const std::chrono::milliseconds WATCH_POLL_INTERVAL(100);
+
+
+FileWatcher::FileWatcher() :
+    m_last_poll_time(std::chrono::steady_clock::now()), m_inotify_fd(-1)
+{
+#if defined(__linux__)
+    m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotify_fd < 0)
+    {
+        fprintf(stdout, "WARN | FileWatcher > inotify unavailable, falling back to polling\n");
+    }
+#endif
+}
+
+
+FileWatcher::~FileWatcher()
+{
+#if defined(__linux__)
+    if (m_inotify_fd >= 0)
+        close(m_inotify_fd);
+#endif
+}
+
+
+std::string FileWatcher::normalize_path(const std::string& file_path)
+{
+    std::error_code error;
+    std::filesystem::path absolute_path = std::filesystem::absolute(file_path, error);
+    if (error)
+        return file_path;
+
+    return absolute_path.lexically_normal().string();
+}
+
+
+void FileWatcher::watch(const std::string& file_path)
+{
+    std::string normalized_path = normalize_path(file_path);
+
+    std::error_code error;
+    std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(normalized_path, error);
+    if (m_watched.find(normalized_path) != m_watched.end())
+        return;
+    m_watched[normalized_path] = { file_path, last_write_time };
+
+#if defined(__linux__)
+    if (m_inotify_fd >= 0)
+    {
+        std::string directory = std::filesystem::path(normalized_path).parent_path().string();
+        auto it = m_watch_directories.find(directory);
+        if (it != m_watch_directories.end())
+        {
+            it->second.file_count++;
+            return;
+        }
+
+        int32_t watch_descriptor = inotify_add_watch(m_inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+        if (watch_descriptor < 0)
+        {
+            fprintf(stderr, "ERROR | FileWatcher > Failed to watch directory: %s\n", directory.c_str());
+            return;
+        }
+        m_watch_directories[directory] = { watch_descriptor, 1 };
+        m_watch_descriptors[watch_descriptor] = directory;
+    }
+#endif
+}
+
+
+void FileWatcher::unwatch(const std::string& file_path)
+{
+    std::string normalized_path = normalize_path(file_path);
+    if (!m_watched.erase(normalized_path))
+        return;
+    m_changed.erase(normalized_path);
+
+#if defined(__linux__)
+    // Drop the directory watch with the last file that needed it
+    auto it = m_watch_directories.find(std::filesystem::path(normalized_path).parent_path().string());
+    if (it == m_watch_directories.end() || --it->second.file_count)
+        return;
+
+    inotify_rm_watch(m_inotify_fd, it->second.watch_descriptor);
+    m_watch_descriptors.erase(it->second.watch_descriptor);
+    m_watch_directories.erase(it);
+#endif
+}
+
+
+void FileWatcher::poll_changes(std::vector<std::string>& changed_paths)
+{
+    // Timestamps are only compared without inotify, and then at most once per interval
+    if (!read_notifications())
+    {
+        std::chrono::steady_clock::time_point poll_time = std::chrono::steady_clock::now();
+        if (poll_time - m_last_poll_time >= WATCH_POLL_INTERVAL)
+        {
+            m_last_poll_time = poll_time;
+            poll_timestamps();
+        }
+    }
+
+    for (const std::string& normalized_path : m_changed)
+    {
+        auto it = m_watched.find(normalized_path);
+        if (it != m_watched.end())
+            changed_paths.push_back(it->second.file_path);
+    }
+    m_changed.clear();
+}
+
+
+bool FileWatcher::read_notifications()
+{
+#if defined(__linux__)
+    if (m_inotify_fd < 0)
+        return false;
+
+    // The descriptor is non-blocking: reading stops once the queued events are drained
+    alignas(inotify_event) char event_buffer[4096];
+    ssize_t read_size;
+    while ((read_size = read(m_inotify_fd, event_buffer, sizeof(event_buffer))) > 0)
+    {
+        for (char* event_ptr = event_buffer; event_ptr < event_buffer + read_size;)
+        {
+            const inotify_event* event = (const inotify_event*)event_ptr;
+            event_ptr += sizeof(inotify_event) + event->len;
+            if (!event->len)
+                continue;
+
+            auto it = m_watch_descriptors.find(event->wd);
+            if (it == m_watch_descriptors.end())
+                continue;
+
+            std::string normalized_path = (std::filesystem::path(it->second) / event->name).string();
+            if (m_watched.find(normalized_path) != m_watched.end())
+                m_changed.insert(normalized_path);
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void FileWatcher::poll_timestamps()
+{
+    for (auto& [normalized_path, entry] : m_watched)
+    {
+        std::error_code error;
+        std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(normalized_path, error);
+        if (error || last_write_time == entry.last_write_time)
+            continue;
+
+        entry.last_write_time = last_write_time;
+        m_changed.insert(normalized_path);
+    }
+}
@@ -0,0 +1,110 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include "job_system.h"
+#include "renderer.h"
+
+
+static size_t align_up(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+
+FrameArena::FrameArena(size_t capacity) :
+    m_block(new uint8_t[capacity]), m_capacity(capacity), m_offset(0), m_overflow_size(0)
+{
+}
+
+
+void* FrameArena::allocate(size_t size, size_t alignment)
+{
+    // Align the address rather than the offset; the block itself is only max_align_t aligned
+    uintptr_t base = (uintptr_t)m_block.get();
+    size_t offset = align_up(base + m_offset, alignment) - base;
+    if (offset + size <= m_capacity)
+    {
+        m_offset = offset + size;
+        return m_block.get() + offset;
+    }
+
+    std::unique_ptr<uint8_t[]>& overflow_block = m_overflow_blocks.emplace_back(new uint8_t[size + alignment]);
+    m_overflow_size += size + alignment;
+    return (void*)align_up((uintptr_t)overflow_block.get(), alignment);
+}
+
+
+void FrameArena::reset()
+{
+    if (!m_overflow_blocks.empty())
+    {
+        m_capacity = std::max(m_capacity * 2, m_offset + m_overflow_size);
+        m_block.reset(new uint8_t[m_capacity]);
+        m_overflow_blocks.clear();
+        m_overflow_size = 0;
+    }
+    m_offset = 0;
+}
+
+
+FrameArenaResource::FrameArenaResource(FrameArena* arena) :
+    m_arena(arena)
+{
+}
+
+
+void* FrameArenaResource::do_allocate(size_t size, size_t alignment)
+{
+    return m_arena->allocate(size, alignment);
+}
+
+
+void FrameArenaResource::do_deallocate(void*, size_t, size_t)
+{
+}
+
+
+bool FrameArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+
+FrameAllocator::WorkerArena::WorkerArena() :
+    arena(FRAME_ARENA_INITIAL_CAPACITY), resource(&arena)
+{
+}
+
+
+FrameAllocator::FrameAllocator() :
+    m_frame_idx(0)
+{
+    uint32_t worker_count = JobSystem::get().get_worker_count();
+    for (std::vector<std::unique_ptr<WorkerArena>>& worker_arenas : m_worker_arenas)
+    {
+        for (uint32_t worker_idx = 0; worker_idx < worker_count; worker_idx++)
+            worker_arenas.push_back(std::make_unique<WorkerArena>());
+    }
+}
+
+
+FrameAllocator& FrameAllocator::get()
+{
+    static FrameAllocator frame_allocator;
+    return frame_allocator;
+}
+
+
+void FrameAllocator::begin_frame()
+{
+    m_frame_idx = (m_frame_idx + 1) % FRAME_ARENA_BUFFER_COUNT;
+    for (std::unique_ptr<WorkerArena>& worker_arena : m_worker_arenas[m_frame_idx])
+        worker_arena->arena.reset();
+}
+
+
+FrameAllocator::WorkerArena& FrameAllocator::get_worker_arena()
+{
+    uint32_t worker_idx = JobSystem::get_worker_index();
+    ASSERT(worker_idx < m_worker_arenas[m_frame_idx].size());
+    return *m_worker_arenas[m_frame_idx][worker_idx];
+}
@@ -0,0 +1,48 @@
+#include "frame_clock.h"
+#include <algorithm>
+
+
+static const double SMOOTHING_FACTOR = 0.1;
+
+
+FrameClock::FrameClock(double fixed_delta_time, double max_delta_time) :
+    m_start_time(Clock::now()), m_last_tick(m_start_time), m_time(0.0), m_delta_time(0.0), m_smoothed_delta_time(fixed_delta_time),
+    m_max_delta_time(max_delta_time), m_fixed_delta_time(fixed_delta_time), m_accumulator(0.0), m_frame_index(0), m_step_index(0)
+{
+}
+
+
+void FrameClock::tick()
+{
+    Clock::time_point now = Clock::now();
+    m_delta_time = std::min(std::chrono::duration<double>(now - m_last_tick).count(), m_max_delta_time);
+    m_last_tick = now;
+    m_time = std::chrono::duration<double>(now - m_start_time).count();
+
+    m_smoothed_delta_time += (m_delta_time - m_smoothed_delta_time) * SMOOTHING_FACTOR;
+    m_accumulator += m_delta_time;
+    m_frame_index++;
+}
+
+
+bool FrameClock::step()
+{
+    if (m_accumulator < m_fixed_delta_time)
+        return false;
+
+    m_accumulator -= m_fixed_delta_time;
+    m_step_index++;
+    return true;
+}
+
+
+GL_FrameTimeBlock FrameClock::get_time_block() const
+{
+    GL_FrameTimeBlock time_block = {};
+    time_block.time = (float)m_time;
+    time_block.delta_time = (float)m_delta_time;
+    time_block.smoothed_delta_time = (float)m_smoothed_delta_time;
+    time_block.alpha = get_alpha();
+    time_block.frame_index = (uint32_t)m_frame_index;
+    return time_block;
+}
@@ -0,0 +1,340 @@
+#include "framebuffer.h"
+#include <algorithm>
+#include <cstdio>
+
+
+// Idle targets are kept this many frames for reuse before being deleted
+static const uint64_t RENDER_TARGET_MAX_IDLE_FRAMES = 3;
+
+
+uint64_t GL_RenderTarget::s_next_serial = 1;
+
+
+GL_RenderTarget::GL_RenderTarget(const GL_RenderTargetDesc& desc) :
+    m_gl_id(0), m_serial(s_next_serial++), m_desc(desc)
+{
+    ASSERT(desc.width && desc.height && desc.samples);
+
+    if (!desc.sampled)
+    {
+        GL_CALL(glGenRenderbuffers(1, &m_gl_id));
+        GL_CALL(glBindRenderbuffer(GL_RENDERBUFFER, m_gl_id));
+        if (desc.samples > 1)
+        {
+            GL_CALL(glRenderbufferStorageMultisample(GL_RENDERBUFFER, desc.samples, desc.gl_internal_format, desc.width, desc.height));
+        }
+        else
+        {
+            GL_CALL(glRenderbufferStorage(GL_RENDERBUFFER, desc.gl_internal_format, desc.width, desc.height));
+        }
+        return;
+    }
+
+    // Textures stay bound to their units between frames, so the caller's binding is restored
+    uint32_t gl_target = get_gl_target();
+    int32_t bound_texture = 0;
+    GL_CALL(glGetIntegerv(gl_target == GL_TEXTURE_2D ? GL_TEXTURE_BINDING_2D : GL_TEXTURE_BINDING_2D_MULTISAMPLE, &bound_texture));
+    GL_CALL(glGenTextures(1, &m_gl_id));
+    GL_CALL(glBindTexture(gl_target, m_gl_id));
+    if (desc.samples > 1)
+    {
+        GL_CALL(glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, desc.samples, desc.gl_internal_format, desc.width, desc.height, GL_TRUE));
+    }
+    else
+    {
+        // Depth/stencil formats can't be filtered
+        int32_t gl_filter = get_gl_attachment() == GL_COLOR_ATTACHMENT0 ? GL_LINEAR : GL_NEAREST;
+        GL_CALL(glTexStorage2D(GL_TEXTURE_2D, 1, desc.gl_internal_format, desc.width, desc.height));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, gl_filter));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, gl_filter));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    }
+    GL_CALL(glBindTexture(gl_target, (uint32_t)bound_texture));
+}
+
+
+GL_RenderTarget::~GL_RenderTarget()
+{
+    if (m_desc.sampled)
+    {
+        GL_CALL(glDeleteTextures(1, &m_gl_id));
+    }
+    else
+    {
+        GL_CALL(glDeleteRenderbuffers(1, &m_gl_id));
+    }
+}
+
+
+void GL_RenderTarget::gl_bind(uint32_t gl_texture_slot) const
+{
+    ASSERT(m_desc.sampled);
+
+    GL_CALL(glActiveTexture(GL_TEXTURE0 + gl_texture_slot));
+    GL_CALL(glBindTexture(get_gl_target(), m_gl_id));
+}
+
+
+uint32_t GL_RenderTarget::get_gl_attachment(uint32_t color_idx) const
+{
+    switch (m_desc.gl_internal_format)
+    {
+    case GL_DEPTH_COMPONENT16:
+    case GL_DEPTH_COMPONENT24:
+    case GL_DEPTH_COMPONENT32:
+    case GL_DEPTH_COMPONENT32F:
+        return GL_DEPTH_ATTACHMENT;
+    case GL_DEPTH24_STENCIL8:
+    case GL_DEPTH32F_STENCIL8:
+        return GL_DEPTH_STENCIL_ATTACHMENT;
+    case GL_STENCIL_INDEX8:
+        return GL_STENCIL_ATTACHMENT;
+    }
+    return GL_COLOR_ATTACHMENT0 + color_idx;
+}
+
+
+uint32_t GL_RenderTarget::get_gl_target() const
+{
+    if (!m_desc.sampled)
+        return GL_RENDERBUFFER;
+    return m_desc.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+}
+
+
+GL_Framebuffer::GL_Framebuffer() :
+    m_gl_id(0), m_color_targets(), m_depth_target(nullptr), m_attached_serials()
+{
+    GL_CALL(glGenFramebuffers(1, &m_gl_id));
+    ASSERT(m_gl_id);
+}
+
+
+GL_Framebuffer::~GL_Framebuffer()
+{
+    GL_CALL(glDeleteFramebuffers(1, &m_gl_id));
+}
+
+
+void GL_Framebuffer::set_color_target(uint32_t color_idx, const GL_RenderTarget* target)
+{
+    ASSERT(color_idx < GL_FRAMEBUFFER_MAX_COLOR_TARGETS);
+
+    // Only compared against the attached serials on the next bind; the previous target may already be deleted
+    m_color_targets[color_idx] = target;
+}
+
+
+void GL_Framebuffer::set_depth_target(const GL_RenderTarget* target)
+{
+    m_depth_target = target;
+}
+
+
+static void attach_target(uint32_t gl_attachment, const GL_RenderTarget* target)
+{
+    if (target && target->get_desc().sampled)
+    {
+        GL_CALL(glFramebufferTexture2D(GL_FRAMEBUFFER, gl_attachment, target->get_gl_target(), target->get_id(), 0));
+    }
+    else
+    {
+        GL_CALL(glFramebufferRenderbuffer(GL_FRAMEBUFFER, gl_attachment, GL_RENDERBUFFER, target ? target->get_id() : 0));
+    }
+}
+
+
+void GL_Framebuffer::update_attachments()
+{
+    uint64_t serials[GL_FRAMEBUFFER_MAX_COLOR_TARGETS + 1];
+    for (uint32_t color_idx = 0; color_idx < GL_FRAMEBUFFER_MAX_COLOR_TARGETS; color_idx++)
+        serials[color_idx] = m_color_targets[color_idx] ? m_color_targets[color_idx]->get_serial() : 0;
+    serials[GL_FRAMEBUFFER_MAX_COLOR_TARGETS] = m_depth_target ? m_depth_target->get_serial() : 0;
+    if (std::equal(serials, serials + GL_FRAMEBUFFER_MAX_COLOR_TARGETS + 1, m_attached_serials))
+        return;
+
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_gl_id));
+
+    uint32_t draw_buffers[GL_FRAMEBUFFER_MAX_COLOR_TARGETS];
+    for (uint32_t color_idx = 0; color_idx < GL_FRAMEBUFFER_MAX_COLOR_TARGETS; color_idx++)
+    {
+        attach_target(GL_COLOR_ATTACHMENT0 + color_idx, m_color_targets[color_idx]);
+        draw_buffers[color_idx] = m_color_targets[color_idx] ? GL_COLOR_ATTACHMENT0 + color_idx : GL_NONE;
+    }
+    GL_CALL(glDrawBuffers(GL_FRAMEBUFFER_MAX_COLOR_TARGETS, draw_buffers));
+    GL_CALL(glReadBuffer(draw_buffers[0]));
+
+    // Clearing the combined point detaches both, so a depth-only target never leaves a stale stencil behind
+    attach_target(GL_DEPTH_STENCIL_ATTACHMENT, nullptr);
+    if (m_depth_target)
+        attach_target(m_depth_target->get_gl_attachment(), m_depth_target);
+
+    uint32_t status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        fprintf(stderr, "ERROR | Framebuffer > Framebuffer %u is incomplete (status 0x%04X)\n", m_gl_id, status);
+        ASSERT(0);
+    }
+    std::copy(serials, serials + GL_FRAMEBUFFER_MAX_COLOR_TARGETS + 1, m_attached_serials);
+}
+
+
+const GL_RenderTarget* GL_Framebuffer::get_any_target() const
+{
+    for (const GL_RenderTarget* target : m_color_targets)
+    {
+        if (target)
+            return target;
+    }
+    return m_depth_target;
+}
+
+
+uint32_t GL_Framebuffer::get_width() const
+{
+    const GL_RenderTarget* target = get_any_target();
+    return target ? target->get_width() : 0;
+}
+
+
+uint32_t GL_Framebuffer::get_height() const
+{
+    const GL_RenderTarget* target = get_any_target();
+    return target ? target->get_height() : 0;
+}
+
+
+void GL_Framebuffer::bind()
+{
+    update_attachments();
+
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, m_gl_id));
+    GL_CALL(glViewport(0, 0, get_width(), get_height()));
+}
+
+
+void GL_Framebuffer::bind_default(uint32_t width, uint32_t height)
+{
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    GL_CALL(glViewport(0, 0, width, height));
+}
+
+
+void GL_Framebuffer::blit(uint32_t target_gl_id, uint32_t target_width, uint32_t target_height, uint32_t gl_buffer_mask) const
+{
+    // Multisampled sources need equal sizes anyway; scaling only filters color
+    bool scaled = target_width != get_width() || target_height != get_height();
+    uint32_t gl_filter = scaled && gl_buffer_mask == GL_COLOR_BUFFER_BIT ? GL_LINEAR : GL_NEAREST;
+
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_gl_id));
+    GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, target_gl_id));
+    GL_CALL(glBlitFramebuffer(0, 0, get_width(), get_height(), 0, 0, target_width, target_height, gl_buffer_mask, gl_filter));
+}
+
+
+void GL_Framebuffer::resolve(GL_Framebuffer& target, uint32_t gl_buffer_mask)
+{
+    // Color comes from color target 0 and goes to every color target of `target`
+    update_attachments();
+    target.update_attachments();
+    blit(target.m_gl_id, target.get_width(), target.get_height(), gl_buffer_mask);
+}
+
+
+void GL_Framebuffer::resolve_to_default(uint32_t gl_buffer_mask)
+{
+    update_attachments();
+    blit(0, get_width(), get_height(), gl_buffer_mask);
+}
+
+
+void GL_Framebuffer::invalidate(uint32_t gl_buffer_mask)
+{
+    update_attachments();
+
+    uint32_t attachments[GL_FRAMEBUFFER_MAX_COLOR_TARGETS + 1];
+    uint32_t attachment_count = 0;
+    if (gl_buffer_mask & GL_COLOR_BUFFER_BIT)
+    {
+        for (uint32_t color_idx = 0; color_idx < GL_FRAMEBUFFER_MAX_COLOR_TARGETS; color_idx++)
+        {
+            if (m_color_targets[color_idx])
+                attachments[attachment_count++] = GL_COLOR_ATTACHMENT0 + color_idx;
+        }
+    }
+    if (m_depth_target && (gl_buffer_mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT)))
+    {
+        // A combined target can drop just one of its aspects
+        uint32_t gl_attachment = m_depth_target->get_gl_attachment();
+        if (gl_attachment == GL_DEPTH_STENCIL_ATTACHMENT && !(gl_buffer_mask & GL_STENCIL_BUFFER_BIT))
+            gl_attachment = GL_DEPTH_ATTACHMENT;
+        else if (gl_attachment == GL_DEPTH_STENCIL_ATTACHMENT && !(gl_buffer_mask & GL_DEPTH_BUFFER_BIT))
+            gl_attachment = GL_STENCIL_ATTACHMENT;
+        attachments[attachment_count++] = gl_attachment;
+    }
+    if (!attachment_count)
+        return;
+
+    // Through the read binding, so whatever is bound for drawing stays bound
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_gl_id));
+    GL_CALL(glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, attachment_count, attachments));
+}
+
+
+void GL_Framebuffer::read_pixels(uint32_t color_idx, uint8_t* rgba)
+{
+    ASSERT(color_idx < GL_FRAMEBUFFER_MAX_COLOR_TARGETS && m_color_targets[color_idx] && m_color_targets[color_idx]->get_samples() == 1);
+    update_attachments();
+
+    const GL_RenderTarget* target = m_color_targets[color_idx];
+    GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_gl_id));
+    GL_CALL(glReadBuffer(GL_COLOR_ATTACHMENT0 + color_idx));
+    GL_CALL(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+    GL_CALL(glReadPixels(0, 0, target->get_width(), target->get_height(), GL_RGBA, GL_UNSIGNED_BYTE, rgba));
+
+    // Resolves read from color target 0
+    GL_CALL(glReadBuffer(m_color_targets[0] ? GL_COLOR_ATTACHMENT0 : GL_NONE));
+}
+
+
+GL_RenderTargetPool::GL_RenderTargetPool() :
+    m_frame_index(0)
+{
+}
+
+
+GL_RenderTarget* GL_RenderTargetPool::acquire(const GL_RenderTargetDesc& desc)
+{
+    for (Entry& entry : m_entries)
+    {
+        if (!entry.in_use && entry.target->get_desc() == desc)
+        {
+            entry.in_use = true;
+            entry.last_used_frame = m_frame_index;
+            return entry.target.get();
+        }
+    }
+
+    m_entries.push_back({ std::make_unique<GL_RenderTarget>(desc), true, m_frame_index });
+    return m_entries.back().target.get();
+}
+
+
+void GL_RenderTargetPool::release(const GL_RenderTarget* target)
+{
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [target](const Entry& entry) { return entry.target.get() == target; });
+    ASSERT(it != m_entries.end() && it->in_use);
+
+    it->in_use = false;
+    it->last_used_frame = m_frame_index;
+}
+
+
+void GL_RenderTargetPool::end_frame()
+{
+    m_frame_index++;
+    std::erase_if(m_entries, [this](const Entry& entry) {
+        return !entry.in_use && m_frame_index - entry.last_used_frame > RENDER_TARGET_MAX_IDLE_FRAMES;
+    });
+}
@@ -0,0 +1,267 @@
+#include "frustum_culling.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include "job_system.h"
+#include "simd_utils.h"
+
+
+static const uint32_t CULL_BATCH_SIZE = 8;
+static const uint32_t CULL_MIN_OBJECTS_PER_THREAD = 1 << 14;
+static const uint32_t CULL_MAX_RANGES = 64;
+
+
+Frustum Frustum::from_matrix(const float* view_projection)
+{
+    // Gribb-Hartmann; each plane is the 4th matrix row plus or minus one of the first three
+    auto row = [view_projection](uint32_t row_idx, uint32_t column_idx) { return view_projection[column_idx * 4 + row_idx]; };
+
+    Frustum frustum;
+    for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+    {
+        uint32_t row_idx = plane_idx / 2;
+        float sign = plane_idx % 2 ? -1.0f : 1.0f;
+        for (uint32_t column_idx = 0; column_idx < 4; column_idx++)
+            frustum.planes[plane_idx][column_idx] = row(3, column_idx) + sign * row(row_idx, column_idx);
+
+        float* plane = frustum.planes[plane_idx];
+        float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (uint32_t component = 0; component < 4; component++)
+                plane[component] /= length;
+        }
+    }
+
+    return frustum;
+}
+
+
+FrustumCuller::FrustumCuller() :
+    m_count(0)
+{
+}
+
+
+void FrustumCuller::reserve(uint32_t count)
+{
+    // Arrays are padded to whole batches, so the SIMD loop never loads past the end
+    size_t padded_count = (count + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE * CULL_BATCH_SIZE;
+    for (std::vector<float>* component : { &m_center_x, &m_center_y, &m_center_z, &m_extent_x, &m_extent_y, &m_extent_z, &m_radius })
+        component->reserve(padded_count);
+}
+
+
+void FrustumCuller::clear()
+{
+    for (std::vector<float>* component : { &m_center_x, &m_center_y, &m_center_z, &m_extent_x, &m_extent_y, &m_extent_z, &m_radius })
+        component->clear();
+    m_count = 0;
+}
+
+
+uint32_t FrustumCuller::add(const float center[3], const float extents[3])
+{
+    if (m_count % CULL_BATCH_SIZE == 0)
+    {
+        for (std::vector<float>* component : { &m_center_x, &m_center_y, &m_center_z, &m_extent_x, &m_extent_y, &m_extent_z, &m_radius })
+            component->resize(m_count + CULL_BATCH_SIZE, 0.0f);
+    }
+
+    set(m_count, center, extents);
+    return m_count++;
+}
+
+
+uint32_t FrustumCuller::add_sphere(const float center[3], float radius)
+{
+    const float extents[3] = { radius, radius, radius };
+    uint32_t index = add(center, extents);
+    m_radius[index] = radius;
+    return index;
+}
+
+
+void FrustumCuller::set(uint32_t index, const float center[3], const float extents[3])
+{
+    m_center_x[index] = center[0];
+    m_center_y[index] = center[1];
+    m_center_z[index] = center[2];
+    m_extent_x[index] = extents[0];
+    m_extent_y[index] = extents[1];
+    m_extent_z[index] = extents[2];
+    m_radius[index] = std::sqrt(extents[0] * extents[0] + extents[1] * extents[1] + extents[2] * extents[2]);
+}
+
+
+void FrustumCuller::set_sphere(uint32_t index, const float center[3], float radius)
+{
+    const float extents[3] = { radius, radius, radius };
+    set(index, center, extents);
+    m_radius[index] = radius;
+}
+
+
+uint32_t FrustumCuller::cull_range(const Frustum& frustum, uint32_t begin, uint32_t end, uint32_t* visible) const
+{
+    /**
+     * Per plane, an object is outside if `dot(n, center) + d < -r`, where r is the smaller of the
+     * sphere radius and the AABB's projected radius `dot(abs(n), extents)`
+     */
+    uint32_t visible_count = 0;
+    uint32_t idx = begin;
+
+#if defined(SIMD_AVX2)
+    __m256 plane_x[6], plane_y[6], plane_z[6], plane_d[6], abs_x[6], abs_y[6], abs_z[6];
+    for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+    {
+        const float* plane = frustum.planes[plane_idx];
+        plane_x[plane_idx] = _mm256_set1_ps(plane[0]);
+        plane_y[plane_idx] = _mm256_set1_ps(plane[1]);
+        plane_z[plane_idx] = _mm256_set1_ps(plane[2]);
+        plane_d[plane_idx] = _mm256_set1_ps(plane[3]);
+        abs_x[plane_idx] = _mm256_set1_ps(std::fabs(plane[0]));
+        abs_y[plane_idx] = _mm256_set1_ps(std::fabs(plane[1]));
+        abs_z[plane_idx] = _mm256_set1_ps(std::fabs(plane[2]));
+    }
+
+    for (; idx < end; idx += 8)
+    {
+        __m256 center_x = _mm256_loadu_ps(&m_center_x[idx]);
+        __m256 center_y = _mm256_loadu_ps(&m_center_y[idx]);
+        __m256 center_z = _mm256_loadu_ps(&m_center_z[idx]);
+        __m256 extent_x = _mm256_loadu_ps(&m_extent_x[idx]);
+        __m256 extent_y = _mm256_loadu_ps(&m_extent_y[idx]);
+        __m256 extent_z = _mm256_loadu_ps(&m_extent_z[idx]);
+        __m256 radius = _mm256_loadu_ps(&m_radius[idx]);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+        {
+            __m256 distance = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(plane_x[plane_idx], center_x), _mm256_mul_ps(plane_y[plane_idx], center_y)),
+                _mm256_add_ps(_mm256_mul_ps(plane_z[plane_idx], center_z), plane_d[plane_idx]));
+            __m256 box_radius = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(abs_x[plane_idx], extent_x), _mm256_mul_ps(abs_y[plane_idx], extent_y)),
+                _mm256_mul_ps(abs_z[plane_idx], extent_z));
+            __m256 effective_radius = _mm256_min_ps(box_radius, radius);
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(distance, effective_radius), _mm256_setzero_ps(), _CMP_LT_OQ));
+        }
+
+        // Compact the visible lanes, masking off lanes past the end of the range
+        uint32_t visible_mask = ~(uint32_t)_mm256_movemask_ps(outside) & 0xffu;
+        if (end - idx < 8)
+            visible_mask &= (1u << (end - idx)) - 1;
+        while (visible_mask)
+        {
+            visible[visible_count++] = idx + (uint32_t)std::countr_zero(visible_mask);
+            visible_mask &= visible_mask - 1;
+        }
+    }
+#elif defined(SIMD_SSE2)
+    __m128 plane_x[6], plane_y[6], plane_z[6], plane_d[6], abs_x[6], abs_y[6], abs_z[6];
+    for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+    {
+        const float* plane = frustum.planes[plane_idx];
+        plane_x[plane_idx] = _mm_set1_ps(plane[0]);
+        plane_y[plane_idx] = _mm_set1_ps(plane[1]);
+        plane_z[plane_idx] = _mm_set1_ps(plane[2]);
+        plane_d[plane_idx] = _mm_set1_ps(plane[3]);
+        abs_x[plane_idx] = _mm_set1_ps(std::fabs(plane[0]));
+        abs_y[plane_idx] = _mm_set1_ps(std::fabs(plane[1]));
+        abs_z[plane_idx] = _mm_set1_ps(std::fabs(plane[2]));
+    }
+
+    for (; idx < end; idx += 4)
+    {
+        __m128 center_x = _mm_loadu_ps(&m_center_x[idx]);
+        __m128 center_y = _mm_loadu_ps(&m_center_y[idx]);
+        __m128 center_z = _mm_loadu_ps(&m_center_z[idx]);
+        __m128 extent_x = _mm_loadu_ps(&m_extent_x[idx]);
+        __m128 extent_y = _mm_loadu_ps(&m_extent_y[idx]);
+        __m128 extent_z = _mm_loadu_ps(&m_extent_z[idx]);
+        __m128 radius = _mm_loadu_ps(&m_radius[idx]);
+
+        __m128 outside = _mm_setzero_ps();
+        for (uint32_t plane_idx = 0; plane_idx < 6; plane_idx++)
+        {
+            __m128 distance = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(plane_x[plane_idx], center_x), _mm_mul_ps(plane_y[plane_idx], center_y)),
+                _mm_add_ps(_mm_mul_ps(plane_z[plane_idx], center_z), plane_d[plane_idx]));
+            __m128 box_radius = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(abs_x[plane_idx], extent_x), _mm_mul_ps(abs_y[plane_idx], extent_y)),
+                _mm_mul_ps(abs_z[plane_idx], extent_z));
+            __m128 effective_radius = _mm_min_ps(box_radius, radius);
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, effective_radius), _mm_setzero_ps()));
+        }
+
+        // Compact the visible lanes, masking off lanes past the end of the range
+        uint32_t visible_mask = ~(uint32_t)_mm_movemask_ps(outside) & 0xfu;
+        if (end - idx < 4)
+            visible_mask &= (1u << (end - idx)) - 1;
+        while (visible_mask)
+        {
+            visible[visible_count++] = idx + (uint32_t)std::countr_zero(visible_mask);
+            visible_mask &= visible_mask - 1;
+        }
+    }
+#endif
+
+    for (; idx < end; idx++)
+    {
+        bool is_visible = true;
+        for (uint32_t plane_idx = 0; plane_idx < 6 && is_visible; plane_idx++)
+        {
+            const float* plane = frustum.planes[plane_idx];
+            float distance = plane[0] * m_center_x[idx] + plane[1] * m_center_y[idx] + plane[2] * m_center_z[idx] + plane[3];
+            float box_radius = std::fabs(plane[0]) * m_extent_x[idx] + std::fabs(plane[1]) * m_extent_y[idx] + std::fabs(plane[2]) * m_extent_z[idx];
+            is_visible = distance + std::min(box_radius, m_radius[idx]) >= 0.0f;
+        }
+        if (is_visible)
+            visible[visible_count++] = idx;
+    }
+
+    return visible_count;
+}
+
+
+uint32_t FrustumCuller::cull(const Frustum& frustum, std::vector<uint32_t>& visible, uint32_t thread_count) const
+{
+    visible.resize(m_count);
+
+    if (!thread_count)
+        thread_count = JobSystem::get().get_worker_count();
+    thread_count = std::clamp(m_count / CULL_MIN_OBJECTS_PER_THREAD, 1u, std::min(thread_count, CULL_MAX_RANGES));
+    if (thread_count == 1)
+    {
+        visible.resize(cull_range(frustum, 0, m_count, visible.data()));
+        return (uint32_t)visible.size();
+    }
+
+    /**
+     * Each job culls a batch-aligned range and writes its visible indices in place at the start of its
+     * range; the per-range results are then packed down in order
+     */
+    uint32_t range_size = (m_count / thread_count + CULL_BATCH_SIZE - 1) / CULL_BATCH_SIZE * CULL_BATCH_SIZE;
+    uint32_t range_counts[CULL_MAX_RANGES] = {};
+    JobSystem::get().parallel_for(thread_count, [&](size_t first_range, size_t last_range) {
+        for (size_t thread_idx = first_range; thread_idx < last_range; thread_idx++)
+        {
+            uint32_t begin = std::min(m_count, (uint32_t)thread_idx * range_size);
+            uint32_t end = thread_idx + 1 == thread_count ? m_count : std::min(m_count, begin + range_size);
+            range_counts[thread_idx] = cull_range(frustum, begin, end, visible.data() + begin);
+        }
+    });
+
+    uint32_t visible_count = range_counts[0];
+    for (uint32_t thread_idx = 1; thread_idx < thread_count; thread_idx++)
+    {
+        uint32_t begin = std::min(m_count, thread_idx * range_size);
+        memmove(visible.data() + visible_count, visible.data() + begin, range_counts[thread_idx] * sizeof(uint32_t));
+        visible_count += range_counts[thread_idx];
+    }
+
+    visible.resize(visible_count);
+    return visible_count;
+}
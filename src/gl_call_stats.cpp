@@ -0,0 +1,171 @@
+#include "gl_call_stats.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+struct GL_CallSite
+{
+    std::string function;
+    const char* call;
+    const char* source_file;
+    uint32_t line_number;
+
+    uint64_t frame_calls;
+    uint64_t frame_time;
+    uint64_t total_calls;
+    uint64_t total_time;
+};
+
+
+struct GL_CallStats
+{
+    std::mutex mutex;
+    std::vector<GL_CallSite> call_sites;
+    uint64_t frame_count;
+    uint64_t peak_frame_time;
+};
+
+
+static GL_CallStats& get_call_stats()
+{
+    static GL_CallStats call_stats = {};
+    return call_stats;
+}
+
+
+static thread_local uint64_t s_call_begin_time = 0;
+
+
+static uint64_t get_time_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+// The GL entry point of a wrapped call: the identifier before the first parenthesis
+static std::string get_function_name(const char* call)
+{
+    std::string call_string(call);
+    size_t end = call_string.find('(');
+    if (end == std::string::npos)
+        return call_string;
+
+    size_t begin = end;
+    while (begin > 0 && (isalnum((unsigned char)call_string[begin - 1]) || call_string[begin - 1] == '_'))
+        begin--;
+    return call_string.substr(begin, end - begin);
+}
+
+
+uint32_t gl_register_call_site(const char* call, const char* source_file, uint32_t line_number)
+{
+    GL_CallStats& call_stats = get_call_stats();
+    std::lock_guard<std::mutex> lock(call_stats.mutex);
+    call_stats.call_sites.push_back({ get_function_name(call), call, source_file, line_number, 0, 0, 0, 0 });
+    return (uint32_t)call_stats.call_sites.size() - 1;
+}
+
+
+void gl_call_begin()
+{
+    s_call_begin_time = get_time_ns();
+}
+
+
+void gl_call_end(uint32_t call_site)
+{
+    GL_CallSite& site = get_call_stats().call_sites[call_site];
+    site.frame_calls++;
+    site.frame_time += get_time_ns() - s_call_begin_time;
+}
+
+
+uint64_t gl_call_stats_end_frame()
+{
+    GL_CallStats& call_stats = get_call_stats();
+    std::lock_guard<std::mutex> lock(call_stats.mutex);
+    if (call_stats.call_sites.empty())
+        return 0;
+
+    uint64_t frame_calls = 0, frame_time = 0;
+    for (GL_CallSite& site : call_stats.call_sites)
+    {
+        frame_calls += site.frame_calls;
+        frame_time += site.frame_time;
+        site.total_calls += site.frame_calls;
+        site.total_time += site.frame_time;
+        site.frame_calls = 0;
+        site.frame_time = 0;
+    }
+    call_stats.peak_frame_time = std::max(call_stats.peak_frame_time, frame_time);
+    call_stats.frame_count++;
+    return frame_calls;
+}
+
+
+void gl_call_stats_report(uint32_t max_entries)
+{
+    GL_CallStats& call_stats = get_call_stats();
+    std::lock_guard<std::mutex> lock(call_stats.mutex);
+    if (call_stats.call_sites.empty() || !call_stats.frame_count)
+        return;
+
+    struct FunctionStats
+    {
+        const char* function;
+        uint64_t calls;
+        uint64_t time;
+    };
+
+    // Per-function totals across every call site
+    std::unordered_map<std::string, FunctionStats> function_index;
+    uint64_t total_calls = 0, total_time = 0;
+    for (const GL_CallSite& site : call_stats.call_sites)
+    {
+        FunctionStats& function_stats = function_index.try_emplace(site.function, FunctionStats{ site.function.c_str(), 0, 0 }).first->second;
+        function_stats.calls += site.total_calls;
+        function_stats.time += site.total_time;
+        total_calls += site.total_calls;
+        total_time += site.total_time;
+    }
+
+    std::vector<FunctionStats> functions;
+    for (const auto& [function, function_stats] : function_index)
+        functions.push_back(function_stats);
+    std::sort(functions.begin(), functions.end(), [](const FunctionStats& lhs, const FunctionStats& rhs) { return lhs.time > rhs.time; });
+
+    std::vector<const GL_CallSite*> sites;
+    for (const GL_CallSite& site : call_stats.call_sites)
+        sites.push_back(&site);
+    std::sort(sites.begin(), sites.end(), [](const GL_CallSite* lhs, const GL_CallSite* rhs) { return lhs->total_calls > rhs->total_calls; });
+
+    double frame_count = (double)call_stats.frame_count;
+    fprintf(stdout, "INFO | GL calls > %llu frame(s): %.1f call(s) and %.3f ms per frame (peak %.3f ms)\n",
+        (unsigned long long)call_stats.frame_count, total_calls / frame_count, total_time / frame_count * 1e-6, call_stats.peak_frame_time * 1e-6);
+
+    fprintf(stdout, "INFO | GL calls > Most expensive functions (per frame):\n");
+    for (size_t function_idx = 0; function_idx < std::min<size_t>(functions.size(), max_entries); function_idx++)
+    {
+        const FunctionStats& function_stats = functions[function_idx];
+        if (!function_stats.calls)
+            break;
+        fprintf(stdout, "    %-32s %10.1f call(s) %10.3f ms %8.0f ns/call\n", function_stats.function,
+            function_stats.calls / frame_count, function_stats.time / frame_count * 1e-6, (double)function_stats.time / function_stats.calls);
+    }
+
+    fprintf(stdout, "INFO | GL calls > Most frequent call sites (per frame):\n");
+    for (size_t site_idx = 0; site_idx < std::min<size_t>(sites.size(), max_entries); site_idx++)
+    {
+        const GL_CallSite* site = sites[site_idx];
+        if (!site->total_calls)
+            break;
+        fprintf(stdout, "    %10.1f call(s) %10.3f ms  %s @ %s:%u\n", site->total_calls / frame_count, site->total_time / frame_count * 1e-6,
+            site->call, site->source_file, site->line_number);
+    }
+}
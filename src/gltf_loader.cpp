@@ -0,0 +1,354 @@
+#include "gltf_loader.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+#include "gl_utils.h"
+#include "json.h"
+#include "renderer.h"
+
+
+static const uint32_t GLB_MAGIC = 0x46546c67;
+static const uint32_t GLB_CHUNK_JSON = 0x4e4f534a;
+static const uint32_t GLB_CHUNK_BIN = 0x004e4942;
+static const uint32_t GLTF_MODE_TRIANGLES = 4;
+
+
+static uint32_t read_u32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+
+static bool decode_base64(std::string_view text, std::vector<uint8_t>& bytes)
+{
+    auto decode_char = [](char c) -> int32_t {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+
+    bytes.reserve(text.size() * 3 / 4);
+    uint32_t accumulator = 0;
+    int32_t bit_count = 0;
+    for (char c : text)
+    {
+        if (c == '=')
+            break;
+
+        int32_t value = decode_char(c);
+        if (value < 0)
+            return false;
+
+        accumulator = (accumulator << 6) | (uint32_t)value;
+        bit_count += 6;
+        if (bit_count >= 8)
+        {
+            bit_count -= 8;
+            bytes.push_back((uint8_t)(accumulator >> bit_count));
+        }
+    }
+
+    return true;
+}
+
+
+static uint32_t get_component_count(std::string_view type)
+{
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+
+static float read_component(const uint8_t* data, uint32_t component_type, bool normalized)
+{
+    switch (component_type)
+    {
+    case GL_FLOAT:
+    {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case GL_UNSIGNED_BYTE:
+        return normalized ? data[0] / 255.0f : (float)data[0];
+    case GL_BYTE:
+        return normalized ? std::max((int8_t)data[0] / 127.0f, -1.0f) : (float)(int8_t)data[0];
+    case GL_UNSIGNED_SHORT:
+    {
+        uint16_t value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? value / 65535.0f : (float)value;
+    }
+    case GL_SHORT:
+    {
+        int16_t value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+    }
+    }
+
+    return 0.0f;
+}
+
+
+bool GLTF_Model::load(const std::string& file_path)
+{
+    *this = GLTF_Model();
+    if (!m_file.open(file_path))
+        return false;
+
+    const uint8_t* file_data = m_file.get_data();
+    size_t file_size = m_file.get_size();
+
+    // Locate JSON (and the embedded binary chunk for .glb files)
+    std::string_view json_text;
+    const uint8_t* glb_binary = nullptr;
+    size_t glb_binary_size = 0;
+    if (file_size >= 12 && read_u32(file_data) == GLB_MAGIC)
+    {
+        size_t offset = 12;
+        while (offset + 8 <= file_size)
+        {
+            uint32_t chunk_length = read_u32(file_data + offset);
+            uint32_t chunk_type = read_u32(file_data + offset + 4);
+            if (offset + 8 + chunk_length > file_size)
+                break;
+
+            if (chunk_type == GLB_CHUNK_JSON)
+                json_text = std::string_view((const char*)file_data + offset + 8, chunk_length);
+            else if (chunk_type == GLB_CHUNK_BIN && !glb_binary)
+            {
+                glb_binary = file_data + offset + 8;
+                glb_binary_size = chunk_length;
+            }
+            offset += 8 + ((chunk_length + 3) & ~3u);
+        }
+    }
+    else
+    {
+        json_text = std::string_view((const char*)file_data, file_size);
+    }
+
+    JsonValue document;
+    if (json_text.empty() || !parse_json(json_text, document))
+    {
+        fprintf(stderr, "ERROR | glTF > Invalid document: %s\n", file_path.c_str());
+        return false;
+    }
+
+    // Buffers; GLB chunk, external files (mapped) or base64 data URIs (decoded)
+    std::vector<std::pair<const uint8_t*, size_t>> buffers;
+    if (const JsonValue* buffers_json = document.find("buffers"))
+    {
+        std::filesystem::path base_path = std::filesystem::path(file_path).parent_path();
+        for (const JsonValue& buffer_json : buffers_json->as_array())
+        {
+            std::string_view uri = buffer_json.get_string("uri");
+            size_t byte_length = (size_t)buffer_json.get_number("byteLength", 0);
+            if (uri.empty())
+            {
+                buffers.emplace_back(glb_binary, std::min(byte_length, glb_binary_size));
+            }
+            else if (uri.substr(0, 5) == "data:")
+            {
+                size_t data_offset = uri.find(";base64,");
+                std::vector<uint8_t>& embedded = m_embedded_buffers.emplace_back();
+                if (data_offset == std::string_view::npos || !decode_base64(uri.substr(data_offset + 8), embedded))
+                {
+                    fprintf(stderr, "ERROR | glTF > Unsupported data URI in %s\n", file_path.c_str());
+                    return false;
+                }
+                buffers.emplace_back(embedded.data(), std::min(byte_length, embedded.size()));
+            }
+            else
+            {
+                MappedFile& external = m_external_buffers.emplace_back();
+                if (!external.open((base_path / std::string(uri)).string()))
+                    return false;
+                buffers.emplace_back(external.get_data(), std::min(byte_length, external.get_size()));
+            }
+        }
+    }
+
+    // Buffer views
+    if (const JsonValue* views_json = document.find("bufferViews"))
+    {
+        for (const JsonValue& view_json : views_json->as_array())
+        {
+            uint32_t buffer_idx = (uint32_t)view_json.get_number("buffer", -1);
+            uint32_t byte_offset = (uint32_t)view_json.get_number("byteOffset", 0);
+            uint32_t byte_length = (uint32_t)view_json.get_number("byteLength", 0);
+            if (buffer_idx >= buffers.size() || !buffers[buffer_idx].first || (size_t)byte_offset + byte_length > buffers[buffer_idx].second)
+            {
+                fprintf(stderr, "ERROR | glTF > Buffer view out of range in %s\n", file_path.c_str());
+                return false;
+            }
+
+            m_buffer_views.push_back({
+                buffers[buffer_idx].first + byte_offset,
+                byte_length,
+                (uint32_t)view_json.get_number("byteStride", 0),
+                (uint32_t)view_json.get_number("target", 0) });
+        }
+    }
+
+    // Accessors
+    std::vector<GLTF_Accessor> accessors;
+    if (const JsonValue* accessors_json = document.find("accessors"))
+    {
+        for (const JsonValue& accessor_json : accessors_json->as_array())
+        {
+            GLTF_Accessor accessor = {};
+            accessor.count = (uint32_t)accessor_json.get_number("count", 0);
+            accessor.component_type = (uint32_t)accessor_json.get_number("componentType", 0);
+            accessor.component_count = get_component_count(accessor_json.get_string("type"));
+            accessor.normalized = accessor_json.get_bool("normalized", false);
+            accessor.buffer_view = (int32_t)accessor_json.get_number("bufferView", -1);
+            accessor.byte_offset = (uint32_t)accessor_json.get_number("byteOffset", 0);
+
+            uint32_t element_size = accessor.component_count * (uint32_t)get_gl_type_size(accessor.component_type);
+            if (accessor.buffer_view >= 0 && (size_t)accessor.buffer_view < m_buffer_views.size() && element_size)
+            {
+                const GLTF_BufferView& view = m_buffer_views[accessor.buffer_view];
+                accessor.byte_stride = view.byte_stride ? view.byte_stride : element_size;
+
+                // Validate the last element fits inside the view
+                if (accessor.count && (size_t)accessor.byte_offset + (size_t)(accessor.count - 1) * accessor.byte_stride + element_size > view.byte_length)
+                {
+                    fprintf(stderr, "ERROR | glTF > Accessor out of range in %s\n", file_path.c_str());
+                    return false;
+                }
+                accessor.data = view.data + accessor.byte_offset;
+            }
+            accessors.push_back(accessor);
+        }
+    }
+
+    // Meshes
+    auto get_accessor = [&accessors](const JsonValue* index_json) {
+        GLTF_Accessor accessor = {};
+        accessor.buffer_view = -1;
+        if (index_json && index_json->get_type() == JsonValue::Type::Number && (size_t)index_json->as_number() < accessors.size())
+            accessor = accessors[(size_t)index_json->as_number()];
+        return accessor;
+    };
+
+    if (const JsonValue* meshes_json = document.find("meshes"))
+    {
+        for (const JsonValue& mesh_json : meshes_json->as_array())
+        {
+            GLTF_Mesh& mesh = m_meshes.emplace_back();
+            mesh.name = std::string(mesh_json.get_string("name"));
+
+            const JsonValue* primitives_json = mesh_json.find("primitives");
+            if (!primitives_json)
+                continue;
+
+            for (const JsonValue& primitive_json : primitives_json->as_array())
+            {
+                if ((uint32_t)primitive_json.get_number("mode", GLTF_MODE_TRIANGLES) != GLTF_MODE_TRIANGLES)
+                {
+                    fprintf(stdout, "WARN | glTF > Skipping non-triangle primitive in mesh '%s'\n", mesh.name.c_str());
+                    continue;
+                }
+
+                const JsonValue* attributes_json = primitive_json.find("attributes");
+                GLTF_Primitive primitive = {};
+                primitive.position = get_accessor(attributes_json ? attributes_json->find("POSITION") : nullptr);
+                primitive.normal = get_accessor(attributes_json ? attributes_json->find("NORMAL") : nullptr);
+                primitive.uv = get_accessor(attributes_json ? attributes_json->find("TEXCOORD_0") : nullptr);
+                primitive.indices = get_accessor(primitive_json.find("indices"));
+                if (!primitive.position.data)
+                {
+                    fprintf(stdout, "WARN | glTF > Skipping primitive without positions in mesh '%s'\n", mesh.name.c_str());
+                    continue;
+                }
+                mesh.primitives.push_back(primitive);
+            }
+        }
+    }
+
+    fprintf(stdout, "INFO | glTF > Loaded %s (%zu mesh(es), %zu buffer view(s))\n", file_path.c_str(), m_meshes.size(), m_buffer_views.size());
+    return true;
+}
+
+
+void GLTF_Model::upload_buffer_view(uint32_t view_idx, GL_DataBuffer<unsigned char>& data_buffer, uint32_t gl_buffer_type, uint32_t gl_buffer_usage) const
+{
+    const GLTF_BufferView& view = m_buffer_views[view_idx];
+    data_buffer.set_data(gl_buffer_type, view.byte_length, view.data, gl_buffer_usage);
+}
+
+
+bool GLTF_Model::get_mesh_data(uint32_t mesh_idx, uint32_t primitive_idx, MeshData& mesh_data) const
+{
+    if (mesh_idx >= m_meshes.size() || primitive_idx >= m_meshes[mesh_idx].primitives.size())
+        return false;
+
+    const GLTF_Primitive& primitive = m_meshes[mesh_idx].primitives[primitive_idx];
+    uint32_t vertex_count = primitive.position.count;
+
+    // Interleave attribute streams
+    auto copy_attribute = [vertex_count](const GLTF_Accessor& accessor, uint32_t component_count, float* destination, size_t destination_stride) {
+        if (!accessor.data || accessor.count < vertex_count)
+            return;
+
+        uint32_t component_size = (uint32_t)get_gl_type_size(accessor.component_type);
+        uint32_t copy_count = std::min(component_count, accessor.component_count);
+        for (uint32_t vertex_idx = 0; vertex_idx < vertex_count; vertex_idx++)
+        {
+            const uint8_t* element = accessor.data + (size_t)vertex_idx * accessor.byte_stride;
+            float* vertex_destination = (float*)((uint8_t*)destination + vertex_idx * destination_stride);
+            for (uint32_t component_idx = 0; component_idx < copy_count; component_idx++)
+                vertex_destination[component_idx] = read_component(element + component_idx * component_size, accessor.component_type, accessor.normalized);
+        }
+    };
+
+    mesh_data.vertices.assign(vertex_count, MeshVertex{});
+    copy_attribute(primitive.position, 3, mesh_data.vertices.data()->position, sizeof(MeshVertex));
+    copy_attribute(primitive.normal, 3, mesh_data.vertices.data()->normal, sizeof(MeshVertex));
+    copy_attribute(primitive.uv, 2, mesh_data.vertices.data()->uv, sizeof(MeshVertex));
+
+    // Widen indices (or generate them for non-indexed primitives)
+    const GLTF_Accessor& indices = primitive.indices;
+    if (indices.data)
+    {
+        mesh_data.indices.resize(indices.count);
+        for (uint32_t idx = 0; idx < indices.count; idx++)
+        {
+            const uint8_t* element = indices.data + (size_t)idx * indices.byte_stride;
+            uint32_t index = 0;
+            switch (indices.component_type)
+            {
+            case GL_UNSIGNED_BYTE: index = element[0]; break;
+            case GL_UNSIGNED_SHORT: { uint16_t value; memcpy(&value, element, sizeof(value)); index = value; break; }
+            case GL_UNSIGNED_INT: index = read_u32(element); break;
+            }
+            if (index >= vertex_count)
+            {
+                fprintf(stderr, "ERROR | glTF > Index out of range in mesh '%s'\n", m_meshes[mesh_idx].name.c_str());
+                mesh_data = {};
+                return false;
+            }
+            mesh_data.indices[idx] = index;
+        }
+    }
+    else
+    {
+        mesh_data.indices.resize(vertex_count);
+        for (uint32_t idx = 0; idx < vertex_count; idx++)
+            mesh_data.indices[idx] = idx;
+    }
+
+    return true;
+}
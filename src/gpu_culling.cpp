@@ -0,0 +1,123 @@
+#include "gpu_culling.h"
+#include "renderer.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include "string_interner.h"
+
+
+GL_GpuCuller::GL_GpuCuller(const std::string& cull_shader_path, const std::string& hiz_shader_path) :
+    m_object_count(0), m_hiz_texture_id(0), m_hiz_width(0), m_hiz_height(0), m_hiz_levels(0)
+{
+    m_cull_program.create_compute(cull_shader_path);
+    m_hiz_program.create_compute(hiz_shader_path);
+
+    const uint32_t zero = 0;
+    m_count_buffer.set_data(GL_SHADER_STORAGE_BUFFER, 1, &zero, GL_DYNAMIC_DRAW);
+    m_params_buffer.set_data(GL_UNIFORM_BUFFER, sizeof(GL_GpuCullParams), nullptr, GL_DYNAMIC_DRAW);
+}
+
+
+GL_GpuCuller::~GL_GpuCuller()
+{
+    if (m_hiz_texture_id)
+    {
+        GL_CALL(glDeleteTextures(1, &m_hiz_texture_id));
+    }
+}
+
+
+void GL_GpuCuller::set_objects(const GL_GpuCullObject* objects, uint32_t object_count)
+{
+    m_object_count = object_count;
+    m_object_buffer.set_data(GL_SHADER_STORAGE_BUFFER, object_count * (uint32_t)sizeof(GL_GpuCullObject), (const unsigned char*)objects, GL_STATIC_DRAW);
+    m_command_buffer.set_data(GL_DRAW_INDIRECT_BUFFER, std::max(object_count, 1u), nullptr, GL_DYNAMIC_DRAW);
+}
+
+
+void GL_GpuCuller::build_hiz(uint32_t depth_texture_id, uint32_t width, uint32_t height)
+{
+    // (Re)allocate the pyramid when the depth buffer size changes
+    if (!m_hiz_texture_id || m_hiz_width != width || m_hiz_height != height)
+    {
+        if (m_hiz_texture_id)
+        {
+            GL_CALL(glDeleteTextures(1, &m_hiz_texture_id));
+        }
+
+        m_hiz_width = width;
+        m_hiz_height = height;
+        m_hiz_levels = 1;
+        while ((std::max(width, height) >> m_hiz_levels) > 0)
+            m_hiz_levels++;
+
+        GL_CALL(glGenTextures(1, &m_hiz_texture_id));
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, m_hiz_texture_id));
+        GL_CALL(glTexStorage2D(GL_TEXTURE_2D, m_hiz_levels, GL_R32F, width, height));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    }
+
+    static const uint32_t u_source_id = intern_string("u_source");
+    static const uint32_t u_source_level_id = intern_string("u_source_level");
+
+    m_hiz_program.set_uniform_1i(u_source_id, 0);
+    GL_CALL(glActiveTexture(GL_TEXTURE0));
+    for (uint32_t level = 0; level < m_hiz_levels; level++)
+    {
+        // Level 0 copies the depth texture, every further level reduces the one above it
+        GL_CALL(glBindTexture(GL_TEXTURE_2D, level ? m_hiz_texture_id : depth_texture_id));
+        GL_ShaderProgram::bind_image(0, m_hiz_texture_id, GL_WRITE_ONLY, GL_R32F, level);
+        m_hiz_program.set_uniform_1i(u_source_level_id, (int32_t)level - 1);
+        m_hiz_program.dispatch_invocations(std::max(width >> level, 1u), std::max(height >> level, 1u));
+        GL_ShaderProgram::memory_barrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    m_hiz_program.unbind();
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+}
+
+
+void GL_GpuCuller::cull(const Frustum& frustum, const float* view_projection, bool occlusion)
+{
+    if (!m_object_count)
+        return;
+
+    GL_GpuCullParams params = {};
+    memcpy(params.frustum_planes, frustum.planes, sizeof(params.frustum_planes));
+    memcpy(params.view_projection, view_projection, sizeof(params.view_projection));
+    params.hiz_size[0] = (float)m_hiz_width;
+    params.hiz_size[1] = (float)m_hiz_height;
+    params.object_count = m_object_count;
+    params.occlusion_enabled = occlusion && m_hiz_texture_id;
+    m_params_buffer.set_data(GL_UNIFORM_BUFFER, sizeof(params), (const unsigned char*)&params, GL_DYNAMIC_DRAW);
+
+    // Reset the draw count, and the whole command buffer when the draw count can't be read by the GPU
+    const uint32_t zero = 0;
+    m_count_buffer.bind();
+    GL_CALL(glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero));
+    if (!GLEW_ARB_indirect_parameters)
+    {
+        m_command_buffer.bind();
+        GL_CALL(glClearBufferData(GL_DRAW_INDIRECT_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero));
+    }
+
+    m_params_buffer.bind_base(GL_UNIFORM_BUFFER, 0);
+    m_object_buffer.bind_base(GL_SHADER_STORAGE_BUFFER, 0);
+    m_command_buffer.bind_base(GL_SHADER_STORAGE_BUFFER, 1);
+    m_count_buffer.bind_base(GL_SHADER_STORAGE_BUFFER, 2);
+
+    static const uint32_t u_hiz_id = intern_string("u_hiz");
+    m_cull_program.set_uniform_1i(u_hiz_id, 0);
+    GL_CALL(glActiveTexture(GL_TEXTURE0));
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, m_hiz_texture_id));
+    m_cull_program.dispatch_invocations(m_object_count);
+
+    // Commands and count are consumed as indirect draw parameters
+    GL_ShaderProgram::memory_barrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+    m_cull_program.unbind();
+    GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+}
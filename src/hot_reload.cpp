@@ -0,0 +1,257 @@
+#include "hot_reload.h"
+#include <algorithm>
+#include <cstdio>
+#include <unordered_set>
+#include "file_utils.h"
+
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start_time)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+
+template<typename T>
+static bool is_tracked(const std::unordered_multimap<std::string, T*>& tracked_objects, const T* object)
+{
+    for (const auto& [file_path, tracked_object] : tracked_objects)
+    {
+        if (tracked_object == object)
+            return true;
+    }
+
+    return false;
+}
+
+
+template<typename T>
+static void erase_tracked(std::unordered_multimap<std::string, T*>& tracked_objects, const T* object, std::vector<std::string>& erased_paths)
+{
+    for (auto it = tracked_objects.begin(); it != tracked_objects.end();)
+    {
+        if (it->second == object)
+        {
+            erased_paths.push_back(it->first);
+            it = tracked_objects.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+
+HotReloader* HotReloader::s_active = nullptr;
+
+
+HotReloader::HotReloader()
+{
+    ASSERT(!s_active);
+    s_active = this;
+}
+
+
+HotReloader::~HotReloader()
+{
+    s_active = nullptr;
+
+    // Reload jobs write into this object, so they have to finish first
+    JobSystem::get().wait(m_job_counter);
+
+    for (PendingTexture& pending_texture : m_pending_textures)
+        GL_Texture2D::free_image(pending_texture.image_data);
+}
+
+
+void HotReloader::track(GL_ShaderProgram* shader_program)
+{
+    // Re-tracking replaces the previous registration, whose files may have changed since
+    untrack(shader_program);
+    for (const GL_ShaderStage& stage : shader_program->get_stages())
+    {
+        m_shader_programs.emplace(FileWatcher::normalize_path(stage.file_path), shader_program);
+        m_file_watcher.watch(stage.file_path);
+    }
+}
+
+
+void HotReloader::track(GL_Texture2D* texture)
+{
+    untrack(texture);
+    m_textures.emplace(FileWatcher::normalize_path(texture->get_file_path()), texture);
+    m_file_watcher.watch(texture->get_file_path());
+}
+
+
+void HotReloader::untrack(GL_ShaderProgram* shader_program)
+{
+    std::vector<std::string> erased_paths;
+    erase_tracked(m_shader_programs, shader_program, erased_paths);
+    unwatch_unused(erased_paths);
+
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    std::erase_if(m_pending_shaders, [shader_program](const PendingShader& pending_shader) {
+        return pending_shader.shader_program == shader_program;
+    });
+}
+
+
+void HotReloader::untrack(GL_Texture2D* texture)
+{
+    std::vector<std::string> erased_paths;
+    erase_tracked(m_textures, texture, erased_paths);
+    unwatch_unused(erased_paths);
+
+    std::lock_guard<std::mutex> lock(m_pending_mutex);
+    std::erase_if(m_pending_textures, [texture](PendingTexture& pending_texture) {
+        if (pending_texture.texture != texture)
+            return false;
+        GL_Texture2D::free_image(pending_texture.image_data);
+        return true;
+    });
+}
+
+
+void HotReloader::unwatch_unused(const std::vector<std::string>& file_paths)
+{
+    // Several objects can share a file; it stays watched until the last of them is untracked
+    for (const std::string& file_path : file_paths)
+    {
+        if (m_shader_programs.find(file_path) == m_shader_programs.end() && m_textures.find(file_path) == m_textures.end())
+            m_file_watcher.unwatch(file_path);
+    }
+}
+
+
+void HotReloader::reload_shader(GL_ShaderProgram* shader_program)
+{
+    std::chrono::steady_clock::time_point change_time = std::chrono::steady_clock::now();
+    std::vector<GL_ShaderStage> stages = shader_program->get_stages();
+
+    JobSystem::get().submit([this, shader_program, stages, change_time]() {
+        PendingShader pending_shader = { shader_program, {}, change_time };
+        for (const GL_ShaderStage& stage : stages)
+            pending_shader.stage_sources.push_back(read_file(stage.file_path));
+
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending_shaders.push_back(std::move(pending_shader));
+    }, &m_job_counter);
+}
+
+
+void HotReloader::reload_texture(GL_Texture2D* texture)
+{
+    std::chrono::steady_clock::time_point change_time = std::chrono::steady_clock::now();
+    std::string file_path = texture->get_file_path();
+    bool flip_vertically = texture->get_flip_vertically();
+    int32_t channels = texture->get_requested_channels();
+
+    JobSystem::get().submit([this, texture, file_path, flip_vertically, channels, change_time]() {
+        GL_ImageData image_data = GL_Texture2D::decode_image(file_path, flip_vertically, channels);
+        if (!image_data.pixels)
+            return;
+
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        m_pending_textures.push_back({ texture, image_data, change_time });
+    }, &m_job_counter);
+}
+
+
+void HotReloader::update()
+{
+    // Schedule reloads for changed files
+    m_changed_paths.clear();
+    m_file_watcher.poll_changes(m_changed_paths);
+    if (!m_changed_paths.empty())
+    {
+        std::unordered_set<GL_ShaderProgram*> changed_shader_programs;
+        std::unordered_set<GL_Texture2D*> changed_textures;
+        for (const std::string& changed_path : m_changed_paths)
+        {
+            std::string normalized_path = FileWatcher::normalize_path(changed_path);
+
+            auto shader_range = m_shader_programs.equal_range(normalized_path);
+            for (auto it = shader_range.first; it != shader_range.second; it++)
+                changed_shader_programs.insert(it->second);
+
+            auto texture_range = m_textures.equal_range(normalized_path);
+            for (auto it = texture_range.first; it != texture_range.second; it++)
+                changed_textures.insert(it->second);
+        }
+
+        for (GL_ShaderProgram* shader_program : changed_shader_programs)
+            reload_shader(shader_program);
+        for (GL_Texture2D* texture : changed_textures)
+            reload_texture(texture);
+    }
+
+    // Swap finished reloads into their objects
+    std::vector<PendingShader> pending_shaders;
+    std::vector<PendingTexture> pending_textures;
+    {
+        std::lock_guard<std::mutex> lock(m_pending_mutex);
+        pending_shaders.swap(m_pending_shaders);
+        pending_textures.swap(m_pending_textures);
+    }
+
+    for (PendingShader& pending_shader : pending_shaders)
+    {
+        if (!is_tracked(m_shader_programs, pending_shader.shader_program))
+            continue;
+
+        std::string stage_paths;
+        for (const GL_ShaderStage& stage : pending_shader.shader_program->get_stages())
+            stage_paths += (stage_paths.empty() ? "" : ", ") + stage.file_path;
+
+        if (pending_shader.shader_program->reload(pending_shader.stage_sources))
+        {
+            fprintf(stdout, "INFO | HotReload > Reloaded shader program [%s] in %.2fms\n",
+                stage_paths.c_str(), elapsed_ms(pending_shader.change_time));
+        }
+        else
+        {
+            fprintf(stdout, "WARN | HotReload > Keeping previous shader program [%s]\n", stage_paths.c_str());
+        }
+    }
+
+    for (PendingTexture& pending_texture : pending_textures)
+    {
+        if (is_tracked(m_textures, pending_texture.texture))
+        {
+            pending_texture.texture->upload_image(pending_texture.image_data);
+            fprintf(stdout, "INFO | HotReload > Reloaded texture [%s] in %.2fms\n",
+                pending_texture.texture->get_file_path().c_str(),
+                elapsed_ms(pending_texture.change_time));
+        }
+        GL_Texture2D::free_image(pending_texture.image_data);
+    }
+}
+
+
+void HotReloader::notify_loaded(GL_ShaderProgram* shader_program)
+{
+    if (s_active)
+        s_active->track(shader_program);
+}
+
+
+void HotReloader::notify_loaded(GL_Texture2D* texture)
+{
+    if (s_active)
+        s_active->track(texture);
+}
+
+
+void HotReloader::notify_destroyed(GL_ShaderProgram* shader_program)
+{
+    if (s_active)
+        s_active->untrack(shader_program);
+}
+
+
+void HotReloader::notify_destroyed(GL_Texture2D* texture)
+{
+    if (s_active)
+        s_active->untrack(texture);
+}
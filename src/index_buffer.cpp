@@ -0,0 +1,91 @@
+#include "index_buffer.h"
+#include "renderer.h"
+#include <vector>
+#include "gl_utils.h"
+#include "profiler.h"
+
+
+template<typename T>
+static void upload_narrowed(uint32_t index_count, const uint32_t* index_data, uint32_t gl_buffer_usage)
+{
+    std::vector<T> narrowed(index_data, index_data + index_count);
+    GL_CALL(glBufferData(GL_COPY_WRITE_BUFFER, index_count * sizeof(T), narrowed.data(), gl_buffer_usage));
+}
+
+
+GL_IndexBuffer::GL_IndexBuffer() :
+    m_gl_id(0), m_gl_index_type(GL_UNSIGNED_INT), m_index_count(0), m_buffer_size(0)
+{
+    GL_CALL(glGenBuffers(1, &m_gl_id));
+    ASSERT(m_gl_id);
+}
+
+
+GL_IndexBuffer::GL_IndexBuffer(uint32_t index_count, const uint32_t* index_data, uint32_t gl_buffer_usage) :
+    GL_IndexBuffer()
+{
+    set_data(index_count, index_data, gl_buffer_usage);
+}
+
+
+GL_IndexBuffer::~GL_IndexBuffer()
+{
+    GL_CALL(glDeleteBuffers(1, &m_gl_id));
+}
+
+
+uint32_t GL_IndexBuffer::select_index_type(uint32_t vertex_count)
+{
+    if (vertex_count <= 0x100)
+        return GL_UNSIGNED_BYTE;
+    if (vertex_count <= 0x10000)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
+}
+
+
+void GL_IndexBuffer::set_data(uint32_t index_count, const uint32_t* index_data, uint32_t gl_buffer_usage)
+{
+    // Size the index type by the highest referenced vertex rather than trusting a caller's vertex count
+    uint32_t max_index = 0;
+    for (uint32_t idx = 0; idx < index_count; idx++)
+        max_index = index_data[idx] > max_index ? index_data[idx] : max_index;
+
+    m_gl_index_type = select_index_type(max_index + 1);
+    m_index_count = index_count;
+    m_buffer_size = index_count * (uint32_t)get_gl_type_size(m_gl_index_type);
+
+    /**
+     * NOTE: uploads go through GL_COPY_WRITE_BUFFER since binding GL_ELEMENT_ARRAY_BUFFER would change
+     * the element buffer of whichever VAO the renderer left bound
+     */
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_gl_id));
+    switch (m_gl_index_type)
+    {
+    case GL_UNSIGNED_BYTE:
+        upload_narrowed<uint8_t>(index_count, index_data, gl_buffer_usage);
+        break;
+
+    case GL_UNSIGNED_SHORT:
+        upload_narrowed<uint16_t>(index_count, index_data, gl_buffer_usage);
+        break;
+
+    default:
+        GL_CALL(glBufferData(GL_COPY_WRITE_BUFFER, m_buffer_size, index_data, gl_buffer_usage));
+        break;
+    }
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    Profiler::get().count_upload(m_buffer_size);
+}
+
+
+void GL_IndexBuffer::bind() const
+{
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_gl_id));
+}
+
+
+void GL_IndexBuffer::unbind() const
+{
+    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+}
@@ -0,0 +1,375 @@
+#include "job_system.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include "profiler.h"
+
+
+static thread_local uint32_t s_worker_idx = UINT32_MAX;
+static thread_local uint32_t s_steal_seed = 0x9E3779B9u;
+
+
+static uint32_t next_random()
+{
+    // xorshift32, per thread
+    s_steal_seed ^= s_steal_seed << 13;
+    s_steal_seed ^= s_steal_seed >> 17;
+    s_steal_seed ^= s_steal_seed << 5;
+    return s_steal_seed;
+}
+
+
+JobCounter::JobCounter() :
+    m_value(0), m_continuations(nullptr)
+{
+}
+
+
+JobDeque::JobDeque() :
+    m_top(0), m_bottom(0), m_jobs(new std::atomic<Job*>[CAPACITY])
+{
+}
+
+
+bool JobDeque::push(Job* job)
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+    int64_t top = m_top.load(std::memory_order_acquire);
+    if (bottom - top >= CAPACITY)
+        return false;
+
+    m_jobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+
+Job* JobDeque::pop()
+{
+    int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+    m_bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = m_top.load(std::memory_order_relaxed);
+
+    if (top > bottom)
+    {
+        // Empty
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Job* job = m_jobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (top == bottom)
+    {
+        // Last job; race thieves for it
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        m_bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return job;
+}
+
+
+Job* JobDeque::steal()
+{
+    int64_t top = m_top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = m_bottom.load(std::memory_order_acquire);
+    if (top >= bottom)
+        return nullptr;
+
+    Job* job = m_jobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+    if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+    return job;
+}
+
+
+JobSystem::JobSystem() :
+    m_running(true), m_queued_count(0)
+{
+    // Worker 0 only helps while waiting, so keep one background worker for jobs nobody waits on
+    uint32_t worker_count = std::max(2u, std::thread::hardware_concurrency());
+    for (uint32_t worker_idx = 0; worker_idx < worker_count; worker_idx++)
+        m_deques.push_back(std::make_unique<JobDeque>());
+    m_job_pools.reset(new JobPool[worker_count]);
+    for (uint32_t worker_idx = 0; worker_idx < worker_count; worker_idx++)
+    {
+        m_job_pools[worker_idx].free_jobs = nullptr;
+        m_job_pools[worker_idx].returned_jobs = nullptr;
+    }
+
+    // The calling (main) thread is worker 0
+    s_worker_idx = 0;
+    for (uint32_t worker_idx = 1; worker_idx < worker_count; worker_idx++)
+        m_workers.emplace_back(&JobSystem::worker_loop, this, worker_idx);
+
+    fprintf(stdout, "INFO | JobSystem > Started %u worker(s)\n", worker_count);
+}
+
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_running = false;
+    }
+    m_sleep_condition.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+
+    // Jobs still queued at exit are dropped without running
+    for (std::unique_ptr<JobDeque>& deque : m_deques)
+    {
+        while (Job* job = deque->pop())
+        {
+            job->invoke(job, false);
+            delete job;
+        }
+    }
+    for (Job* job : m_injection_queue)
+    {
+        job->invoke(job, false);
+        delete job;
+    }
+
+    for (uint32_t worker_idx = 0; worker_idx < m_deques.size(); worker_idx++)
+    {
+        for (Job* job_list : { m_job_pools[worker_idx].free_jobs, m_job_pools[worker_idx].returned_jobs.load() })
+        {
+            while (job_list)
+            {
+                Job* next_job = job_list->next;
+                delete job_list;
+                job_list = next_job;
+            }
+        }
+    }
+}
+
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem job_system;
+    return job_system;
+}
+
+
+uint32_t JobSystem::get_worker_index()
+{
+    return s_worker_idx;
+}
+
+
+void JobSystem::worker_loop(uint32_t worker_idx)
+{
+    s_worker_idx = worker_idx;
+    s_steal_seed ^= worker_idx * 0x85EBCA6Bu;
+    Profiler::get().set_thread_name("Worker " + std::to_string(worker_idx));
+
+    while (m_running)
+    {
+        if (Job* job = find_job())
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_sleep_condition.wait(lock, [this]() { return !m_running || m_queued_count.load() > 0; });
+    }
+}
+
+
+Job* JobSystem::allocate_job()
+{
+    if (s_worker_idx < m_deques.size())
+    {
+        JobPool& job_pool = m_job_pools[s_worker_idx];
+        if (!job_pool.free_jobs)
+            job_pool.free_jobs = job_pool.returned_jobs.exchange(nullptr, std::memory_order_acquire);
+
+        if (Job* job = job_pool.free_jobs)
+        {
+            job_pool.free_jobs = job->next;
+            return job;
+        }
+    }
+
+    Job* job = new Job;
+    job->owner_idx = s_worker_idx;
+    return job;
+}
+
+
+void JobSystem::free_job(Job* job)
+{
+    // Jobs allocated outside the pool aren't recycled
+    if (job->owner_idx >= m_deques.size())
+    {
+        delete job;
+        return;
+    }
+
+    JobPool& job_pool = m_job_pools[job->owner_idx];
+    if (job->owner_idx == s_worker_idx)
+    {
+        job->next = job_pool.free_jobs;
+        job_pool.free_jobs = job;
+        return;
+    }
+
+    // Only the owner takes from the returned stack, and it takes all of it at once, so there is no ABA
+    Job* returned_head = job_pool.returned_jobs.load(std::memory_order_relaxed);
+    do
+    {
+        job->next = returned_head;
+    } while (!job_pool.returned_jobs.compare_exchange_weak(returned_head, job, std::memory_order_release, std::memory_order_relaxed));
+}
+
+
+void JobSystem::schedule(Job* job)
+{
+    m_queued_count++;
+    if (s_worker_idx < m_deques.size())
+    {
+        // A full deque runs the job right away rather than growing
+        if (!m_deques[s_worker_idx]->push(job))
+        {
+            m_queued_count--;
+            execute(job);
+            return;
+        }
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(m_injection_mutex);
+        m_injection_queue.push_back(job);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_sleep_condition.notify_one();
+}
+
+
+Job* JobSystem::find_job()
+{
+    Job* job = nullptr;
+    if (s_worker_idx < m_deques.size())
+        job = m_deques[s_worker_idx]->pop();
+
+    if (!job)
+    {
+        std::lock_guard<std::mutex> lock(m_injection_mutex);
+        if (!m_injection_queue.empty())
+        {
+            job = m_injection_queue.back();
+            m_injection_queue.pop_back();
+        }
+    }
+
+    if (!job)
+    {
+        uint32_t worker_count = (uint32_t)m_deques.size();
+        uint32_t first_victim = next_random() % worker_count;
+        for (uint32_t victim_offset = 0; victim_offset < worker_count && !job; victim_offset++)
+        {
+            uint32_t victim_idx = (first_victim + victim_offset) % worker_count;
+            if (victim_idx != s_worker_idx)
+                job = m_deques[victim_idx]->steal();
+        }
+    }
+
+    if (job)
+        m_queued_count--;
+    return job;
+}
+
+
+void JobSystem::execute(Job* job)
+{
+    job->invoke(job, true);
+
+    JobCounter* counter = job->counter;
+    free_job(job);
+    if (!counter)
+        return;
+
+    // The decrement and the last access to the counter share one critical section: once it reaches zero
+    // the waiter may return and destroy it, which `wait` holds off until the lock is released
+    Job* continuation;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+
+        // Release every job which was waiting on this counter
+        continuation = counter->m_continuations;
+        counter->m_continuations = nullptr;
+    }
+    while (continuation)
+    {
+        Job* next_continuation = continuation->next;
+        schedule(continuation);
+        continuation = next_continuation;
+    }
+}
+
+
+void JobSystem::enqueue(Job* job, JobCounter* counter, JobCounter* dependency)
+{
+    job->counter = counter;
+    if (counter)
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+
+    if (dependency)
+    {
+        std::lock_guard<std::mutex> lock(dependency->m_mutex);
+        if (!dependency->is_done())
+        {
+            job->next = dependency->m_continuations;
+            dependency->m_continuations = job;
+            return;
+        }
+    }
+
+    schedule(job);
+}
+
+
+void JobSystem::wait(JobCounter& counter)
+{
+    while (!counter.is_done())
+    {
+        if (Job* job = find_job())
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+
+    // The job that finished the counter may still hold its lock
+    std::lock_guard<std::mutex> lock(counter.m_mutex);
+}
+
+
+void JobSystem::run_on_gl_thread(std::function<void()> function)
+{
+    std::lock_guard<std::mutex> lock(m_gl_thread_mutex);
+    m_gl_thread_jobs.push_back(std::move(function));
+}
+
+
+void JobSystem::process_gl_thread_jobs()
+{
+    std::vector<std::function<void()>> gl_thread_jobs;
+    {
+        std::lock_guard<std::mutex> lock(m_gl_thread_mutex);
+        gl_thread_jobs.swap(m_gl_thread_jobs);
+    }
+
+    for (std::function<void()>& function : gl_thread_jobs)
+        function();
+}
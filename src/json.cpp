@@ -0,0 +1,324 @@
+#include "json.h"
+#include <cstdio>
+#include <cstdlib>
+
+
+static const JsonValue s_null_value;
+
+
+class JsonParser
+{
+private:
+    const char* m_ptr;
+    const char* m_end;
+    uint32_t m_depth;
+
+private:
+    void skip_whitespace()
+    {
+        while (m_ptr < m_end && (*m_ptr == ' ' || *m_ptr == '\t' || *m_ptr == '\n' || *m_ptr == '\r'))
+            m_ptr++;
+    }
+
+    bool consume(const char* literal)
+    {
+        const char* ptr = m_ptr;
+        for (; *literal; literal++, ptr++)
+        {
+            if (ptr >= m_end || *ptr != *literal)
+                return false;
+        }
+        m_ptr = ptr;
+        return true;
+    }
+
+    static void append_utf8(std::string& string, uint32_t code_point)
+    {
+        if (code_point < 0x80)
+        {
+            string += (char)code_point;
+        }
+        else if (code_point < 0x800)
+        {
+            string += (char)(0xc0 | (code_point >> 6));
+            string += (char)(0x80 | (code_point & 0x3f));
+        }
+        else if (code_point < 0x10000)
+        {
+            string += (char)(0xe0 | (code_point >> 12));
+            string += (char)(0x80 | ((code_point >> 6) & 0x3f));
+            string += (char)(0x80 | (code_point & 0x3f));
+        }
+        else
+        {
+            string += (char)(0xf0 | (code_point >> 18));
+            string += (char)(0x80 | ((code_point >> 12) & 0x3f));
+            string += (char)(0x80 | ((code_point >> 6) & 0x3f));
+            string += (char)(0x80 | (code_point & 0x3f));
+        }
+    }
+
+    bool parse_hex4(uint32_t& value)
+    {
+        value = 0;
+        for (uint32_t idx = 0; idx < 4; idx++, m_ptr++)
+        {
+            if (m_ptr >= m_end)
+                return false;
+
+            char c = *m_ptr;
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool parse_string(std::string& string)
+    {
+        // Opening quote already checked by the caller
+        m_ptr++;
+        while (m_ptr < m_end && *m_ptr != '"')
+        {
+            if (*m_ptr != '\\')
+            {
+                string += *m_ptr++;
+                continue;
+            }
+
+            if (++m_ptr >= m_end)
+                return false;
+
+            char escape = *m_ptr++;
+            switch (escape)
+            {
+            case '"': string += '"'; break;
+            case '\\': string += '\\'; break;
+            case '/': string += '/'; break;
+            case 'b': string += '\b'; break;
+            case 'f': string += '\f'; break;
+            case 'n': string += '\n'; break;
+            case 'r': string += '\r'; break;
+            case 't': string += '\t'; break;
+            case 'u':
+            {
+                uint32_t code_point;
+                if (!parse_hex4(code_point))
+                    return false;
+
+                // Surrogate pairs
+                if (code_point >= 0xd800 && code_point < 0xdc00 && consume("\\u"))
+                {
+                    uint32_t low_surrogate;
+                    if (!parse_hex4(low_surrogate))
+                        return false;
+                    code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low_surrogate - 0xdc00);
+                }
+                append_utf8(string, code_point);
+                break;
+            }
+            default:
+                return false;
+            }
+        }
+
+        if (m_ptr >= m_end)
+            return false;
+        m_ptr++;
+        return true;
+    }
+
+    bool parse_number(double& number)
+    {
+        /**
+         * NOTE: strtod needs a terminated buffer, so the (short) number token is copied out first
+         */
+        char buffer[64];
+        size_t length = 0;
+        while (m_ptr < m_end && length < sizeof(buffer) - 1 &&
+            ((*m_ptr >= '0' && *m_ptr <= '9') || *m_ptr == '-' || *m_ptr == '+' || *m_ptr == '.' || *m_ptr == 'e' || *m_ptr == 'E'))
+        {
+            buffer[length++] = *m_ptr++;
+        }
+        buffer[length] = '\0';
+
+        char* number_end;
+        number = strtod(buffer, &number_end);
+        return length && number_end == buffer + length;
+    }
+
+public:
+    JsonParser(std::string_view text) :
+        m_ptr(text.data()), m_end(text.data() + text.size()), m_depth(0) {}
+
+    bool parse_value(JsonValue& value)
+    {
+        skip_whitespace();
+        if (m_ptr >= m_end || m_depth > 256)
+            return false;
+
+        switch (*m_ptr)
+        {
+        case '{':
+        {
+            value.m_type = JsonValue::Type::Object;
+            m_ptr++;
+            m_depth++;
+            skip_whitespace();
+            if (m_ptr < m_end && *m_ptr == '}')
+            {
+                m_ptr++;
+                m_depth--;
+                return true;
+            }
+            while (true)
+            {
+                skip_whitespace();
+                if (m_ptr >= m_end || *m_ptr != '"')
+                    return false;
+
+                value.m_object.emplace_back();
+                if (!parse_string(value.m_object.back().first))
+                    return false;
+
+                skip_whitespace();
+                if (m_ptr >= m_end || *m_ptr++ != ':')
+                    return false;
+                if (!parse_value(value.m_object.back().second))
+                    return false;
+
+                skip_whitespace();
+                if (m_ptr < m_end && *m_ptr == ',')
+                {
+                    m_ptr++;
+                    continue;
+                }
+                if (m_ptr < m_end && *m_ptr == '}')
+                {
+                    m_ptr++;
+                    m_depth--;
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        case '[':
+        {
+            value.m_type = JsonValue::Type::Array;
+            m_ptr++;
+            m_depth++;
+            skip_whitespace();
+            if (m_ptr < m_end && *m_ptr == ']')
+            {
+                m_ptr++;
+                m_depth--;
+                return true;
+            }
+            while (true)
+            {
+                value.m_array.emplace_back();
+                if (!parse_value(value.m_array.back()))
+                    return false;
+
+                skip_whitespace();
+                if (m_ptr < m_end && *m_ptr == ',')
+                {
+                    m_ptr++;
+                    continue;
+                }
+                if (m_ptr < m_end && *m_ptr == ']')
+                {
+                    m_ptr++;
+                    m_depth--;
+                    return true;
+                }
+                return false;
+            }
+        }
+
+        case '"':
+            value.m_type = JsonValue::Type::String;
+            return parse_string(value.m_string);
+
+        case 't':
+            value.m_type = JsonValue::Type::Bool;
+            value.m_bool = true;
+            return consume("true");
+
+        case 'f':
+            value.m_type = JsonValue::Type::Bool;
+            value.m_bool = false;
+            return consume("false");
+
+        case 'n':
+            value.m_type = JsonValue::Type::Null;
+            return consume("null");
+
+        default:
+            value.m_type = JsonValue::Type::Number;
+            return parse_number(value.m_number);
+        }
+    }
+
+    bool at_end()
+    {
+        skip_whitespace();
+        return m_ptr == m_end;
+    }
+};
+
+
+JsonValue::JsonValue() :
+    m_type(Type::Null), m_bool(false), m_number(0.0) {}
+
+
+const JsonValue* JsonValue::find(std::string_view key) const
+{
+    for (const auto& [member_key, member_value] : m_object)
+    {
+        if (member_key == key)
+            return &member_value;
+    }
+
+    return nullptr;
+}
+
+
+double JsonValue::get_number(std::string_view key, double default_value) const
+{
+    const JsonValue* member = find(key);
+    return member && member->m_type == Type::Number ? member->m_number : default_value;
+}
+
+
+std::string_view JsonValue::get_string(std::string_view key, std::string_view default_value) const
+{
+    const JsonValue* member = find(key);
+    return member && member->m_type == Type::String ? std::string_view(member->m_string) : default_value;
+}
+
+
+bool JsonValue::get_bool(std::string_view key, bool default_value) const
+{
+    const JsonValue* member = find(key);
+    return member && member->m_type == Type::Bool ? member->m_bool : default_value;
+}
+
+
+bool parse_json(std::string_view text, JsonValue& value)
+{
+    value = s_null_value;
+
+    JsonParser parser(text);
+    if (!parser.parse_value(value) || !parser.at_end())
+    {
+        fprintf(stderr, "ERROR | JSON > Failed to parse document\n");
+        value = s_null_value;
+        return false;
+    }
+
+    return true;
+}
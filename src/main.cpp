@@ -3,14 +3,72 @@
 #include "renderer.h"
 #include <GLFW/glfw3.h>
 #include "data_buffer.h"
-#include "vertex_array.h"
+#include "vertex_format.h"
 #include "attrib_array.h"
+#include "vertex_layout.h"
 #include "shader_program.h"
 #include "texture_2d.h"
+#include "hot_reload.h"
+#include "job_system.h"
+#include "transform_system.h"
+#include "scene.h"
+#include "render_queue.h"
+#include "render_thread.h"
+#include "frame_clock.h"
+#include "framebuffer.h"
+#include "profiler.h"
+#include "frame_arena.h"
+#include "allocation_counter.h"
+#include "benchmark.h"
+#include "regression.h"
 
 
-int main(void)
+struct QuadVertex
+{
+    float position[2];
+    float uv[2];
+};
+
+using QuadLayout = GL_VertexLayout<GL_Attrib<float, 2>, GL_Attrib<float, 2>>;
+static_assert(QuadLayout::matches<QuadVertex, GL_VERTEX_MEMBER(QuadVertex, position), GL_VERTEX_MEMBER(QuadVertex, uv)>(),
+    "QuadLayout does not match QuadVertex");
+
+
+int main(int argc, char** argv)
 {
+    /**
+     * `--regression` checks the golden images and performance baselines, `--regression-record` re-records them;
+     * `--benchmark` runs the CPU benchmarks
+     */
+    bool run_regression = false;
+    bool run_benchmark = false;
+    RegressionOptions regression_options;
+    BenchmarkOptions benchmark_options;
+    for (int32_t arg_idx = 1; arg_idx < argc; arg_idx++)
+    {
+        std::string arg = argv[arg_idx];
+        if (arg == "--regression" || arg == "--regression-record")
+        {
+            run_regression = true;
+            regression_options.record = arg == "--regression-record";
+        }
+        else if (arg == "--benchmark")
+        {
+            run_benchmark = true;
+        }
+    }
+
+    /**
+     * Benchmark run; needs no window or GL context
+     */
+    if (run_benchmark)
+    {
+        JobSystem::get();
+        BenchmarkSuite benchmark_suite(benchmark_options);
+        benchmark_suite.run();
+        return 0;
+    }
+
     /**
      * Initialize program context (Window and OpenGL)
      */
@@ -28,6 +86,7 @@ int main(void)
         glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
         glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
         glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, run_regression ? GLFW_FALSE : GLFW_TRUE);
         if (!(window = glfwCreateWindow(800, 800, "Hello World", nullptr, nullptr)))
         {
             glfwTerminate();
@@ -45,23 +104,45 @@ int main(void)
             return -1;
         }
         fprintf(stdout, "INFO | GLEW > OpenGL initialized: v%s\n", glGetString(GL_VERSION));
+
+        // Start the job system workers; the main thread becomes worker 0 (GL moves to the render thread below)
+        JobSystem::get();
+    }
+
+    /**
+     * Regression run (offscreen); exits non-zero when any check fails
+     */
+    if (run_regression)
+    {
+        uint32_t failure_count;
+        {
+            RegressionSuite regression_suite(regression_options);
+            failure_count = regression_suite.run();
+        }
+        glfwTerminate();
+        return failure_count ? 1 : 0;
     }
 
     /**
      * Enter OpenGL rendering context
      */
     {
+        /**
+         * Hot Reload: created first, so every shader program and texture loaded below registers itself
+         */
+        HotReloader hot_reloader;
+
         /**
          * GL Buffers
          */
-        GL_VertexArray<float> vertex_array;
-        GL_DataBuffer<float> vertex_buffer;
-        GL_AttribArray attrib_array;
-        GL_DataBuffer<uint32_t> index_buffer;
+        GL_VertexFormatCache vertex_formats;
+        const GL_VertexFormat* vertex_format;
+        GL_MeshPool mesh_pool(QuadLayout::stride, 1024, 4096);
+        GL_MeshHandle quad_mesh;
         GL_Texture2D texture0, texture1;
         {
-            // VBO; configure vertex position buffer
-            const uint32_t v_component_count = 4;
+            // Vertex data
+            const uint32_t v_component_count = QuadLayout::stride / sizeof(float);
             const uint32_t v_count = 4;
             const uint32_t v_buffer_count = v_count * v_component_count;
             const float vertex_data[v_buffer_count] = {
@@ -70,16 +151,11 @@ int main(void)
                 -0.5f,  -0.5f,   0.0f, 0.0f,
                  0.5f,  -0.5f,   1.0f, 0.0f,
             };
-            vertex_buffer.set_data(GL_ARRAY_BUFFER, v_buffer_count, vertex_data, GL_STATIC_DRAW);
 
-            // VAA; configure VBO layout
-            attrib_array.push<float>(2, false);
-            attrib_array.push<float>(2, false);
+            // VAO; fetch the shared vertex format for the compile-time VBO layout
+            vertex_format = vertex_formats.get(QuadLayout::get_table());
 
-            // VAO; configure vertex array object
-            vertex_array.set_buffer(&attrib_array, &vertex_buffer);
-            
-            // EBO; configure index/element buffer
+            // Index data
             const uint32_t e_component_count = 3;
             const uint32_t e_count = 2;
             const uint32_t e_buffer_count = e_count * e_component_count;
@@ -87,12 +163,10 @@ int main(void)
                 0, 1, 2,
                 2, 1, 3,
             };
-            index_buffer.set_data(GL_ELEMENT_ARRAY_BUFFER, e_buffer_count, element_data, GL_STATIC_DRAW);
 
-            // Clear GL buffer state
-            index_buffer.unbind();
-            vertex_buffer.unbind();
-            vertex_array.unbind();
+            // Store the quad in the shared mesh pool
+            quad_mesh = mesh_pool.add_mesh(vertex_data, v_count, element_data, e_buffer_count);
+            ASSERT(quad_mesh != GL_MeshPool::INVALID_HANDLE);
         }
 
         /**
@@ -118,21 +192,177 @@ int main(void)
         }
 
         /**
-         * Render Loop
+         * Transforms
+         */
+        TransformSystem transforms;
+        TransformHandle root_transform, quad_transform;
+        Mat4 view_projection;
+        {
+            // The quad orbits and spins beneath a root node
+            root_transform = transforms.create();
+            quad_transform = transforms.create(root_transform);
+            transforms.set_position(quad_transform, 0.5f, 0.0f, 0.0f);
+
+            const float eye[3] = { 0.0f, 1.0f, 3.0f };
+            const float target[3] = { 0.0f, 0.0f, 0.0f };
+            const float up[3] = { 0.0f, 1.0f, 0.0f };
+            view_projection = mat4_multiply(mat4_perspective(0.785f, 1.0f, 0.1f, 100.0f), mat4_look_at(eye, target, up));
+        }
+
+        /**
+         * Scene
+         */
+        Scene scene;
+        RenderQueue render_queue;
+        {
+            scene.create(
+                TransformComponent{ quad_transform },
+                MeshComponent{ vertex_format, &mesh_pool, quad_mesh },
+                MaterialComponent{ &shader_program },
+                BoundsComponent{ { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.5f, 0.0f } });
+        }
+
+        /**
+         * Render Thread
          */
         GL_Renderer renderer;
-        while (!glfwWindowShouldClose(window))
+        GL_GpuProfiler gpu_profiler;
+        GL_UniformStats last_uniform_stats = {};
+        GL_RenderTargetPool render_target_pool;
+        GL_Framebuffer scene_framebuffer;
+        const uint32_t msaa_samples = 4;
         {
-            // Clear frame buffer
-            renderer.clear();
-            // Draw buffers
-            renderer.draw<float, uint32_t>(&vertex_array, &index_buffer, &shader_program);
-
-            // Swap frame buffers
-            GL_CALL(glfwSwapBuffers(window));
-            // Run GLFW event loop
-            GL_CALL(glfwPollEvents());
+            // Owns the GL context until it goes out of scope; runs one frame behind the simulation at most, so
+            // frame arena memory referenced by a packet outlives its replay
+            RenderThread render_thread(window, FRAME_ARENA_BUFFER_COUNT, [&](FramePacket& packet) {
+                // Read back GPU zones from a few frames ago
+                gpu_profiler.begin_frame();
+
+                // Swap in reloaded assets
+                hot_reloader.update();
+
+                // Render into multisampled targets sized to the window (skipped while minimized), then resolve
+                // into the back buffer; only the resolved colors are needed after that
+                if (packet.framebuffer_width && packet.framebuffer_height)
+                {
+                    PROFILE_ZONE("Render");
+                    PROFILE_GPU_ZONE(&gpu_profiler, "Frame");
+                    GL_RenderTarget* color_target = render_target_pool.acquire({ packet.framebuffer_width, packet.framebuffer_height, GL_RGBA8, msaa_samples, false });
+                    GL_RenderTarget* depth_target = render_target_pool.acquire({ packet.framebuffer_width, packet.framebuffer_height, GL_DEPTH24_STENCIL8, msaa_samples, false });
+                    scene_framebuffer.set_color_target(0, color_target);
+                    scene_framebuffer.set_depth_target(depth_target);
+                    scene_framebuffer.bind();
+
+                    renderer.clear();
+                    renderer.set_frame_time(packet.frame_time);
+                    renderer.submit(packet.command_lists.data(), (uint32_t)packet.command_lists.size());
+
+                    scene_framebuffer.resolve_to_default();
+                    scene_framebuffer.invalidate(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+                    render_target_pool.release(color_target);
+                    render_target_pool.release(depth_target);
+                }
+
+                // Swap frame buffers
+                {
+                    PROFILE_ZONE("Swap");
+                    GL_CALL(glfwSwapBuffers(window));
+                }
+
+                // Per-frame counters for the trace
+                const GL_RenderStats& render_stats = renderer.get_frame_stats();
+                Profiler::get().record_counter("Draw calls", render_stats.draw_calls);
+                Profiler::get().record_counter("State changes", render_stats.vertex_array_binds + render_stats.vertex_buffer_binds + render_stats.program_binds);
+                Profiler::get().record_counter("Uploaded bytes", Profiler::get().take_uploaded_bytes());
+
+                // Report uniform uploads whenever the per-frame pattern changes
+                const GL_UniformStats& uniform_stats = GL_ShaderProgram::get_frame_stats();
+                if (uniform_stats.uploads != last_uniform_stats.uploads || uniform_stats.redundant != last_uniform_stats.redundant)
+                {
+                    fprintf(stdout, "INFO | Uniforms > %u upload(s), %u redundant write(s) skipped this frame\n", uniform_stats.uploads, uniform_stats.redundant);
+                    last_uniform_stats = uniform_stats;
+                }
+                GL_ShaderProgram::reset_frame_stats();
+                renderer.reset_frame_stats();
+                render_target_pool.end_frame();
+                gl_call_stats_end_frame();
+            });
+
+            /**
+             * Simulation Loop
+             */
+            FrameClock frame_clock;
+            float spin = 0.0f, previous_spin = 0.0f;
+            uint64_t last_allocation_count = get_allocation_count();
+            uint64_t last_frame_allocations = 0;
+            Profiler::get().set_thread_name("Main");
+            while (!glfwWindowShouldClose(window))
+            {
+                // Wait for a free frame packet first, so the input below is as fresh as possible
+                FramePacket* packet;
+                {
+                    PROFILE_ZONE("Acquire packet");
+                    packet = render_thread.acquire_packet();
+                }
+
+                // The render thread is done with the frame that used this set of arenas
+                FrameAllocator::get().begin_frame();
+
+                // Run GLFW event loop
+                glfwPollEvents();
+                {
+                    int32_t framebuffer_width, framebuffer_height;
+                    glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+                    packet->framebuffer_width = (uint32_t)framebuffer_width;
+                    packet->framebuffer_height = (uint32_t)framebuffer_height;
+                }
+
+                PROFILE_ZONE("Simulate");
+
+                // Advance the simulation in fixed steps
+                frame_clock.tick();
+                while (frame_clock.step())
+                {
+                    previous_spin = spin;
+                    spin += (float)frame_clock.get_fixed_delta_time();
+                }
+
+                // Animate transforms, interpolating between the last two simulation steps
+                {
+                    const float y_axis[3] = { 0.0f, 1.0f, 0.0f };
+                    const float z_axis[3] = { 0.0f, 0.0f, 1.0f };
+                    float rotation[4];
+                    float time = previous_spin + (spin - previous_spin) * frame_clock.get_alpha();
+                    quat_from_axis_angle(y_axis, time * 0.5f, rotation);
+                    transforms.set_rotation(root_transform, rotation[0], rotation[1], rotation[2], rotation[3]);
+                    quat_from_axis_angle(z_axis, time, rotation);
+                    transforms.set_rotation(quad_transform, rotation[0], rotation[1], rotation[2], rotation[3]);
+                    transforms.update();
+                }
+
+                // Gather visible scene entities and record their draw commands on the job system
+                render_queue.gather(scene, transforms, Frustum::from_matrix(view_projection.m));
+                render_queue.record(transforms, view_projection, packet->command_lists);
+                packet->frame_time = frame_clock.get_time_block();
+
+                render_thread.submit_packet(packet);
+
+                // Report heap allocations (COUNT_ALLOCATIONS builds) whenever the per-frame count changes
+                uint64_t allocation_count = get_allocation_count();
+                if (allocation_count - last_allocation_count != last_frame_allocations)
+                {
+                    last_frame_allocations = allocation_count - last_allocation_count;
+                    fprintf(stdout, "INFO | Allocations > %llu heap allocation(s) this frame\n", (unsigned long long)last_frame_allocations);
+                }
+                last_allocation_count = allocation_count;
+            }
         }
+
+        // Export the last stretch of profiling data (chrome://tracing, ui.perfetto.dev)
+        Profiler::get().write_chrome_trace("./profile.json");
+
+        // Report the GL call overhead (GL_CALL_STATS builds)
+        gl_call_stats_report();
     }
 
     /**
@@ -0,0 +1,80 @@
+#include "mat4.h"
+#include <cmath>
+
+
+Mat4 mat4_identity()
+{
+    return { {
+        1.0f, 0.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f,
+        0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 1.0f } };
+}
+
+
+Mat4 mat4_from_trs(const float translation[3], const float rotation[4], const float scale[3])
+{
+    float x = rotation[0], y = rotation[1], z = rotation[2], w = rotation[3];
+    float xx = x * x, yy = y * y, zz = z * z;
+    float xy = x * y, xz = x * z, yz = y * z;
+    float wx = w * x, wy = w * y, wz = w * z;
+
+    return { {
+        (1.0f - 2.0f * (yy + zz)) * scale[0], 2.0f * (xy + wz) * scale[0], 2.0f * (xz - wy) * scale[0], 0.0f,
+        2.0f * (xy - wz) * scale[1], (1.0f - 2.0f * (xx + zz)) * scale[1], 2.0f * (yz + wx) * scale[1], 0.0f,
+        2.0f * (xz + wy) * scale[2], 2.0f * (yz - wx) * scale[2], (1.0f - 2.0f * (xx + yy)) * scale[2], 0.0f,
+        translation[0], translation[1], translation[2], 1.0f } };
+}
+
+
+Mat4 mat4_perspective(float fov_y, float aspect_ratio, float near_plane, float far_plane)
+{
+    float focal_length = 1.0f / std::tan(fov_y * 0.5f);
+    float depth_range = near_plane - far_plane;
+
+    return { {
+        focal_length / aspect_ratio, 0.0f, 0.0f, 0.0f,
+        0.0f, focal_length, 0.0f, 0.0f,
+        0.0f, 0.0f, (far_plane + near_plane) / depth_range, -1.0f,
+        0.0f, 0.0f, 2.0f * far_plane * near_plane / depth_range, 0.0f } };
+}
+
+
+Mat4 mat4_look_at(const float eye[3], const float target[3], const float up[3])
+{
+    auto normalize = [](float v[3]) {
+        float length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        for (uint32_t axis = 0; axis < 3; axis++)
+            v[axis] /= length;
+    };
+    auto cross = [](const float a[3], const float b[3], float result[3]) {
+        result[0] = a[1] * b[2] - a[2] * b[1];
+        result[1] = a[2] * b[0] - a[0] * b[2];
+        result[2] = a[0] * b[1] - a[1] * b[0];
+    };
+
+    float forward[3] = { target[0] - eye[0], target[1] - eye[1], target[2] - eye[2] };
+    normalize(forward);
+    float right[3];
+    cross(forward, up, right);
+    normalize(right);
+    float camera_up[3];
+    cross(right, forward, camera_up);
+
+    auto dot = [](const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; };
+    return { {
+        right[0], camera_up[0], -forward[0], 0.0f,
+        right[1], camera_up[1], -forward[1], 0.0f,
+        right[2], camera_up[2], -forward[2], 0.0f,
+        -dot(right, eye), -dot(camera_up, eye), dot(forward, eye), 1.0f } };
+}
+
+
+void quat_from_axis_angle(const float axis[3], float angle, float rotation[4])
+{
+    float half_sin = std::sin(angle * 0.5f);
+    rotation[0] = axis[0] * half_sin;
+    rotation[1] = axis[1] * half_sin;
+    rotation[2] = axis[2] * half_sin;
+    rotation[3] = std::cos(angle * 0.5f);
+}
@@ -0,0 +1,396 @@
+#include "mesh_optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "gl_utils.h"
+#include "index_buffer.h"
+
+
+static const uint32_t FORSYTH_CACHE_SIZE = 32;
+static const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+
+MeshCacheStats analyze_vertex_cache(const uint32_t* indices, size_t index_count, uint32_t vertex_count, uint32_t cache_size)
+{
+    // FIFO cache; a vertex is cached if it was inserted within the last `cache_size` misses
+    std::vector<uint32_t> cache_timestamps(vertex_count, 0);
+    std::vector<bool> referenced(vertex_count, false);
+    uint32_t timestamp = cache_size + 1;
+    uint32_t misses = 0;
+    uint32_t referenced_count = 0;
+
+    for (size_t idx = 0; idx < index_count; idx++)
+    {
+        uint32_t vertex = indices[idx];
+        if (timestamp - cache_timestamps[vertex] > cache_size)
+        {
+            cache_timestamps[vertex] = timestamp++;
+            misses++;
+        }
+        if (!referenced[vertex])
+        {
+            referenced[vertex] = true;
+            referenced_count++;
+        }
+    }
+
+    size_t triangle_count = index_count / 3;
+    return {
+        triangle_count ? (float)misses / triangle_count : 0.0f,
+        referenced_count ? (float)misses / referenced_count : 0.0f };
+}
+
+
+void deduplicate_vertices(MeshData& mesh_data)
+{
+    const std::vector<MeshVertex>& vertices = mesh_data.vertices;
+    uint32_t vertex_count = (uint32_t)vertices.size();
+
+    auto hash_vertex = [](const MeshVertex& vertex) {
+        // FNV-1a over the raw vertex bytes
+        const uint8_t* bytes = (const uint8_t*)&vertex;
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t idx = 0; idx < sizeof(MeshVertex); idx++)
+        {
+            hash ^= bytes[idx];
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    };
+
+    // Open addressing hash index of unique vertices
+    size_t table_size = 16;
+    while (table_size < (size_t)vertex_count * 2)
+        table_size *= 2;
+    std::vector<uint32_t> table(table_size, UINT32_MAX);
+
+    std::vector<uint32_t> remap(vertex_count);
+    std::vector<MeshVertex> unique_vertices;
+    unique_vertices.reserve(vertex_count);
+    for (uint32_t vertex_idx = 0; vertex_idx < vertex_count; vertex_idx++)
+    {
+        const MeshVertex& vertex = vertices[vertex_idx];
+        size_t slot = (size_t)hash_vertex(vertex) & (table_size - 1);
+        while (table[slot] != UINT32_MAX && memcmp(&unique_vertices[table[slot]], &vertex, sizeof(MeshVertex)))
+            slot = (slot + 1) & (table_size - 1);
+
+        if (table[slot] == UINT32_MAX)
+        {
+            table[slot] = (uint32_t)unique_vertices.size();
+            unique_vertices.push_back(vertex);
+        }
+        remap[vertex_idx] = table[slot];
+    }
+
+    for (uint32_t& index : mesh_data.indices)
+        index = remap[index];
+    mesh_data.vertices.swap(unique_vertices);
+}
+
+
+static float forsyth_vertex_score(int32_t cache_position, uint32_t remaining_valence)
+{
+    if (!remaining_valence)
+        return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0)
+    {
+        if (cache_position < 3)
+        {
+            // The most recent triangle's vertices get a fixed score so the algorithm doesn't simply
+            // re-use the same triangle's edges
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        }
+        else
+        {
+            float scaler = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cache_position - 3) * scaler, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+
+    // Boost vertices with few triangles left so they get finished off
+    score += FORSYTH_VALENCE_BOOST_SCALE * std::pow((float)remaining_valence, -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+
+void optimize_vertex_cache(std::vector<uint32_t>& indices, uint32_t vertex_count)
+{
+    uint32_t triangle_count = (uint32_t)(indices.size() / 3);
+    if (!triangle_count)
+        return;
+
+    // Vertex -> triangle adjacency (CSR)
+    std::vector<uint32_t> valence(vertex_count, 0);
+    for (uint32_t index : indices)
+        valence[index]++;
+
+    std::vector<uint32_t> adjacency_offsets(vertex_count + 1, 0);
+    for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        adjacency_offsets[vertex + 1] = adjacency_offsets[vertex] + valence[vertex];
+
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> fill_offsets(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+    for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        for (uint32_t corner = 0; corner < 3; corner++)
+            adjacency[fill_offsets[indices[triangle * 3 + corner]]++] = triangle;
+    }
+
+    // Initial scores
+    std::vector<int32_t> cache_positions(vertex_count, -1);
+    std::vector<float> vertex_scores(vertex_count);
+    for (uint32_t vertex = 0; vertex < vertex_count; vertex++)
+        vertex_scores[vertex] = forsyth_vertex_score(-1, valence[vertex]);
+
+    std::vector<float> triangle_scores(triangle_count);
+    for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        triangle_scores[triangle] =
+            vertex_scores[indices[triangle * 3 + 0]] +
+            vertex_scores[indices[triangle * 3 + 1]] +
+            vertex_scores[indices[triangle * 3 + 2]];
+    }
+
+    std::vector<bool> emitted(triangle_count, false);
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    uint32_t cache[FORSYTH_CACHE_SIZE + 3];
+    uint32_t cache_count = 0;
+    uint32_t next_input_triangle = 0;
+    int64_t best_triangle = -1;
+
+    for (uint32_t emitted_count = 0; emitted_count < triangle_count; emitted_count++)
+    {
+        // Fall back to the next unemitted triangle in input order when the cache has no candidates
+        if (best_triangle < 0)
+        {
+            while (emitted[next_input_triangle])
+                next_input_triangle++;
+            best_triangle = next_input_triangle;
+        }
+
+        uint32_t triangle = (uint32_t)best_triangle;
+        const uint32_t* triangle_indices = &indices[triangle * 3];
+        emitted[triangle] = true;
+        output.insert(output.end(), triangle_indices, triangle_indices + 3);
+
+        // Remove the triangle from its vertices' adjacency
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t vertex = triangle_indices[corner];
+            uint32_t* begin = &adjacency[adjacency_offsets[vertex]];
+            uint32_t* end = begin + valence[vertex];
+            *std::find(begin, end, triangle) = *(end - 1);
+            valence[vertex]--;
+        }
+
+        // Push the triangle's vertices to the front of the LRU cache
+        uint32_t new_cache[FORSYTH_CACHE_SIZE + 3];
+        uint32_t new_cache_count = 0;
+        for (uint32_t corner = 0; corner < 3; corner++)
+            new_cache[new_cache_count++] = triangle_indices[corner];
+        for (uint32_t cache_idx = 0; cache_idx < cache_count; cache_idx++)
+        {
+            uint32_t vertex = cache[cache_idx];
+            if (vertex != triangle_indices[0] && vertex != triangle_indices[1] && vertex != triangle_indices[2])
+                new_cache[new_cache_count++] = vertex;
+        }
+
+        // Update scores of every vertex whose cache position changed, and their triangles
+        for (uint32_t cache_idx = 0; cache_idx < new_cache_count; cache_idx++)
+        {
+            uint32_t vertex = new_cache[cache_idx];
+            cache_positions[vertex] = cache_idx < FORSYTH_CACHE_SIZE ? (int32_t)cache_idx : -1;
+
+            float score = forsyth_vertex_score(cache_positions[vertex], valence[vertex]);
+            float score_delta = score - vertex_scores[vertex];
+            vertex_scores[vertex] = score;
+
+            const uint32_t* adjacent = &adjacency[adjacency_offsets[vertex]];
+            for (uint32_t adjacent_idx = 0; adjacent_idx < valence[vertex]; adjacent_idx++)
+                triangle_scores[adjacent[adjacent_idx]] += score_delta;
+        }
+
+        // Only triangles touching the cache can have changed, so the best candidate is among them
+        best_triangle = -1;
+        float best_score = 0.0f;
+        for (uint32_t cache_idx = 0; cache_idx < new_cache_count && cache_idx < FORSYTH_CACHE_SIZE; cache_idx++)
+        {
+            uint32_t vertex = new_cache[cache_idx];
+            const uint32_t* adjacent = &adjacency[adjacency_offsets[vertex]];
+            for (uint32_t adjacent_idx = 0; adjacent_idx < valence[vertex]; adjacent_idx++)
+            {
+                uint32_t adjacent_triangle = adjacent[adjacent_idx];
+                if (triangle_scores[adjacent_triangle] > best_score)
+                {
+                    best_score = triangle_scores[adjacent_triangle];
+                    best_triangle = adjacent_triangle;
+                }
+            }
+        }
+
+        cache_count = std::min(new_cache_count, FORSYTH_CACHE_SIZE);
+        std::copy(new_cache, new_cache + cache_count, cache);
+    }
+
+    indices.swap(output);
+}
+
+
+void optimize_overdraw(std::vector<uint32_t>& indices, const std::vector<MeshVertex>& vertices, uint32_t cache_size)
+{
+    uint32_t triangle_count = (uint32_t)(indices.size() / 3);
+    if (triangle_count < 2)
+        return;
+
+    // Split into clusters wherever a triangle misses the cache on all three vertices
+    std::vector<uint32_t> cluster_starts;
+    std::vector<uint32_t> cache_timestamps(vertices.size(), 0);
+    uint32_t timestamp = cache_size + 1;
+    for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        uint32_t misses = 0;
+        for (uint32_t corner = 0; corner < 3; corner++)
+        {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if (timestamp - cache_timestamps[vertex] > cache_size)
+            {
+                cache_timestamps[vertex] = timestamp++;
+                misses++;
+            }
+        }
+        if (triangle == 0 || misses == 3)
+            cluster_starts.push_back(triangle);
+    }
+    cluster_starts.push_back(triangle_count);
+
+    // Mesh centroid (area weighted)
+    auto triangle_vectors = [&](uint32_t triangle, float centroid[3], float normal[3]) {
+        const float* p0 = vertices[indices[triangle * 3 + 0]].position;
+        const float* p1 = vertices[indices[triangle * 3 + 1]].position;
+        const float* p2 = vertices[indices[triangle * 3 + 2]].position;
+        float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+        float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+        normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        for (uint32_t axis = 0; axis < 3; axis++)
+            centroid[axis] = (p0[axis] + p1[axis] + p2[axis]) / 3.0f;
+    };
+
+    float mesh_centroid[3] = { 0.0f, 0.0f, 0.0f };
+    float mesh_area = 0.0f;
+    for (uint32_t triangle = 0; triangle < triangle_count; triangle++)
+    {
+        float centroid[3], normal[3];
+        triangle_vectors(triangle, centroid, normal);
+        float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (uint32_t axis = 0; axis < 3; axis++)
+            mesh_centroid[axis] += centroid[axis] * area;
+        mesh_area += area;
+    }
+    for (uint32_t axis = 0; axis < 3; axis++)
+        mesh_centroid[axis] = mesh_area > 0.0f ? mesh_centroid[axis] / mesh_area : 0.0f;
+
+    // Sort clusters by how much they face away from the centre; outer, outward facing clusters first
+    uint32_t cluster_count = (uint32_t)cluster_starts.size() - 1;
+    std::vector<float> cluster_sort_keys(cluster_count);
+    for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+    {
+        float cluster_centroid[3] = { 0.0f, 0.0f, 0.0f };
+        float cluster_normal[3] = { 0.0f, 0.0f, 0.0f };
+        float cluster_area = 0.0f;
+        for (uint32_t triangle = cluster_starts[cluster]; triangle < cluster_starts[cluster + 1]; triangle++)
+        {
+            float centroid[3], normal[3];
+            triangle_vectors(triangle, centroid, normal);
+            float area = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                cluster_centroid[axis] += centroid[axis] * area;
+                cluster_normal[axis] += normal[axis];
+            }
+            cluster_area += area;
+        }
+
+        float normal_length = std::sqrt(cluster_normal[0] * cluster_normal[0] + cluster_normal[1] * cluster_normal[1] + cluster_normal[2] * cluster_normal[2]);
+        float sort_key = 0.0f;
+        if (cluster_area > 0.0f && normal_length > 0.0f)
+        {
+            for (uint32_t axis = 0; axis < 3; axis++)
+                sort_key += (cluster_centroid[axis] / cluster_area - mesh_centroid[axis]) * (cluster_normal[axis] / normal_length);
+        }
+        cluster_sort_keys[cluster] = sort_key;
+    }
+
+    std::vector<uint32_t> cluster_order(cluster_count);
+    for (uint32_t cluster = 0; cluster < cluster_count; cluster++)
+        cluster_order[cluster] = cluster;
+    std::stable_sort(cluster_order.begin(), cluster_order.end(), [&cluster_sort_keys](uint32_t lhs, uint32_t rhs) {
+        return cluster_sort_keys[lhs] > cluster_sort_keys[rhs];
+    });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (uint32_t cluster : cluster_order)
+        output.insert(output.end(), indices.begin() + cluster_starts[cluster] * 3, indices.begin() + cluster_starts[cluster + 1] * 3);
+    indices.swap(output);
+}
+
+
+void optimize_vertex_fetch(MeshData& mesh_data)
+{
+    std::vector<uint32_t> remap(mesh_data.vertices.size(), UINT32_MAX);
+    std::vector<MeshVertex> ordered_vertices;
+    ordered_vertices.reserve(mesh_data.vertices.size());
+
+    for (uint32_t& index : mesh_data.indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = (uint32_t)ordered_vertices.size();
+            ordered_vertices.push_back(mesh_data.vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    mesh_data.vertices.swap(ordered_vertices);
+}
+
+
+MeshOptimizeReport optimize_mesh(MeshData& mesh_data)
+{
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    MeshOptimizeReport report = {};
+    report.vertex_count_before = (uint32_t)mesh_data.vertices.size();
+    report.cache_before = analyze_vertex_cache(mesh_data.indices.data(), mesh_data.indices.size(), report.vertex_count_before);
+
+    deduplicate_vertices(mesh_data);
+    optimize_vertex_cache(mesh_data.indices, (uint32_t)mesh_data.vertices.size());
+    optimize_overdraw(mesh_data.indices, mesh_data.vertices);
+    optimize_vertex_fetch(mesh_data);
+
+    report.vertex_count_after = (uint32_t)mesh_data.vertices.size();
+    report.cache_after = analyze_vertex_cache(mesh_data.indices.data(), mesh_data.indices.size(), report.vertex_count_after);
+    report.index_gl_type = GL_IndexBuffer::select_index_type(report.vertex_count_after);
+    report.optimize_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    fprintf(stdout, "INFO | MeshOptimizer > %zu triangles, %u -> %u vertices; ACMR %.3f -> %.3f, ATVR %.3f -> %.3f; %zu-bit indices (%.2fms)\n",
+        mesh_data.indices.size() / 3,
+        report.vertex_count_before, report.vertex_count_after,
+        report.cache_before.acmr, report.cache_after.acmr,
+        report.cache_before.atvr, report.cache_after.atvr,
+        get_gl_type_size(report.index_gl_type) * 8,
+        report.optimize_ms);
+
+    return report;
+}
@@ -0,0 +1,191 @@
+#include "mesh_pool.h"
+#include "renderer.h"
+#include <algorithm>
+#include <cstdio>
+#include "profiler.h"
+
+
+GL_MeshPool::GL_MeshPool(uint32_t vertex_stride, uint32_t vertex_capacity, uint32_t index_capacity) :
+    m_vertex_stride(vertex_stride), m_vertex_buffer_id(0), m_index_buffer_id(0)
+{
+    ASSERT(vertex_stride);
+    m_vertex_buffer_id = create_buffer(vertex_capacity * vertex_stride);
+    m_index_buffer_id = create_buffer(index_capacity * (uint32_t)sizeof(uint32_t));
+    m_vertex_allocator.reset(vertex_capacity);
+    m_index_allocator.reset(index_capacity);
+}
+
+
+GL_MeshPool::~GL_MeshPool()
+{
+    GL_CALL(glDeleteBuffers(1, &m_vertex_buffer_id));
+    GL_CALL(glDeleteBuffers(1, &m_index_buffer_id));
+}
+
+
+uint32_t GL_MeshPool::create_buffer(uint32_t buffer_size)
+{
+    uint32_t buffer_id = 0;
+    GL_CALL(glGenBuffers(1, &buffer_id));
+    ASSERT(buffer_id);
+
+    /**
+     * NOTE: the buffers are only ever written through `glBufferSubData` and `glCopyBufferSubData`, so
+     * immutable storage only needs `GL_DYNAMIC_STORAGE_BIT`
+     */
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_id));
+    if (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage)
+    {
+        GL_CALL(glBufferStorage(GL_COPY_WRITE_BUFFER, std::max(buffer_size, 1u), nullptr, GL_DYNAMIC_STORAGE_BIT));
+    }
+    else
+    {
+        GL_CALL(glBufferData(GL_COPY_WRITE_BUFFER, std::max(buffer_size, 1u), nullptr, GL_STATIC_DRAW));
+    }
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+    return buffer_id;
+}
+
+
+void GL_MeshPool::reallocate(uint32_t vertex_capacity, uint32_t index_capacity)
+{
+    /**
+     * Copy every live mesh, tightly packed in handle order, into freshly allocated buffers; indices are
+     * relative to the base vertex so only the ranges need updating
+     */
+    uint32_t vertex_buffer_id = create_buffer(vertex_capacity * m_vertex_stride);
+    uint32_t index_buffer_id = create_buffer(index_capacity * (uint32_t)sizeof(uint32_t));
+
+    m_vertex_allocator.reset(vertex_capacity);
+    m_index_allocator.reset(index_capacity);
+
+    for (GL_MeshHandle mesh_handle = 0; mesh_handle < (GL_MeshHandle)m_meshes.size(); mesh_handle++)
+    {
+        if (!m_mesh_alive[mesh_handle])
+            continue;
+
+        GL_MeshRange& mesh_range = m_meshes[mesh_handle];
+        uint32_t base_vertex = m_vertex_allocator.allocate(mesh_range.vertex_count);
+        uint32_t first_index = m_index_allocator.allocate(mesh_range.index_count);
+        ASSERT(base_vertex != RangeAllocator::INVALID_OFFSET && first_index != RangeAllocator::INVALID_OFFSET);
+
+        GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, m_vertex_buffer_id));
+        GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, vertex_buffer_id));
+        GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+            (GLintptr)mesh_range.base_vertex * m_vertex_stride,
+            (GLintptr)base_vertex * m_vertex_stride,
+            (GLsizeiptr)mesh_range.vertex_count * m_vertex_stride));
+
+        GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, m_index_buffer_id));
+        GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, index_buffer_id));
+        GL_CALL(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+            (GLintptr)mesh_range.first_index * sizeof(uint32_t),
+            (GLintptr)first_index * sizeof(uint32_t),
+            (GLsizeiptr)mesh_range.index_count * sizeof(uint32_t)));
+
+        mesh_range.base_vertex = base_vertex;
+        mesh_range.first_index = first_index;
+    }
+    GL_CALL(glBindBuffer(GL_COPY_READ_BUFFER, 0));
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+
+    GL_CALL(glDeleteBuffers(1, &m_vertex_buffer_id));
+    GL_CALL(glDeleteBuffers(1, &m_index_buffer_id));
+    m_vertex_buffer_id = vertex_buffer_id;
+    m_index_buffer_id = index_buffer_id;
+}
+
+
+GL_MeshHandle GL_MeshPool::add_mesh(const void* vertex_data, uint32_t vertex_count, const uint32_t* index_data, uint32_t index_count)
+{
+    uint32_t base_vertex = m_vertex_allocator.allocate(vertex_count);
+    uint32_t first_index = m_index_allocator.allocate(index_count);
+    if (base_vertex == RangeAllocator::INVALID_OFFSET || first_index == RangeAllocator::INVALID_OFFSET)
+    {
+        m_vertex_allocator.free(base_vertex, vertex_count);
+        m_index_allocator.free(first_index, index_count);
+        return INVALID_HANDLE;
+    }
+
+    // Upload mesh data into its ranges
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertex_buffer_id));
+    GL_CALL(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)base_vertex * m_vertex_stride, (GLsizeiptr)vertex_count * m_vertex_stride, vertex_data));
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, m_index_buffer_id));
+    GL_CALL(glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)first_index * sizeof(uint32_t), (GLsizeiptr)index_count * sizeof(uint32_t), index_data));
+    GL_CALL(glBindBuffer(GL_COPY_WRITE_BUFFER, 0));
+    Profiler::get().count_upload((uint64_t)vertex_count * m_vertex_stride + (uint64_t)index_count * sizeof(uint32_t));
+
+    // Assign a handle (reusing removed ones)
+    GL_MeshHandle mesh_handle;
+    if (!m_free_handles.empty())
+    {
+        mesh_handle = m_free_handles.back();
+        m_free_handles.pop_back();
+    }
+    else
+    {
+        mesh_handle = (GL_MeshHandle)m_meshes.size();
+        m_meshes.push_back({});
+        m_mesh_alive.push_back(false);
+    }
+    m_meshes[mesh_handle] = { base_vertex, vertex_count, first_index, index_count };
+    m_mesh_alive[mesh_handle] = true;
+
+    return mesh_handle;
+}
+
+
+void GL_MeshPool::remove_mesh(GL_MeshHandle mesh_handle)
+{
+    if (mesh_handle >= m_meshes.size() || !m_mesh_alive[mesh_handle])
+        return;
+
+    const GL_MeshRange& mesh_range = m_meshes[mesh_handle];
+    m_vertex_allocator.free(mesh_range.base_vertex, mesh_range.vertex_count);
+    m_index_allocator.free(mesh_range.first_index, mesh_range.index_count);
+
+    m_mesh_alive[mesh_handle] = false;
+    m_free_handles.push_back(mesh_handle);
+}
+
+
+void GL_MeshPool::grow(uint32_t vertex_count, uint32_t index_count)
+{
+    uint32_t vertex_capacity = std::max(m_vertex_allocator.get_capacity(), 1u);
+    uint32_t index_capacity = std::max(m_index_allocator.get_capacity(), 1u);
+    while (vertex_capacity - m_vertex_allocator.get_used() < vertex_count)
+        vertex_capacity *= 2;
+    while (index_capacity - m_index_allocator.get_used() < index_count)
+        index_capacity *= 2;
+
+    fprintf(stdout, "INFO | MeshPool > Growing to %u vertices, %u indices\n", vertex_capacity, index_capacity);
+    reallocate(vertex_capacity, index_capacity);
+}
+
+
+void GL_MeshPool::defragment()
+{
+    reallocate(m_vertex_allocator.get_capacity(), m_index_allocator.get_capacity());
+}
+
+
+GL_MeshPoolStats GL_MeshPool::get_stats() const
+{
+    return {
+        (uint32_t)(m_meshes.size() - m_free_handles.size()),
+        m_vertex_allocator.get_used(), m_vertex_allocator.get_capacity(),
+        m_index_allocator.get_used(), m_index_allocator.get_capacity(),
+        m_vertex_allocator.get_fragmentation(),
+        m_index_allocator.get_fragmentation() };
+}
+
+
+void GL_MeshPool::print_stats() const
+{
+    GL_MeshPoolStats stats = get_stats();
+    fprintf(stdout, "INFO | MeshPool > %u mesh(es); vertices %u/%u (%.1f%% used, %.1f%% fragmented); indices %u/%u (%.1f%% used, %.1f%% fragmented)\n",
+        stats.mesh_count,
+        stats.vertex_used, stats.vertex_capacity, 100.0f * stats.vertex_used / std::max(stats.vertex_capacity, 1u), 100.0f * stats.vertex_fragmentation,
+        stats.index_used, stats.index_capacity, 100.0f * stats.index_used / std::max(stats.index_capacity, 1u), 100.0f * stats.index_fragmentation);
+}
@@ -0,0 +1,472 @@
+#include "obj_loader.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include "file_utils.h"
+#include "job_system.h"
+
+
+static const int32_t OBJ_MISSING = INT32_MIN;
+static const size_t OBJ_MIN_CHUNK_SIZE = 1 << 20;
+
+static const uint8_t OBJ_RELATIVE_POSITION = 1 << 0;
+static const uint8_t OBJ_RELATIVE_UV = 1 << 1;
+static const uint8_t OBJ_RELATIVE_NORMAL = 1 << 2;
+
+
+struct ObjCorner
+{
+    int32_t position, uv, normal;
+    // `OBJ_RELATIVE_*` bits of the indices that are still relative to their chunk (only while parsing)
+    uint8_t relative;
+};
+
+
+struct ObjChunk
+{
+    const char* begin;
+    const char* end;
+    std::vector<float> positions, uvs, normals;
+    std::vector<ObjCorner> corners;
+    uint32_t position_base, uv_base, normal_base;
+    bool valid;
+};
+
+
+template<typename F>
+static void parallel_ranges(uint32_t thread_count, size_t count, F&& range_function)
+{
+    if (thread_count <= 1 || count < thread_count)
+    {
+        range_function(0, count, 0u);
+        return;
+    }
+
+    // One job per range, so `thread_count` ranges run on the shared job system
+    size_t range_size = (count + thread_count - 1) / thread_count;
+    JobSystem::get().parallel_for(thread_count, [&range_function, count, range_size](size_t first_range, size_t last_range) {
+        for (size_t range_idx = first_range; range_idx < last_range; range_idx++)
+        {
+            size_t begin = std::min(count, range_idx * range_size);
+            size_t end = std::min(count, begin + range_size);
+            range_function(begin, end, (uint32_t)range_idx);
+        }
+    });
+}
+
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+
+static inline const char* skip_spaces(const char* ptr, const char* end)
+{
+    while (ptr < end && is_space(*ptr))
+        ptr++;
+    return ptr;
+}
+
+
+static inline const char* skip_line(const char* ptr, const char* end)
+{
+    while (ptr < end && *ptr != '\n')
+        ptr++;
+    return ptr < end ? ptr + 1 : end;
+}
+
+
+static const char* parse_float(const char* ptr, const char* end, float& value)
+{
+    static const double powers_of_10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    ptr = skip_spaces(ptr, end);
+
+    bool negative = false;
+    if (ptr < end && (*ptr == '-' || *ptr == '+'))
+        negative = *ptr++ == '-';
+
+    // Accumulate up to 19 significant digits exactly, tracking the decimal exponent separately
+    uint64_t mantissa = 0;
+    int32_t exponent = 0;
+    uint32_t digit_count = 0;
+    for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ptr++)
+    {
+        if (digit_count < 19)
+        {
+            mantissa = mantissa * 10 + (*ptr - '0');
+            digit_count += mantissa != 0;
+        }
+        else
+        {
+            exponent++;
+        }
+    }
+    if (ptr < end && *ptr == '.')
+    {
+        for (ptr++; ptr < end && *ptr >= '0' && *ptr <= '9'; ptr++)
+        {
+            if (digit_count < 19)
+            {
+                mantissa = mantissa * 10 + (*ptr - '0');
+                digit_count += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (ptr < end && (*ptr == 'e' || *ptr == 'E'))
+    {
+        ptr++;
+        bool negative_exponent = false;
+        if (ptr < end && (*ptr == '-' || *ptr == '+'))
+            negative_exponent = *ptr++ == '-';
+
+        int32_t explicit_exponent = 0;
+        for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ptr++)
+            explicit_exponent = std::min(explicit_exponent * 10 + (*ptr - '0'), 9999);
+        exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+    }
+
+    double result = (double)mantissa;
+    if (exponent < 0)
+        result = exponent >= -22 ? result / powers_of_10[-exponent] : result * std::pow(10.0, exponent);
+    else if (exponent > 0)
+        result = exponent <= 22 ? result * powers_of_10[exponent] : result * std::pow(10.0, exponent);
+
+    value = (float)(negative ? -result : result);
+    return ptr;
+}
+
+
+static const char* parse_index(const char* ptr, const char* end, uint32_t local_count, int32_t& index, bool& relative)
+{
+    bool negative = false;
+    if (ptr < end && *ptr == '-')
+    {
+        negative = true;
+        ptr++;
+    }
+
+    int64_t value = 0;
+    const char* digits_begin = ptr;
+    for (; ptr < end && *ptr >= '0' && *ptr <= '9'; ptr++)
+        value = std::min<int64_t>(value * 10 + (*ptr - '0'), INT32_MAX);
+
+    relative = false;
+    if (ptr == digits_begin || value == 0)
+    {
+        index = OBJ_MISSING;
+    }
+    else if (negative)
+    {
+        /**
+         * NOTE: relative indices count back from the most recent element *in this chunk*; they're stored as
+         * the offset from the chunk's first element, which is negative when they reach into an earlier
+         * chunk, and rebased once the element counts of earlier chunks are known
+         */
+        index = (int32_t)((int64_t)local_count - value);
+        relative = true;
+    }
+    else
+    {
+        index = (int32_t)(value - 1);
+    }
+
+    return ptr;
+}
+
+
+static const char* parse_corner(const char* ptr, const char* end, const ObjChunk& chunk, ObjCorner& corner)
+{
+    corner = { OBJ_MISSING, OBJ_MISSING, OBJ_MISSING, 0 };
+
+    bool relative;
+    ptr = parse_index(ptr, end, (uint32_t)(chunk.positions.size() / 3), corner.position, relative);
+    corner.relative |= relative ? OBJ_RELATIVE_POSITION : 0;
+    if (ptr < end && *ptr == '/')
+    {
+        ptr++;
+        if (ptr < end && *ptr != '/')
+        {
+            ptr = parse_index(ptr, end, (uint32_t)(chunk.uvs.size() / 2), corner.uv, relative);
+            corner.relative |= relative ? OBJ_RELATIVE_UV : 0;
+        }
+        if (ptr < end && *ptr == '/')
+        {
+            ptr = parse_index(ptr + 1, end, (uint32_t)(chunk.normals.size() / 3), corner.normal, relative);
+            corner.relative |= relative ? OBJ_RELATIVE_NORMAL : 0;
+        }
+    }
+
+    // Skip anything unparseable up to the next separator
+    while (ptr < end && !is_space(*ptr) && *ptr != '\n')
+        ptr++;
+
+    return ptr;
+}
+
+
+static void parse_chunk(ObjChunk& chunk)
+{
+    const char* ptr = chunk.begin;
+    const char* end = chunk.end;
+    float values[3];
+
+    while (ptr < end)
+    {
+        ptr = skip_spaces(ptr, end);
+        if (ptr + 1 >= end)
+            break;
+
+        if (ptr[0] == 'v' && is_space(ptr[1]))
+        {
+            ptr += 2;
+            for (float& value : values)
+                ptr = parse_float(ptr, end, value);
+            chunk.positions.insert(chunk.positions.end(), values, values + 3);
+        }
+        else if (ptr[0] == 'v' && ptr[1] == 't' && ptr + 2 < end && is_space(ptr[2]))
+        {
+            ptr = parse_float(ptr + 3, end, values[0]);
+            ptr = parse_float(ptr, end, values[1]);
+            chunk.uvs.insert(chunk.uvs.end(), values, values + 2);
+        }
+        else if (ptr[0] == 'v' && ptr[1] == 'n' && ptr + 2 < end && is_space(ptr[2]))
+        {
+            ptr += 3;
+            for (float& value : values)
+                ptr = parse_float(ptr, end, value);
+            chunk.normals.insert(chunk.normals.end(), values, values + 3);
+        }
+        else if (ptr[0] == 'f' && is_space(ptr[1]))
+        {
+            // Fan-triangulate the polygon
+            ObjCorner first_corner, previous_corner, corner;
+            uint32_t corner_count = 0;
+            ptr += 2;
+            while (true)
+            {
+                ptr = skip_spaces(ptr, end);
+                if (ptr >= end || *ptr == '\n' || *ptr == '#')
+                    break;
+
+                ptr = parse_corner(ptr, end, chunk, corner);
+                if (corner.position == OBJ_MISSING)
+                {
+                    chunk.valid = false;
+                    continue;
+                }
+
+                if (corner_count == 0)
+                    first_corner = corner;
+                else if (corner_count >= 2)
+                {
+                    chunk.corners.push_back(first_corner);
+                    chunk.corners.push_back(previous_corner);
+                    chunk.corners.push_back(corner);
+                }
+                previous_corner = corner;
+                corner_count++;
+            }
+        }
+
+        ptr = skip_line(ptr, end);
+    }
+}
+
+
+// Relative indices that still point before the first element of the file become missing
+static inline int32_t rebase_index(int32_t index, bool relative, uint32_t chunk_base)
+{
+    if (index == OBJ_MISSING || !relative)
+        return index;
+    int64_t rebased_index = (int64_t)chunk_base + index;
+    return rebased_index < 0 ? OBJ_MISSING : (int32_t)rebased_index;
+}
+
+
+static inline uint64_t hash_corner(const ObjCorner& corner)
+{
+    uint64_t hash = (uint32_t)corner.position * 0x9e3779b97f4a7c15ull;
+    hash ^= ((uint32_t)corner.uv + 0x632be59bd9b4e019ull + (hash << 6) + (hash >> 2)) * 0xbf58476d1ce4e5b9ull;
+    hash ^= ((uint32_t)corner.normal + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+
+static inline bool operator==(const ObjCorner& lhs, const ObjCorner& rhs)
+{
+    return lhs.position == rhs.position && lhs.uv == rhs.uv && lhs.normal == rhs.normal;
+}
+
+
+bool load_obj(const std::string& file_path, MeshData& mesh_data, uint32_t thread_count)
+{
+    MappedFile file(file_path);
+    if (!file.is_open())
+        return false;
+
+    const char* file_begin = (const char*)file.get_data();
+    const char* file_end = file_begin + file.get_size();
+
+    if (!thread_count)
+        thread_count = JobSystem::get().get_worker_count();
+    thread_count = (uint32_t)std::clamp<size_t>(file.get_size() / OBJ_MIN_CHUNK_SIZE, 1, thread_count);
+
+    // Split the file into line-aligned chunks
+    std::vector<ObjChunk> chunks(thread_count);
+    const char* chunk_begin = file_begin;
+    for (uint32_t chunk_idx = 0; chunk_idx < thread_count; chunk_idx++)
+    {
+        const char* chunk_end = chunk_idx + 1 == thread_count
+            ? file_end
+            : skip_line(std::max(chunk_begin, file_begin + file.get_size() * (chunk_idx + 1) / thread_count), file_end);
+        chunks[chunk_idx].begin = chunk_begin;
+        chunks[chunk_idx].end = chunk_end;
+        chunks[chunk_idx].valid = true;
+        chunk_begin = chunk_end;
+    }
+
+    // Parse chunks in parallel
+    parallel_ranges(thread_count, chunks.size(), [&chunks](size_t begin, size_t end, uint32_t) {
+        for (size_t chunk_idx = begin; chunk_idx < end; chunk_idx++)
+            parse_chunk(chunks[chunk_idx]);
+    });
+
+    // Prefix sums of element counts, so chunk-relative indices can be rebased
+    uint32_t position_count = 0, uv_count = 0, normal_count = 0;
+    size_t corner_count = 0;
+    std::vector<size_t> corner_bases(chunks.size());
+    for (size_t chunk_idx = 0; chunk_idx < chunks.size(); chunk_idx++)
+    {
+        ObjChunk& chunk = chunks[chunk_idx];
+        if (!chunk.valid)
+            fprintf(stdout, "WARN | OBJ > Skipped malformed face corners in %s\n", file_path.c_str());
+
+        chunk.position_base = position_count;
+        chunk.uv_base = uv_count;
+        chunk.normal_base = normal_count;
+        corner_bases[chunk_idx] = corner_count;
+        position_count += (uint32_t)(chunk.positions.size() / 3);
+        uv_count += (uint32_t)(chunk.uvs.size() / 2);
+        normal_count += (uint32_t)(chunk.normals.size() / 3);
+        corner_count += chunk.corners.size();
+    }
+
+    // Gather attributes and corners into flat arrays
+    std::vector<float> positions(position_count * 3), uvs(uv_count * 2), normals(normal_count * 3);
+    std::vector<ObjCorner> corners(corner_count);
+    parallel_ranges(thread_count, chunks.size(), [&](size_t begin, size_t end, uint32_t) {
+        for (size_t chunk_idx = begin; chunk_idx < end; chunk_idx++)
+        {
+            ObjChunk& chunk = chunks[chunk_idx];
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.position_base * 3);
+            std::copy(chunk.uvs.begin(), chunk.uvs.end(), uvs.begin() + chunk.uv_base * 2);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normal_base * 3);
+
+            ObjCorner* chunk_corners = corners.data() + corner_bases[chunk_idx];
+            for (size_t corner_idx = 0; corner_idx < chunk.corners.size(); corner_idx++)
+            {
+                const ObjCorner& corner = chunk.corners[corner_idx];
+                chunk_corners[corner_idx] = {
+                    rebase_index(corner.position, corner.relative & OBJ_RELATIVE_POSITION, chunk.position_base),
+                    rebase_index(corner.uv, corner.relative & OBJ_RELATIVE_UV, chunk.uv_base),
+                    rebase_index(corner.normal, corner.relative & OBJ_RELATIVE_NORMAL, chunk.normal_base),
+                    0 };
+            }
+
+            std::vector<float>().swap(chunk.positions);
+            std::vector<float>().swap(chunk.uvs);
+            std::vector<float>().swap(chunk.normals);
+            std::vector<ObjCorner>().swap(chunk.corners);
+        }
+    });
+
+    /**
+     * Merge identical corners in parallel; every thread owns a slice of the hash space and maps each
+     * corner to the first corner with the same key, then a linear pass assigns vertex indices in order
+     * of first occurrence
+     */
+    std::vector<uint64_t> corner_hashes(corner_count);
+    std::vector<uint32_t> first_corners(corner_count);
+    parallel_ranges(thread_count, corner_count, [&](size_t begin, size_t end, uint32_t) {
+        for (size_t corner_idx = begin; corner_idx < end; corner_idx++)
+            corner_hashes[corner_idx] = hash_corner(corners[corner_idx]);
+    });
+    parallel_ranges(thread_count, thread_count, [&](size_t begin, size_t end, uint32_t) {
+        for (size_t partition = begin; partition < end; partition++)
+        {
+            size_t table_size = 16;
+            while (table_size < corner_count * 2 / thread_count + 16)
+                table_size *= 2;
+            std::vector<uint32_t> table(table_size, UINT32_MAX);
+
+            for (size_t corner_idx = 0; corner_idx < corner_count; corner_idx++)
+            {
+                uint64_t hash = corner_hashes[corner_idx];
+                if (hash % thread_count != partition)
+                    continue;
+
+                size_t slot = (size_t)(hash >> 16) & (table_size - 1);
+                while (table[slot] != UINT32_MAX && !(corners[table[slot]] == corners[corner_idx]))
+                    slot = (slot + 1) & (table_size - 1);
+
+                if (table[slot] == UINT32_MAX)
+                    table[slot] = (uint32_t)corner_idx;
+                first_corners[corner_idx] = table[slot];
+            }
+        }
+    });
+
+    mesh_data.indices.resize(corner_count);
+    std::vector<uint32_t> vertex_corners;
+    for (size_t corner_idx = 0; corner_idx < corner_count; corner_idx++)
+    {
+        uint32_t first_corner = first_corners[corner_idx];
+        if (first_corner == corner_idx)
+        {
+            mesh_data.indices[corner_idx] = (uint32_t)vertex_corners.size();
+            vertex_corners.push_back((uint32_t)corner_idx);
+        }
+        else
+        {
+            mesh_data.indices[corner_idx] = mesh_data.indices[first_corner];
+        }
+    }
+
+    // Build vertices
+    std::atomic<bool> indices_valid = true;
+    mesh_data.vertices.resize(vertex_corners.size());
+    parallel_ranges(thread_count, vertex_corners.size(), [&](size_t begin, size_t end, uint32_t) {
+        for (size_t vertex_idx = begin; vertex_idx < end; vertex_idx++)
+        {
+            const ObjCorner& corner = corners[vertex_corners[vertex_idx]];
+            MeshVertex& vertex = mesh_data.vertices[vertex_idx];
+            vertex = {};
+
+            if (corner.position >= 0 && (uint32_t)corner.position < position_count)
+                std::copy_n(&positions[corner.position * 3], 3, vertex.position);
+            else
+                indices_valid = false;
+
+            if (corner.normal >= 0 && (uint32_t)corner.normal < normal_count)
+                std::copy_n(&normals[corner.normal * 3], 3, vertex.normal);
+            if (corner.uv >= 0 && (uint32_t)corner.uv < uv_count)
+                std::copy_n(&uvs[corner.uv * 2], 2, vertex.uv);
+        }
+    });
+
+    if (!indices_valid)
+    {
+        fprintf(stderr, "ERROR | OBJ > Face references a missing vertex position in %s\n", file_path.c_str());
+        mesh_data = {};
+        return false;
+    }
+
+    fprintf(stdout, "INFO | OBJ > Loaded %s (%zu vertices, %zu triangles)\n", file_path.c_str(), mesh_data.vertices.size(), mesh_data.indices.size() / 3);
+    return true;
+}
@@ -0,0 +1,258 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include "renderer.h"
+
+
+static thread_local ProfileTrack* s_thread_track = nullptr;
+
+
+ProfileTrack::ProfileTrack(std::string name, uint32_t track_id) :
+    m_name(std::move(name)), m_track_id(track_id), m_events(new ProfileEvent[CAPACITY]), m_write_index(0)
+{
+}
+
+
+void ProfileTrack::push(const ProfileEvent& event)
+{
+    uint64_t write_index = m_write_index.load(std::memory_order_relaxed);
+    m_events[write_index % CAPACITY] = event;
+    m_write_index.store(write_index + 1, std::memory_order_release);
+}
+
+
+void ProfileTrack::copy_events(std::vector<ProfileEvent>& events) const
+{
+    uint64_t end = m_write_index.load(std::memory_order_acquire);
+    uint64_t begin = end > CAPACITY ? end - CAPACITY : 0;
+    size_t first_copied = events.size();
+    for (uint64_t event_idx = begin; event_idx < end; event_idx++)
+        events.push_back(m_events[event_idx % CAPACITY]);
+
+    // Drop the oldest events if the writer wrapped around onto them while copying
+    uint64_t new_end = m_write_index.load(std::memory_order_acquire);
+    uint64_t overwritten_count = std::min(end - begin, new_end > begin + CAPACITY ? new_end - begin - CAPACITY : 0);
+    events.erase(events.begin() + first_copied, events.begin() + first_copied + overwritten_count);
+}
+
+
+Profiler::Profiler() :
+    m_start_time(std::chrono::steady_clock::now()), m_enabled(true), m_uploaded_bytes(0)
+{
+}
+
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+
+ProfileTrack* Profiler::create_track(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_tracks_mutex);
+    m_tracks.push_back(std::make_unique<ProfileTrack>(name, (uint32_t)m_tracks.size()));
+    return m_tracks.back().get();
+}
+
+
+ProfileTrack* Profiler::get_thread_track()
+{
+    if (!s_thread_track)
+    {
+        uint32_t track_count;
+        {
+            std::lock_guard<std::mutex> lock(m_tracks_mutex);
+            track_count = (uint32_t)m_tracks.size();
+        }
+        s_thread_track = create_track("Thread " + std::to_string(track_count));
+    }
+    return s_thread_track;
+}
+
+
+void Profiler::set_thread_name(const std::string& name)
+{
+    ProfileTrack* track = get_thread_track();
+    std::lock_guard<std::mutex> lock(m_tracks_mutex);
+    track->m_name = name;
+}
+
+
+void Profiler::record_zone(const char* name, uint64_t begin_time, uint64_t end_time)
+{
+    get_thread_track()->push({ name, begin_time, end_time - begin_time, ProfileEventType::ZONE });
+}
+
+
+void Profiler::record_counter(const char* name, uint64_t value)
+{
+    if (is_enabled())
+        get_thread_track()->push({ name, now(), value, ProfileEventType::COUNTER });
+}
+
+
+static void write_json_string(FILE* file, const char* string)
+{
+    fputc('"', file);
+    for (const char* c = string; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+
+bool Profiler::write_chrome_trace(const std::string& file_path)
+{
+    FILE* file = fopen(file_path.c_str(), "w");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR | Profiler > Failed to open [%s] for writing\n", file_path.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_tracks_mutex);
+
+    size_t event_count = 0;
+    std::vector<ProfileEvent> events;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (const std::unique_ptr<ProfileTrack>& track : m_tracks)
+    {
+        // Thread name metadata, then the track's zones and counters (timestamps in microseconds)
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", track->m_track_id ? ",\n" : "", track->m_track_id);
+        write_json_string(file, track->m_name.c_str());
+        fprintf(file, "}}");
+
+        events.clear();
+        track->copy_events(events);
+        for (const ProfileEvent& event : events)
+        {
+            fprintf(file, ",\n{\"name\":");
+            write_json_string(file, event.name);
+            if (event.type == ProfileEventType::ZONE)
+            {
+                fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                    track->m_track_id, event.timestamp / 1000.0, event.value / 1000.0);
+            }
+            else
+            {
+                fprintf(file, ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%llu}}",
+                    track->m_track_id, event.timestamp / 1000.0, (unsigned long long)event.value);
+            }
+        }
+        event_count += events.size();
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    fprintf(stdout, "INFO | Profiler > Wrote %zu event(s) to [%s]\n", event_count, file_path.c_str());
+    return true;
+}
+
+
+ProfileZone::ProfileZone(const char* name) :
+    m_name(name), m_begin_time(Profiler::get().is_enabled() ? Profiler::get().now() : UINT64_MAX)
+{
+}
+
+
+ProfileZone::~ProfileZone()
+{
+    if (m_begin_time != UINT64_MAX)
+        Profiler::get().record_zone(m_name, m_begin_time, Profiler::get().now());
+}
+
+
+GL_GpuProfiler::GL_GpuProfiler() :
+    m_frame_idx(0), m_gpu_time_offset(0), m_track(Profiler::get().create_track("GPU")), m_dropped_frames(0)
+{
+    for (GpuFrame& frame : m_frames)
+    {
+        GL_CALL(glGenQueries(MAX_ZONES_PER_FRAME * 2, frame.query_ids));
+        frame.zone_count = 0;
+        frame.last_query_id = 0;
+    }
+
+    // Map GPU timestamps onto the profiler's clock
+    int64_t gpu_time = 0;
+    GL_CALL(glGetInteger64v(GL_TIMESTAMP, &gpu_time));
+    m_gpu_time_offset = (int64_t)Profiler::get().now() - gpu_time;
+}
+
+
+GL_GpuProfiler::~GL_GpuProfiler()
+{
+    for (GpuFrame& frame : m_frames)
+    {
+        GL_CALL(glDeleteQueries(MAX_ZONES_PER_FRAME * 2, frame.query_ids));
+    }
+}
+
+
+void GL_GpuProfiler::begin_frame()
+{
+    m_frame_idx = (m_frame_idx + 1) % FRAME_LATENCY;
+    GpuFrame& frame = m_frames[m_frame_idx];
+    if (frame.zone_count)
+    {
+        // Timestamps complete in order: once the frame's last issued query is available, all of them are
+        int32_t available = 0;
+        GL_CALL(glGetQueryObjectiv(frame.last_query_id, GL_QUERY_RESULT_AVAILABLE, &available));
+        if (available)
+        {
+            for (uint32_t zone_idx = 0; zone_idx < frame.zone_count; zone_idx++)
+            {
+                uint64_t begin_time = 0, end_time = 0;
+                GL_CALL(glGetQueryObjectui64v(frame.query_ids[zone_idx * 2], GL_QUERY_RESULT, &begin_time));
+                GL_CALL(glGetQueryObjectui64v(frame.query_ids[zone_idx * 2 + 1], GL_QUERY_RESULT, &end_time));
+                m_track->push({ frame.zone_names[zone_idx], (uint64_t)(begin_time + m_gpu_time_offset), end_time - begin_time, ProfileEventType::ZONE });
+            }
+        }
+        else
+        {
+            m_dropped_frames++;
+        }
+    }
+    frame.zone_count = 0;
+}
+
+
+uint32_t GL_GpuProfiler::begin_zone(const char* name)
+{
+    GpuFrame& frame = m_frames[m_frame_idx];
+    if (!Profiler::get().is_enabled() || frame.zone_count == MAX_ZONES_PER_FRAME)
+        return UINT32_MAX;
+
+    uint32_t zone_idx = frame.zone_count++;
+    frame.zone_names[zone_idx] = name;
+    frame.last_query_id = frame.query_ids[zone_idx * 2];
+    GL_CALL(glQueryCounter(frame.last_query_id, GL_TIMESTAMP));
+    return zone_idx;
+}
+
+
+void GL_GpuProfiler::end_zone(uint32_t zone_idx)
+{
+    if (zone_idx == UINT32_MAX)
+        return;
+
+    GpuFrame& frame = m_frames[m_frame_idx];
+    frame.last_query_id = frame.query_ids[zone_idx * 2 + 1];
+    GL_CALL(glQueryCounter(frame.last_query_id, GL_TIMESTAMP));
+}
+
+
+GL_GpuZone::GL_GpuZone(GL_GpuProfiler* gpu_profiler, const char* name) :
+    m_gpu_profiler(gpu_profiler), m_zone_idx(gpu_profiler->begin_zone(name))
+{
+}
+
+
+GL_GpuZone::~GL_GpuZone()
+{
+    m_gpu_profiler->end_zone(m_zone_idx);
+}
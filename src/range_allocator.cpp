@@ -0,0 +1,110 @@
+#include "range_allocator.h"
+
+
+RangeAllocator::RangeAllocator(uint32_t capacity) :
+    m_capacity(0), m_used(0)
+{
+    reset(capacity);
+}
+
+
+void RangeAllocator::reset(uint32_t capacity)
+{
+    m_free_by_offset.clear();
+    m_free_by_size.clear();
+    m_capacity = capacity;
+    m_used = 0;
+
+    if (capacity)
+        insert_free(0, capacity);
+}
+
+
+void RangeAllocator::insert_free(uint32_t offset, uint32_t size)
+{
+    m_free_by_offset.emplace(offset, size);
+    m_free_by_size.emplace(size, offset);
+}
+
+
+void RangeAllocator::erase_free(std::map<uint32_t, uint32_t>::iterator it)
+{
+    auto size_range = m_free_by_size.equal_range(it->second);
+    for (auto size_it = size_range.first; size_it != size_range.second; size_it++)
+    {
+        if (size_it->second == it->first)
+        {
+            m_free_by_size.erase(size_it);
+            break;
+        }
+    }
+    m_free_by_offset.erase(it);
+}
+
+
+uint32_t RangeAllocator::allocate(uint32_t size)
+{
+    if (!size)
+        return INVALID_OFFSET;
+
+    // Best fit; the smallest free block which can hold the allocation
+    auto size_it = m_free_by_size.lower_bound(size);
+    if (size_it == m_free_by_size.end())
+        return INVALID_OFFSET;
+
+    uint32_t block_offset = size_it->second;
+    uint32_t block_size = size_it->first;
+    erase_free(m_free_by_offset.find(block_offset));
+
+    if (block_size > size)
+        insert_free(block_offset + size, block_size - size);
+
+    m_used += size;
+    return block_offset;
+}
+
+
+void RangeAllocator::free(uint32_t offset, uint32_t size)
+{
+    if (offset == INVALID_OFFSET || !size)
+        return;
+
+    m_used -= size;
+
+    // Coalesce with the following free block
+    auto next_it = m_free_by_offset.lower_bound(offset);
+    if (next_it != m_free_by_offset.end() && next_it->first == offset + size)
+    {
+        size += next_it->second;
+        erase_free(next_it);
+    }
+
+    // Coalesce with the preceding free block
+    auto prev_it = m_free_by_offset.lower_bound(offset);
+    if (prev_it != m_free_by_offset.begin())
+    {
+        prev_it--;
+        if (prev_it->first + prev_it->second == offset)
+        {
+            offset = prev_it->first;
+            size += prev_it->second;
+            erase_free(prev_it);
+        }
+    }
+
+    insert_free(offset, size);
+}
+
+
+uint32_t RangeAllocator::get_largest_free() const
+{
+    return m_free_by_size.empty() ? 0 : m_free_by_size.rbegin()->first;
+}
+
+
+float RangeAllocator::get_fragmentation() const
+{
+    // 0 when all free space is one contiguous block, approaching 1 as it splinters
+    uint32_t free_size = get_free();
+    return free_size ? 1.0f - (float)get_largest_free() / (float)free_size : 0.0f;
+}
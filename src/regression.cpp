@@ -0,0 +1,588 @@
+#include "regression.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stb_image.h>
+#include "allocation_counter.h"
+#include "command_list.h"
+#include "frame_arena.h"
+#include "frame_clock.h"
+#include "frustum_culling.h"
+#include "gpu_culling.h"
+#include "mat4.h"
+#include "render_queue.h"
+#include "scene.h"
+#include "scene_components.h"
+#include "software_shaders.h"
+#include "string_interner.h"
+#include "transform_system.h"
+#include "vertex_layout.h"
+
+
+static const uint32_t WARMUP_FRAME_COUNT = 4;
+static const uint32_t TIMED_FRAME_COUNT = 16;
+static const double FRAME_TIME_SLACK_MS = 0.25;
+// Largest possible YIQ distance between two colors (0-255 channels)
+static const double MAX_YIQ_DISTANCE = 35215.0;
+
+// Unit quad (xy position, uv) shared by the GL mesh pool and the software renderer
+static const float QUAD_VERTEX_DATA[] = {
+    -0.5f,   0.5f,   0.0f, 1.0f,
+     0.5f,   0.5f,   1.0f, 1.0f,
+    -0.5f,  -0.5f,   0.0f, 0.0f,
+     0.5f,  -0.5f,   1.0f, 0.0f,
+};
+static const uint32_t QUAD_INDEX_DATA[] = { 0, 1, 2, 2, 1, 3 };
+
+
+static bool write_ppm(const std::string& file_path, const uint8_t* rgba, uint32_t width, uint32_t height)
+{
+    FILE* file = fopen(file_path.c_str(), "wb");
+    if (!file)
+    {
+        fprintf(stderr, "ERROR | Regression > Failed to open [%s] for writing\n", file_path.c_str());
+        return false;
+    }
+
+    // GL rows go bottom-up; images top-down
+    fprintf(file, "P6\n%u %u\n255\n", width, height);
+    for (uint32_t row = 0; row < height; row++)
+    {
+        const uint8_t* pixel = rgba + (size_t)(height - 1 - row) * width * 4;
+        for (uint32_t column = 0; column < width; column++, pixel += 4)
+            fwrite(pixel, 1, 3, file);
+    }
+    fclose(file);
+    return true;
+}
+
+
+// Squared YIQ distance, weighted as in "Measuring perceived color difference using YIQ" (Kotsarenko, Ramos)
+static double color_distance(const uint8_t* lhs, const uint8_t* rhs)
+{
+    double r = (double)lhs[0] - rhs[0], g = (double)lhs[1] - rhs[1], b = (double)lhs[2] - rhs[2];
+    double y = r * 0.29889531 + g * 0.58662247 + b * 0.11448223;
+    double i = r * 0.59597799 - g * 0.27417610 - b * 0.32180189;
+    double q = r * 0.21147017 - g * 0.52261711 + b * 0.31114694;
+    return 0.5053 * y * y + 0.299 * i * i + 0.1957 * q * q;
+}
+
+
+RegressionSuite::RegressionSuite(const RegressionOptions& options) :
+    m_options(options), m_color_target({ WIDTH, HEIGHT, GL_RGBA8, 1, false }), m_failure_count(0),
+    m_vertex_format(nullptr), m_mesh_pool(4 * sizeof(float), 64, 64), m_quad_mesh(0), m_software_renderer(WIDTH, HEIGHT)
+{
+    m_framebuffer.set_color_target(0, &m_color_target);
+
+    // Shared assets: a unit quad, the example shaders and the example textures
+    m_vertex_format = m_vertex_formats.get(GL_VertexLayout<GL_Attrib<float, 2>, GL_Attrib<float, 2>>::get_table());
+    m_quad_mesh = m_mesh_pool.add_mesh(QUAD_VERTEX_DATA, 4, QUAD_INDEX_DATA, 6);
+    ASSERT(m_quad_mesh != GL_MeshPool::INVALID_HANDLE);
+
+    m_textured_program.create("./res/shaders/example.vert", "./res/shaders/example.frag");
+    m_instanced_program.create("./res/shaders/instanced.vert", "./res/shaders/example.frag");
+    for (GL_ShaderProgram* shader_program : { &m_textured_program, &m_instanced_program })
+    {
+        shader_program->set_uniform_4f("u_color", 0.03f, 0.67f, 0.92f, 1.0f);
+        shader_program->set_uniform_1i("u_texture0", 0);
+        shader_program->set_uniform_1i("u_texture1", 1);
+    }
+    m_texture0.load_image(0, "./res/textures/uv_texture.jpg", true, false);
+    m_texture1.load_image(1, "./res/textures/fug.png", true, true);
+    m_software_texture0.load_image("./res/textures/uv_texture.jpg", true);
+    m_software_texture1.load_image("./res/textures/fug.png", true);
+
+    // Fixed time, so time-driven shading renders the same every run
+    GL_FrameTimeBlock time_block = {};
+    m_renderer.set_frame_time(time_block);
+
+    if (m_options.record)
+        std::filesystem::create_directories(m_options.reference_directory);
+    else
+        load_baselines();
+}
+
+
+void RegressionSuite::load_baselines()
+{
+    // One line per scene: name, draw calls, state changes, GL calls
+    std::ifstream file_stream(m_options.reference_directory + "baselines.txt");
+    std::string line;
+    while (std::getline(file_stream, line))
+    {
+        std::istringstream line_stream(line);
+        std::string scene_name;
+        RegressionBaseline baseline = {};
+        if (line_stream >> scene_name >> baseline.draw_calls >> baseline.state_changes >> baseline.gl_calls)
+            m_baselines[scene_name] = baseline;
+    }
+
+    // One line per scene: name, frame time (ms)
+    std::ifstream frame_time_stream(m_options.reference_directory + "frame_times.txt");
+    while (std::getline(frame_time_stream, line))
+    {
+        std::istringstream line_stream(line);
+        std::string scene_name;
+        double frame_time_ms = 0.0;
+        if (line_stream >> scene_name >> frame_time_ms)
+            m_frame_times[scene_name] = frame_time_ms;
+    }
+}
+
+
+void RegressionSuite::save_baselines() const
+{
+    std::ofstream file_stream(m_options.reference_directory + "baselines.txt");
+    std::ofstream frame_time_stream(m_options.reference_directory + "frame_times.txt");
+    for (const auto& [scene_name, baseline] : m_recorded_baselines)
+    {
+        file_stream << scene_name << ' ' << baseline.draw_calls << ' ' << baseline.state_changes << ' ' << baseline.gl_calls << '\n';
+        frame_time_stream << scene_name << ' ' << baseline.frame_time_ms << '\n';
+    }
+}
+
+
+template<typename F>
+RegressionCapture RegressionSuite::capture(F&& draw_frame)
+{
+    m_framebuffer.bind();
+
+    RegressionCapture capture = {};
+    std::vector<double> frame_times;
+    frame_times.reserve(TIMED_FRAME_COUNT);
+    for (uint32_t frame_idx = 0; frame_idx < WARMUP_FRAME_COUNT + TIMED_FRAME_COUNT; frame_idx++)
+    {
+        FrameAllocator::get().begin_frame();
+        m_renderer.invalidate_state();
+        m_renderer.reset_frame_stats();
+        gl_call_stats_end_frame();
+
+        uint64_t allocation_count = get_allocation_count();
+        std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+        m_renderer.clear();
+        draw_frame();
+        GL_CALL(glFinish());
+        std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+
+        capture.stats.gl_calls = gl_call_stats_end_frame();
+        if (frame_idx >= WARMUP_FRAME_COUNT)
+        {
+            capture.allocations += get_allocation_count() - allocation_count;
+            frame_times.push_back(std::chrono::duration<double, std::milli>(end_time - begin_time).count());
+        }
+    }
+
+    const GL_RenderStats& render_stats = m_renderer.get_frame_stats();
+    capture.stats.draw_calls = render_stats.draw_calls;
+    capture.stats.state_changes = render_stats.vertex_array_binds + render_stats.vertex_buffer_binds + render_stats.program_binds;
+    std::nth_element(frame_times.begin(), frame_times.begin() + frame_times.size() / 2, frame_times.end());
+    capture.stats.frame_time_ms = frame_times[frame_times.size() / 2];
+
+    capture.pixels.resize(WIDTH * HEIGHT * 4);
+    m_framebuffer.read_pixels(0, capture.pixels.data());
+    GL_CALL(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+    return capture;
+}
+
+
+template<typename F>
+RegressionCapture RegressionSuite::capture_software(F&& draw_frame)
+{
+    RegressionCapture capture = {};
+    std::vector<double> frame_times;
+    frame_times.reserve(TIMED_FRAME_COUNT);
+    for (uint32_t frame_idx = 0; frame_idx < WARMUP_FRAME_COUNT + TIMED_FRAME_COUNT; frame_idx++)
+    {
+        FrameAllocator::get().begin_frame();
+        m_software_renderer.reset_frame_stats();
+
+        uint64_t allocation_count = get_allocation_count();
+        std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+        m_software_renderer.clear(0.0f, 0.0f, 0.0f, 0.0f);
+        draw_frame();
+        m_software_renderer.flush();
+        std::chrono::steady_clock::time_point end_time = std::chrono::steady_clock::now();
+        if (frame_idx >= WARMUP_FRAME_COUNT)
+        {
+            capture.allocations += get_allocation_count() - allocation_count;
+            frame_times.push_back(std::chrono::duration<double, std::milli>(end_time - begin_time).count());
+        }
+    }
+
+    capture.stats.draw_calls = m_software_renderer.get_frame_stats().draw_calls;
+    std::nth_element(frame_times.begin(), frame_times.begin() + frame_times.size() / 2, frame_times.end());
+    capture.stats.frame_time_ms = frame_times[frame_times.size() / 2];
+
+    const uint8_t* pixels = m_software_renderer.get_pixels();
+    capture.pixels.assign(pixels, pixels + WIDTH * HEIGHT * 4);
+    return capture;
+}
+
+
+void RegressionSuite::fail(const std::string& scene_name, const char* reason)
+{
+    fprintf(stderr, "ERROR | Regression > [%s] %s\n", scene_name.c_str(), reason);
+    m_failure_count++;
+}
+
+
+void RegressionSuite::check(const std::string& scene_name, const RegressionCapture& capture, const std::string& reference_name)
+{
+    const RegressionBaseline& stats = capture.stats;
+    fprintf(stdout, "INFO | Regression > [%s] %u draw call(s), %u state change(s), %llu GL call(s), %.3f ms\n",
+        scene_name.c_str(), stats.draw_calls, stats.state_changes, (unsigned long long)stats.gl_calls, stats.frame_time_ms);
+
+    // Steady-state frames must not touch the heap (only counted in COUNT_ALLOCATIONS builds)
+    if (capture.allocations)
+    {
+        fprintf(stderr, "ERROR | Regression > [%s] %llu heap allocation(s) over %u steady-state frames\n",
+            scene_name.c_str(), (unsigned long long)capture.allocations, TIMED_FRAME_COUNT);
+        fail(scene_name, "Steady-state frames allocated");
+    }
+
+    std::string reference_path = m_options.reference_directory + (reference_name.empty() ? scene_name : reference_name) + ".ppm";
+    if (m_options.record)
+    {
+        if (reference_name.empty())
+            write_ppm(reference_path, capture.pixels.data(), WIDTH, HEIGHT);
+        m_recorded_baselines.emplace_back(scene_name, stats);
+        return;
+    }
+
+    // Image: count pixels whose perceptual distance from the reference exceeds the threshold
+    int32_t width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load_thread(true);
+    uint8_t* reference = stbi_load(reference_path.c_str(), &width, &height, &channels, 4);
+    if (!reference || width != (int32_t)WIDTH || height != (int32_t)HEIGHT)
+    {
+        fail(scene_name, "Missing or mismatched reference image (record with --regression-record)");
+    }
+    else
+    {
+        double max_distance = m_options.color_threshold * m_options.color_threshold * MAX_YIQ_DISTANCE;
+        std::vector<uint8_t> difference(WIDTH * HEIGHT * 4, 0);
+        uint32_t mismatch_count = 0;
+        for (uint32_t pixel_idx = 0; pixel_idx < WIDTH * HEIGHT; pixel_idx++)
+        {
+            bool mismatch = color_distance(capture.pixels.data() + pixel_idx * 4, reference + pixel_idx * 4) > max_distance;
+            mismatch_count += mismatch;
+            difference[pixel_idx * 4] = mismatch ? 255 : capture.pixels[pixel_idx * 4] / 4;
+        }
+
+        float mismatch_fraction = mismatch_count / (float)(WIDTH * HEIGHT);
+        if (mismatch_fraction > m_options.max_mismatch_fraction)
+        {
+            fprintf(stderr, "ERROR | Regression > [%s] %u pixel(s) (%.2f%%) differ from the reference\n", scene_name.c_str(), mismatch_count, mismatch_fraction * 100.0f);
+            fail(scene_name, "Image differs from the reference");
+
+            std::filesystem::create_directories(m_options.output_directory);
+            write_ppm(m_options.output_directory + scene_name + ".ppm", capture.pixels.data(), WIDTH, HEIGHT);
+            write_ppm(m_options.output_directory + scene_name + ".diff.ppm", difference.data(), WIDTH, HEIGHT);
+        }
+    }
+    if (reference)
+        stbi_image_free(reference);
+
+    // Performance: counts must not grow, frame time must stay within tolerance of the local recording
+    auto it = m_baselines.find(scene_name);
+    if (it == m_baselines.end())
+    {
+        fail(scene_name, "Missing baseline (record with --regression-record)");
+        return;
+    }
+
+    const RegressionBaseline& baseline = it->second;
+    if (stats.draw_calls > baseline.draw_calls)
+        fail(scene_name, "Draw calls regressed");
+    if (stats.state_changes > baseline.state_changes)
+        fail(scene_name, "State changes regressed");
+    if (stats.gl_calls && baseline.gl_calls)
+    {
+        if (stats.gl_calls > baseline.gl_calls)
+            fail(scene_name, "GL calls regressed");
+    }
+    else if (stats.gl_calls != baseline.gl_calls)
+    {
+        fprintf(stdout, "INFO | Regression > [%s] GL call check skipped, %s has no GL call count (GL_CALL_STATS builds only)\n",
+            scene_name.c_str(), stats.gl_calls ? "the baseline" : "this build");
+    }
+
+    auto frame_time_it = m_frame_times.find(scene_name);
+    if (frame_time_it != m_frame_times.end() &&
+        stats.frame_time_ms > frame_time_it->second * (1.0 + m_options.frame_time_tolerance) + FRAME_TIME_SLACK_MS)
+    {
+        fprintf(stderr, "ERROR | Regression > [%s] %.3f ms against a %.3f ms baseline\n", scene_name.c_str(), stats.frame_time_ms, frame_time_it->second);
+        fail(scene_name, "Frame time regressed");
+    }
+}
+
+
+// Four textured quads, each drawn with its own model-view-projection through the immediate draw path
+void RegressionSuite::run_textured_quads()
+{
+    const float offsets[4][2] = { { -0.5f, 0.5f }, { 0.5f, 0.5f }, { -0.5f, -0.5f }, { 0.5f, -0.5f } };
+    check("textured_quads", capture([this, &offsets]() {
+        m_texture0.gl_bind(0);
+        m_texture1.gl_bind(1);
+        for (const float* offset : offsets)
+        {
+            const float position[3] = { offset[0], offset[1], 0.0f };
+            const float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            const float scale[3] = { 0.9f, 0.9f, 1.0f };
+            Mat4 model = mat4_from_trs(position, rotation, scale);
+            m_textured_program.set_uniform_mat4("u_model_view_projection", model.m);
+            m_renderer.draw(m_vertex_format, &m_mesh_pool, m_quad_mesh, &m_textured_program);
+        }
+    }));
+}
+
+
+/**
+ * A grid of scene entities gathered, sorted and recorded into command lists, replayed in one submit; the
+ * BVH variant is checked against the flat culling image
+ */
+void RegressionSuite::run_batching(RenderCulling culling)
+{
+    const uint32_t grid_size = 16;
+
+    TransformSystem transforms;
+    Scene scene;
+    RenderQueue render_queue;
+    render_queue.set_culling(culling);
+    TransformHandle root = transforms.create();
+    for (uint32_t y = 0; y < grid_size; y++)
+    {
+        for (uint32_t x = 0; x < grid_size; x++)
+        {
+            TransformHandle transform = transforms.create(root);
+            transforms.set_position(transform, x - (grid_size - 1) * 0.5f, y - (grid_size - 1) * 0.5f, 0.0f);
+            transforms.set_scale(transform, 0.8f, 0.8f, 1.0f);
+            scene.create(
+                TransformComponent{ transform },
+                MeshComponent{ m_vertex_format, &m_mesh_pool, m_quad_mesh },
+                MaterialComponent{ &m_textured_program },
+                BoundsComponent{ { 0.0f, 0.0f, 0.0f }, { 0.5f, 0.5f, 0.0f } });
+        }
+    }
+    const float scale = 2.0f / grid_size;
+    transforms.set_scale(root, scale, scale, 1.0f);
+    transforms.update();
+
+    const float origin[3] = { 0.0f, 0.0f, 0.0f };
+    const float no_rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    const float unit_scale[3] = { 1.0f, 1.0f, 1.0f };
+    Mat4 view_projection = mat4_from_trs(origin, no_rotation, unit_scale);
+    std::vector<CommandList> command_lists;
+    bool bvh_culling = culling == RenderCulling::BVH;
+    check(bvh_culling ? "batching_bvh" : "batching", capture([&]() {
+        m_texture0.gl_bind(0);
+        m_texture1.gl_bind(1);
+        render_queue.gather(scene, transforms, Frustum::from_matrix(view_projection.m));
+        render_queue.record(transforms, view_projection, command_lists);
+        m_renderer.submit(command_lists.data(), (uint32_t)command_lists.size());
+    }), bvh_culling ? "batching" : "");
+}
+
+
+// The same grid as one instanced draw, reading world matrices from a storage buffer
+void RegressionSuite::run_instancing()
+{
+    static const uint32_t u_view_projection_id = intern_string("u_view_projection");
+    const uint32_t grid_size = 16;
+
+    TransformSystem transforms;
+    const float scale = 2.0f / grid_size;
+    for (uint32_t y = 0; y < grid_size; y++)
+    {
+        for (uint32_t x = 0; x < grid_size; x++)
+        {
+            TransformHandle transform = transforms.create();
+            transforms.set_position(transform, (x - (grid_size - 1) * 0.5f) * scale, (y - (grid_size - 1) * 0.5f) * scale, 0.0f);
+            transforms.set_scale(transform, 0.8f * scale, 0.8f * scale, 1.0f);
+        }
+    }
+    transforms.update();
+
+    GL_DataBuffer<float> instance_buffer;
+    instance_buffer.set_data(GL_SHADER_STORAGE_BUFFER, 0, nullptr, GL_DYNAMIC_DRAW);
+    transforms.upload(&instance_buffer);
+
+    const float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+    const GL_MeshRange& mesh_range = m_mesh_pool.get_range(m_quad_mesh);
+    CommandList command_list;
+    command_list.bind_program(&m_instanced_program);
+    command_list.set_uniform_mat4(u_view_projection_id, identity);
+    command_list.bind_vertex_format(m_vertex_format, m_mesh_pool.get_vertex_buffer_id(), m_mesh_pool.get_index_buffer_id());
+    command_list.draw_indexed(GL_UNSIGNED_INT, mesh_range.index_count, mesh_range.first_index, (int32_t)mesh_range.base_vertex, transforms.get_count());
+
+    check("instancing", capture([&]() {
+        m_texture0.gl_bind(0);
+        m_texture1.gl_bind(1);
+        instance_buffer.bind_base(GL_SHADER_STORAGE_BUFFER, 0);
+        m_renderer.submit(&command_list, 1);
+    }));
+}
+
+
+/**
+ * `GL_GpuCuller` over a fixed set of boxes and spheres (frustum only, no Hi-Z), checked against
+ * `FrustumCuller`: the compacted draw count must match, and every command must carry the index range of
+ * a CPU-visible object. Commands are appended in no particular order, so they are compared sorted.
+ */
+void RegressionSuite::run_gpu_culling()
+{
+    const std::string scene_name = "gpu_culling";
+    const uint32_t object_count = 32768;
+
+    // Fixed-seed LCG, so objects land off any grid the frustum planes could line up with
+    uint32_t random_state = 0x2F6B3A1Du;
+    auto random_float = [&random_state](float min, float max) {
+        random_state = random_state * 1664525u + 1013904223u;
+        return min + (max - min) * (random_state >> 8) / (float)(1 << 24);
+    };
+
+    FrustumCuller culler;
+    culler.reserve(object_count);
+    std::vector<GL_GpuCullObject> objects(object_count);
+    for (uint32_t object_idx = 0; object_idx < object_count; object_idx++)
+    {
+        GL_GpuCullObject& object = objects[object_idx];
+        object = {};
+        for (uint32_t axis = 0; axis < 3; axis++)
+        {
+            object.center[axis] = random_float(-60.0f, 60.0f);
+            object.extents[axis] = random_float(0.1f, 3.0f);
+        }
+
+        // Every third object is a sphere, bounded by the same radius on the GPU
+        if (object_idx % 3 == 0)
+        {
+            object.radius = object.extents[0];
+            object.extents[1] = object.extents[2] = object.radius;
+            culler.add_sphere(object.center, object.radius);
+        }
+        else
+        {
+            object.radius = std::sqrt(object.extents[0] * object.extents[0] + object.extents[1] * object.extents[1] + object.extents[2] * object.extents[2]);
+            culler.add(object.center, object.extents);
+        }
+        object.index_count = 3 + (object_idx % 4) * 3;
+        object.first_index = object_idx * 12;
+        object.base_vertex = (int32_t)(object_idx % 7);
+    }
+
+    const float eye[3] = { 0.0f, 0.0f, 0.0f };
+    const float target[3] = { 0.0f, 0.0f, -1.0f };
+    const float up[3] = { 0.0f, 1.0f, 0.0f };
+    Mat4 view_projection = mat4_multiply(mat4_perspective(1.0472f, 1.0f, 0.1f, 100.0f), mat4_look_at(eye, target, up));
+    Frustum frustum = Frustum::from_matrix(view_projection.m);
+
+    std::vector<uint32_t> visible;
+    culler.cull(frustum, visible);
+
+    GL_GpuCuller gpu_culler("./res/shaders/cull.comp", "./res/shaders/hiz.comp");
+    gpu_culler.set_objects(objects.data(), object_count);
+    gpu_culler.cull(frustum, view_projection.m, false);
+    GL_ShaderProgram::memory_barrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+    uint32_t draw_count = 0;
+    gpu_culler.get_count_buffer()->bind();
+    GL_CALL(glGetBufferSubData(gpu_culler.get_count_buffer()->get_type(), 0, sizeof(draw_count), &draw_count));
+    fprintf(stdout, "INFO | Regression > [%s] %u objects, %u draw(s), %zu visible on the CPU\n", scene_name.c_str(), object_count, draw_count, visible.size());
+    if (draw_count != visible.size())
+    {
+        fail(scene_name, "Draw count differs from the CPU culler");
+        return;
+    }
+
+    std::vector<GL_DrawElementsIndirectCommand> commands(draw_count);
+    if (draw_count)
+    {
+        gpu_culler.get_command_buffer()->bind();
+        GL_CALL(glGetBufferSubData(gpu_culler.get_command_buffer()->get_type(), 0, draw_count * sizeof(GL_DrawElementsIndirectCommand), commands.data()));
+    }
+    std::sort(commands.begin(), commands.end(), [](const GL_DrawElementsIndirectCommand& a, const GL_DrawElementsIndirectCommand& b) {
+        return a.base_instance < b.base_instance;
+    });
+    for (uint32_t command_idx = 0; command_idx < draw_count; command_idx++)
+    {
+        const GL_DrawElementsIndirectCommand& command = commands[command_idx];
+        const GL_GpuCullObject& object = objects[visible[command_idx]];
+        if (command.base_instance != visible[command_idx] || command.instance_count != 1 || command.count != object.index_count ||
+            command.first_index != object.first_index || command.base_vertex != object.base_vertex)
+        {
+            fprintf(stderr, "ERROR | Regression > [%s] Command %u draws object %u, expected object %u\n",
+                scene_name.c_str(), command_idx, command.base_instance, visible[command_idx]);
+            fail(scene_name, "Draw commands differ from the CPU culler");
+            return;
+        }
+    }
+}
+
+
+// `run_textured_quads` through the software renderer, checked against the GL image
+void RegressionSuite::run_software_textured_quads()
+{
+    const float offsets[4][2] = { { -0.5f, 0.5f }, { 0.5f, 0.5f }, { -0.5f, -0.5f }, { 0.5f, -0.5f } };
+    const SoftwareMesh quad_mesh = {
+        GL_VertexLayout<GL_Attrib<float, 2>, GL_Attrib<float, 2>>::get_table(),
+        (const uint8_t*)QUAD_VERTEX_DATA, 4, QUAD_INDEX_DATA, 6
+    };
+
+    SoftwareExampleUniforms uniforms = {};
+    uniforms.color[0] = 0.03f;
+    uniforms.color[1] = 0.67f;
+    uniforms.color[2] = 0.92f;
+    uniforms.color[3] = 1.0f;
+    uniforms.texture0 = &m_software_texture0;
+    uniforms.texture1 = &m_software_texture1;
+    check("software_textured_quads", capture_software([this, &offsets, &quad_mesh, &uniforms]() {
+        for (const float* offset : offsets)
+        {
+            const float position[3] = { offset[0], offset[1], 0.0f };
+            const float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+            const float scale[3] = { 0.9f, 0.9f, 1.0f };
+            Mat4 model = mat4_from_trs(position, rotation, scale);
+            memcpy(uniforms.model_view_projection, model.m, sizeof(uniforms.model_view_projection));
+            m_software_renderer.draw(quad_mesh, software_example_shader, &uniforms);
+        }
+    }), "textured_quads");
+}
+
+
+uint32_t RegressionSuite::run()
+{
+    fprintf(stdout, "INFO | Regression > %s %ux%u scenes\n", m_options.record ? "Recording" : "Checking", WIDTH, HEIGHT);
+#if !defined(COUNT_ALLOCATIONS)
+    fprintf(stdout, "INFO | Regression > Steady-state allocation checks skipped (build with COUNT_ALLOCATIONS)\n");
+#endif
+    if (!m_options.record && m_frame_times.empty())
+        fprintf(stdout, "INFO | Regression > No local frame times, frame time checks skipped (record with --regression-record on this machine)\n");
+
+    run_textured_quads();
+    run_batching(RenderCulling::FLAT);
+    run_batching(RenderCulling::BVH);
+    run_instancing();
+    run_gpu_culling();
+    run_software_textured_quads();
+
+    if (m_options.record)
+    {
+        save_baselines();
+        fprintf(stdout, "INFO | Regression > Recorded %zu scene(s) to [%s]\n", m_recorded_baselines.size(), m_options.reference_directory.c_str());
+    }
+    else if (m_failure_count)
+    {
+        fprintf(stderr, "ERROR | Regression > %u check(s) failed\n", m_failure_count);
+    }
+    else
+    {
+        fprintf(stdout, "INFO | Regression > All checks passed\n");
+    }
+    return m_failure_count;
+}
@@ -0,0 +1,159 @@
+#include "render_queue.h"
+#include <algorithm>
+#include <cmath>
+#include "job_system.h"
+#include "profiler.h"
+#include "string_interner.h"
+
+
+static const uint32_t RECORD_MIN_ITEMS_PER_LIST = 1024;
+
+
+/**
+ * Shader program in the top bits, then vertex format, then mesh pool (as allocation order proxies); the
+ * program's sort id rather than its GL id, which the render thread replaces on hot reload
+ */
+static uint64_t make_sort_key(const GL_ShaderProgram* shader_program, const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool)
+{
+    return ((uint64_t)(shader_program->get_sort_id() & 0xFFFFF) << 44) |
+        ((uint64_t)(vertex_format->get_id() & 0xFFFFF) << 24) |
+        ((uint64_t)(mesh_pool->get_vertex_buffer_id() & 0xFFFFFF));
+}
+
+
+RenderQueue::RenderQueue() :
+    m_culling(RenderCulling::FLAT)
+{
+}
+
+
+void RenderQueue::gather(Scene& scene, const TransformSystem& transforms, const Frustum& frustum, uint32_t thread_count)
+{
+    PROFILE_ZONE("RenderQueue::gather");
+
+    uint32_t candidate_count = scene.count<TransformComponent, MeshComponent, MaterialComponent, BoundsComponent>();
+    m_culler.clear();
+    m_object_bounds.clear();
+    if (m_culling == RenderCulling::FLAT)
+        m_culler.reserve(candidate_count);
+    else
+        m_object_bounds.reserve((size_t)candidate_count * 6);
+    m_candidates.clear();
+    m_candidates.reserve(candidate_count);
+
+    const Mat4* world_matrices = transforms.get_world_matrices();
+    scene.for_each_chunk<TransformComponent, MeshComponent, MaterialComponent, BoundsComponent>(
+        [this, &transforms, world_matrices](uint32_t count, const EntityHandle*, TransformComponent* transform_components,
+            MeshComponent* meshes, MaterialComponent* materials, BoundsComponent* bounds) {
+        for (uint32_t row = 0; row < count; row++)
+        {
+            uint32_t transform_index = transforms.get_index(transform_components[row].transform);
+            const float* world = world_matrices[transform_index].m;
+
+            // World AABB: transformed center, extents through the absolute rotation-scale part
+            float center[3], extents[3];
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                center[axis] = world[12 + axis] +
+                    world[axis] * bounds[row].center[0] + world[4 + axis] * bounds[row].center[1] + world[8 + axis] * bounds[row].center[2];
+                extents[axis] =
+                    fabsf(world[axis]) * bounds[row].extents[0] + fabsf(world[4 + axis]) * bounds[row].extents[1] + fabsf(world[8 + axis]) * bounds[row].extents[2];
+            }
+            if (m_culling == RenderCulling::FLAT)
+            {
+                m_culler.add(center, extents);
+            }
+            else
+            {
+                for (uint32_t axis = 0; axis < 3; axis++)
+                    m_object_bounds.push_back(center[axis] - extents[axis]);
+                for (uint32_t axis = 0; axis < 3; axis++)
+                    m_object_bounds.push_back(center[axis] + extents[axis]);
+            }
+
+            m_candidates.push_back({
+                make_sort_key(materials[row].shader_program, meshes[row].vertex_format, meshes[row].mesh_pool),
+                meshes[row].vertex_format, meshes[row].mesh_pool, meshes[row].mesh, materials[row].shader_program, transform_index
+            });
+        }
+    });
+
+    if (m_culling == RenderCulling::FLAT)
+    {
+        m_culler.cull(frustum, m_visible, thread_count);
+    }
+    else
+    {
+        // Refitting stays correct when the candidates change, just with a looser tree; rebuild when their count does
+        if (m_bvh.get_object_count() != candidate_count)
+        {
+            m_bvh.build(m_object_bounds.data(), candidate_count);
+        }
+        else
+        {
+            for (uint32_t candidate_idx = 0; candidate_idx < candidate_count; candidate_idx++)
+                m_bvh.set_bounds(candidate_idx, &m_object_bounds[(size_t)candidate_idx * 6], &m_object_bounds[(size_t)candidate_idx * 6 + 3]);
+            m_bvh.refit();
+        }
+        m_bvh.cull(frustum, m_visible);
+    }
+
+    m_items.clear();
+    for (uint32_t candidate_idx : m_visible)
+        m_items.push_back(m_candidates[candidate_idx]);
+    // Ties broken by transform index: deterministic like a stable sort, without its temporary buffer
+    std::sort(m_items.begin(), m_items.end(), [](const RenderItem& lhs, const RenderItem& rhs) {
+        return lhs.sort_key != rhs.sort_key ? lhs.sort_key < rhs.sort_key : lhs.transform_index < rhs.transform_index;
+    });
+}
+
+
+void RenderQueue::record(const TransformSystem& transforms, const Mat4& view_projection, std::vector<CommandList>& command_lists) const
+{
+    PROFILE_ZONE("RenderQueue::record");
+
+    static const uint32_t u_model_view_projection_id = intern_string("u_model_view_projection");
+
+    uint32_t item_count = (uint32_t)m_items.size();
+    uint32_t list_count = std::clamp(item_count / RECORD_MIN_ITEMS_PER_LIST, 1u, JobSystem::get().get_worker_count() * 4);
+    command_lists.resize(list_count);
+
+    const Mat4* world_matrices = transforms.get_world_matrices();
+    JobSystem::get().parallel_for(list_count, [&](size_t first_list, size_t last_list) {
+        for (size_t list_idx = first_list; list_idx < last_list; list_idx++)
+        {
+            CommandList& command_list = command_lists[list_idx];
+            command_list.reset();
+
+            // Each list starts from unknown state; redundant binds across lists are dropped on replay
+            const GL_ShaderProgram* shader_program = nullptr;
+            const GL_MeshPool* mesh_pool = nullptr;
+            const GL_VertexFormat* vertex_format = nullptr;
+
+            uint32_t begin = (uint32_t)(item_count * list_idx / list_count);
+            uint32_t end = (uint32_t)(item_count * (list_idx + 1) / list_count);
+            for (uint32_t item_idx = begin; item_idx < end; item_idx++)
+            {
+                const RenderItem& item = m_items[item_idx];
+                if (item.shader_program != shader_program)
+                {
+                    command_list.bind_program(item.shader_program);
+                    shader_program = item.shader_program;
+                }
+                if (item.mesh_pool != mesh_pool || item.vertex_format != vertex_format)
+                {
+                    command_list.bind_vertex_format(item.vertex_format, item.mesh_pool->get_vertex_buffer_id(), item.mesh_pool->get_index_buffer_id());
+                    mesh_pool = item.mesh_pool;
+                    vertex_format = item.vertex_format;
+                }
+
+                Mat4 model_view_projection = mat4_multiply(view_projection, world_matrices[item.transform_index]);
+                command_list.set_uniform_mat4(u_model_view_projection_id, model_view_projection.m);
+
+                const GL_MeshRange& mesh_range = item.mesh_pool->get_range(item.mesh);
+                command_list.draw_indexed(GL_UNSIGNED_INT, mesh_range.index_count, mesh_range.first_index, (int32_t)mesh_range.base_vertex);
+            }
+        }
+    });
+}
+
@@ -0,0 +1,99 @@
+#include "render_thread.h"
+#include <cstdio>
+#include <GLFW/glfw3.h>
+#include "job_system.h"
+#include "profiler.h"
+
+
+RenderThread::RenderThread(GLFWwindow* window, uint32_t packet_count, std::function<void(FramePacket&)> render_function) :
+    m_window(window), m_render_function(std::move(render_function)), m_running(true), m_submitted_count(0), m_started_count(0), m_rendered_count(0)
+{
+    m_free_packets.reserve(packet_count);
+    m_ready_packets.resize(packet_count);
+    for (uint32_t packet_idx = 0; packet_idx < packet_count; packet_idx++)
+    {
+        m_packets.push_back(std::make_unique<FramePacket>());
+        m_free_packets.push_back(m_packets.back().get());
+    }
+
+    // A context can only be current on one thread at a time
+    glfwMakeContextCurrent(nullptr);
+    m_thread = std::thread(&RenderThread::render_loop, this);
+}
+
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+
+    // Hand the context back, so GL objects can be destroyed on this thread
+    glfwMakeContextCurrent(m_window);
+}
+
+
+void RenderThread::render_loop()
+{
+    glfwMakeContextCurrent(m_window);
+    Profiler::get().set_thread_name("Render");
+    fprintf(stdout, "INFO | RenderThread > Started\n");
+
+    while (true)
+    {
+        FramePacket* packet;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_condition.wait(lock, [this]() { return !m_running || m_started_count < m_submitted_count; });
+            if (m_started_count == m_submitted_count)
+                break;
+
+            // Submitted packets form a ring indexed by frame
+            packet = m_ready_packets[m_started_count++ % m_ready_packets.size()];
+        }
+
+        JobSystem::get().process_gl_thread_jobs();
+        m_render_function(*packet);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_free_packets.push_back(packet);
+            m_rendered_count++;
+        }
+        m_condition.notify_all();
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
+
+
+FramePacket* RenderThread::acquire_packet()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return !m_free_packets.empty(); });
+
+    FramePacket* packet = m_free_packets.back();
+    m_free_packets.pop_back();
+    return packet;
+}
+
+
+void RenderThread::submit_packet(FramePacket* packet)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        packet->frame_index = m_submitted_count;
+        m_ready_packets[m_submitted_count++ % m_ready_packets.size()] = packet;
+    }
+    m_condition.notify_all();
+}
+
+
+void RenderThread::flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return m_rendered_count == m_submitted_count; });
+}
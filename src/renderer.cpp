@@ -1,8 +1,8 @@
 #include "renderer.h"
 #include <cstdint>
 #include <cstdio>
-#include <ctime>
 #include "gl_utils.h"
+#include "profiler.h"
 
 
 void gl_clear_error()
@@ -22,28 +22,54 @@ bool gl_log_call(const char* function, const char* source_file, uint32_t line_nu
     return true;
 }
 
-void GL_Renderer::clear()
+GL_Renderer::GL_Renderer() :
+    m_bound_vertex_format(nullptr), m_bound_vertex_buffer(0), m_bound_index_buffer(0), m_frame_stats({})
 {
-    GL_CALL(glClear(GL_COLOR_BUFFER_BIT));
+    m_frame_time_buffer.set_data(GL_UNIFORM_BUFFER, sizeof(GL_FrameTimeBlock), nullptr, GL_DYNAMIC_DRAW);
+}
+
+
+void GL_Renderer::invalidate_state()
+{
+    m_bound_vertex_format = nullptr;
+    m_bound_vertex_buffer = 0;
+    m_bound_index_buffer = 0;
+}
+
+
+void GL_Renderer::clear(uint32_t gl_buffer_mask)
+{
+    GL_CALL(glClear(gl_buffer_mask));
+}
+
+
+void GL_Renderer::set_frame_time(const GL_FrameTimeBlock& time_block)
+{
+    m_frame_time_buffer.update_data(0, sizeof(GL_FrameTimeBlock), (const unsigned char*)&time_block);
+    m_frame_time_buffer.bind_base(GL_UNIFORM_BUFFER, GL_FRAME_TIME_BINDING);
 }
 
 
 template<typename T, typename K>
 void GL_Renderer::draw(const GL_VertexArray<T>* vertex_array, const GL_DataBuffer<K>* index_buffer, GL_ShaderProgram* shader_program)
 {
+    PROFILE_ZONE("GL_Renderer::draw");
+
     // Get index buffer data type
     uint32_t gl_type = get_gl_type<K>();
 
     // Configure vertex buffer state
+    invalidate_state();
     vertex_array->bind();
     index_buffer->bind();
+    m_frame_stats.vertex_array_binds++;
 
-    // Configure shader state
+    // Configure shader state (uniforms are flushed on bind)
     shader_program->bind();
-    shader_program->set_uniform_1f("u_time", clock() / (float)CLOCKS_PER_SEC);
 
     // Draw object
     GL_CALL(glDrawElements(GL_TRIANGLES, index_buffer->get_count(), gl_type, nullptr));
+    m_frame_stats.draw_calls++;
 
     // Clear GL state
     shader_program->unbind();
@@ -52,4 +78,206 @@ void GL_Renderer::draw(const GL_VertexArray<T>* vertex_array, const GL_DataBuffe
 }
 
 
+void GL_Renderer::bind_vertex_format(const GL_VertexFormat* vertex_format, uint32_t vertex_buffer_id, uint32_t index_buffer_id)
+{
+    // Configure vertex buffer state, skipping bindings which are already current
+    if (m_bound_vertex_format != vertex_format)
+    {
+        vertex_format->bind();
+        m_bound_vertex_format = vertex_format;
+        m_bound_vertex_buffer = 0;
+        m_bound_index_buffer = 0;
+        m_frame_stats.vertex_array_binds++;
+    }
+    if (m_bound_vertex_buffer != vertex_buffer_id)
+    {
+        GL_CALL(glBindVertexBuffer(0, vertex_buffer_id, 0, vertex_format->get_stride()));
+        m_bound_vertex_buffer = vertex_buffer_id;
+        m_frame_stats.vertex_buffer_binds++;
+    }
+    if (m_bound_index_buffer != index_buffer_id)
+    {
+        GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer_id));
+        m_bound_index_buffer = index_buffer_id;
+    }
+}
+
+
+void GL_Renderer::bind_shader_program(GL_ShaderProgram* shader_program)
+{
+    // Configure shader state (uniforms are flushed on bind)
+    shader_program->bind();
+}
+
+
+template<typename T, typename K>
+void GL_Renderer::draw(const GL_VertexFormat* vertex_format, const GL_DataBuffer<T>* vertex_buffer, const GL_DataBuffer<K>* index_buffer, GL_ShaderProgram* shader_program)
+{
+    PROFILE_ZONE("GL_Renderer::draw");
+
+    // Get index buffer data type
+    uint32_t gl_type = get_gl_type<K>();
+
+    bind_vertex_format(vertex_format, vertex_buffer->get_id(), index_buffer->get_id());
+    bind_shader_program(shader_program);
+
+    // Draw object
+    GL_CALL(glDrawElements(GL_TRIANGLES, index_buffer->get_count(), gl_type, nullptr));
+    m_frame_stats.draw_calls++;
+}
+
+
+template<typename T>
+void GL_Renderer::draw(const GL_VertexFormat* vertex_format, const GL_DataBuffer<T>* vertex_buffer, const GL_IndexBuffer* index_buffer, GL_ShaderProgram* shader_program)
+{
+    PROFILE_ZONE("GL_Renderer::draw");
+
+    bind_vertex_format(vertex_format, vertex_buffer->get_id(), index_buffer->get_id());
+    bind_shader_program(shader_program);
+
+    // Draw object
+    GL_CALL(glDrawElements(GL_TRIANGLES, index_buffer->get_count(), index_buffer->get_index_type(), nullptr));
+    m_frame_stats.draw_calls++;
+}
+
+
+void GL_Renderer::draw(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool, GL_MeshHandle mesh_handle, GL_ShaderProgram* shader_program)
+{
+    PROFILE_ZONE("GL_Renderer::draw");
+
+    ASSERT(vertex_format->get_stride() == mesh_pool->get_vertex_stride());
+    const GL_MeshRange& mesh_range = mesh_pool->get_range(mesh_handle);
+
+    bind_vertex_format(vertex_format, mesh_pool->get_vertex_buffer_id(), mesh_pool->get_index_buffer_id());
+    bind_shader_program(shader_program);
+
+    // Draw object; indices are relative to the mesh's base vertex
+    GL_CALL(glDrawElementsBaseVertex(
+        GL_TRIANGLES,
+        mesh_range.index_count,
+        GL_UNSIGNED_INT,
+        (const void*)((uintptr_t)mesh_range.first_index * sizeof(uint32_t)),
+        mesh_range.base_vertex));
+    m_frame_stats.draw_calls++;
+}
+
+
+void GL_Renderer::submit(const CommandList* command_lists, uint32_t list_count)
+{
+    PROFILE_ZONE("GL_Renderer::submit");
+
+    // Programs bound outside the renderer aren't tracked, so the program cache only lives for one submit
+    GL_ShaderProgram* shader_program = nullptr;
+    uint32_t bound_program_id = 0;
+
+    for (uint32_t list_idx = 0; list_idx < list_count; list_idx++)
+    {
+        const uint8_t* command_ptr = command_lists[list_idx].get_data();
+        const uint8_t* command_end = command_ptr + command_lists[list_idx].get_size();
+        while (command_ptr < command_end)
+        {
+            const GL_CommandHeader* header = (const GL_CommandHeader*)command_ptr;
+            command_ptr += header->size;
+
+            switch (header->type)
+            {
+            case GL_CommandType::BIND_PROGRAM:
+            {
+                const GL_CmdBindProgram* command = (const GL_CmdBindProgram*)header;
+                shader_program = command->shader_program;
+                if (shader_program->get_id() != bound_program_id)
+                {
+                    bind_shader_program(shader_program);
+                    bound_program_id = shader_program->get_id();
+                    m_frame_stats.program_binds++;
+                }
+                break;
+            }
+
+            case GL_CommandType::BIND_VERTEX_FORMAT:
+            {
+                const GL_CmdBindVertexFormat* command = (const GL_CmdBindVertexFormat*)header;
+                bind_vertex_format(command->vertex_format, command->vertex_buffer_id, command->index_buffer_id);
+                break;
+            }
+
+            case GL_CommandType::BIND_UNIFORM_RANGE:
+            {
+                const GL_CmdBindUniformRange* command = (const GL_CmdBindUniformRange*)header;
+                GL_CALL(glBindBufferRange(GL_UNIFORM_BUFFER, command->binding_index, command->buffer_id, command->offset, command->size));
+                break;
+            }
+
+            case GL_CommandType::BIND_TEXTURE:
+            {
+                const GL_CmdBindTexture* command = (const GL_CmdBindTexture*)header;
+                GL_CALL(glActiveTexture(GL_TEXTURE0 + command->texture_unit));
+                GL_CALL(glBindTexture(GL_TEXTURE_2D, command->texture_id));
+                break;
+            }
+
+            case GL_CommandType::SET_UNIFORM_MAT4:
+            {
+                const GL_CmdSetUniformMat4* command = (const GL_CmdSetUniformMat4*)header;
+                ASSERT(shader_program);
+                shader_program->set_uniform_mat4(command->name_id, command->matrix);
+                break;
+            }
+
+            case GL_CommandType::DRAW_INDEXED:
+            {
+                const GL_CmdDrawIndexed* command = (const GL_CmdDrawIndexed*)header;
+                ASSERT(shader_program);
+                shader_program->flush_uniforms();
+
+                const void* index_offset = (const void*)((uintptr_t)command->first_index * get_gl_type_size(command->gl_index_type));
+                if (command->instance_count == 1 && !command->base_instance)
+                {
+                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, command->index_count, command->gl_index_type, index_offset, command->base_vertex));
+                }
+                else
+                {
+                    GL_CALL(glDrawElementsInstancedBaseVertexBaseInstance(GL_TRIANGLES, command->index_count, command->gl_index_type,
+                        index_offset, command->instance_count, command->base_vertex, command->base_instance));
+                }
+                m_frame_stats.draw_calls++;
+                break;
+            }
+            }
+        }
+    }
+}
+
+
+void GL_Renderer::draw_indirect(const GL_VertexFormat* vertex_format, const GL_MeshPool* mesh_pool,
+    const GL_DataBuffer<GL_DrawElementsIndirectCommand>* command_buffer, const GL_DataBuffer<uint32_t>* count_buffer,
+    uint32_t max_draw_count, GL_ShaderProgram* shader_program)
+{
+    PROFILE_ZONE("GL_Renderer::draw_indirect");
+
+    ASSERT(vertex_format->get_stride() == mesh_pool->get_vertex_stride());
+
+    bind_vertex_format(vertex_format, mesh_pool->get_vertex_buffer_id(), mesh_pool->get_index_buffer_id());
+    bind_shader_program(shader_program);
+
+    GL_CALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer->get_id()));
+    if (GLEW_ARB_indirect_parameters)
+    {
+        GL_CALL(glBindBuffer(GL_PARAMETER_BUFFER_ARB, count_buffer->get_id()));
+        GL_CALL(glMultiDrawElementsIndirectCountARB(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, 0, max_draw_count, 0));
+        GL_CALL(glBindBuffer(GL_PARAMETER_BUFFER_ARB, 0));
+    }
+    else
+    {
+        GL_CALL(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, max_draw_count, 0));
+    }
+    GL_CALL(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+    m_frame_stats.draw_calls++;
+}
+
+
 template void GL_Renderer::draw<float, uint32_t>(const GL_VertexArray<float>*, const GL_DataBuffer<uint32_t>*, GL_ShaderProgram*);
+template void GL_Renderer::draw<float, uint32_t>(const GL_VertexFormat*, const GL_DataBuffer<float>*, const GL_DataBuffer<uint32_t>*, GL_ShaderProgram*);
+template void GL_Renderer::draw<unsigned char, uint32_t>(const GL_VertexFormat*, const GL_DataBuffer<unsigned char>*, const GL_DataBuffer<uint32_t>*, GL_ShaderProgram*);
+template void GL_Renderer::draw<float>(const GL_VertexFormat*, const GL_DataBuffer<float>*, const GL_IndexBuffer*, GL_ShaderProgram*);
+template void GL_Renderer::draw<unsigned char>(const GL_VertexFormat*, const GL_DataBuffer<unsigned char>*, const GL_IndexBuffer*, GL_ShaderProgram*);
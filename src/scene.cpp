@@ -0,0 +1,231 @@
+#include "scene.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "renderer.h"
+
+
+struct SceneComponentInfo
+{
+    uint32_t size;
+    uint32_t alignment;
+};
+
+
+static std::vector<SceneComponentInfo>& get_component_registry()
+{
+    static std::vector<SceneComponentInfo> component_registry;
+    return component_registry;
+}
+
+
+uint32_t register_scene_component(uint32_t component_size, uint32_t component_alignment)
+{
+    std::vector<SceneComponentInfo>& component_registry = get_component_registry();
+    if (component_registry.size() >= SCENE_MAX_COMPONENT_TYPES)
+    {
+        fprintf(stderr, "ERROR | Scene > More than %u component types registered\n", SCENE_MAX_COMPONENT_TYPES);
+        ASSERT(0);
+    }
+
+    component_registry.push_back({ component_size, component_alignment });
+    return (uint32_t)component_registry.size() - 1;
+}
+
+
+static uint32_t align_offset(uint32_t offset, uint32_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+
+Scene::Scene() :
+    m_entity_count(0)
+{
+    // Archetype 0 holds entities without components
+    get_archetype(0);
+}
+
+
+uint32_t Scene::get_archetype(uint64_t signature)
+{
+    auto it = m_archetype_index.find(signature);
+    if (it != m_archetype_index.end())
+        return it->second;
+
+    const std::vector<SceneComponentInfo>& component_registry = get_component_registry();
+
+    SceneArchetype archetype;
+    archetype.signature = signature;
+    std::fill(std::begin(archetype.component_offsets), std::end(archetype.component_offsets), INVALID_INDEX);
+
+    uint32_t entity_size = sizeof(EntityHandle);
+    for (uint32_t component_type = 0; component_type < SCENE_MAX_COMPONENT_TYPES; component_type++)
+    {
+        if (signature & (1ull << component_type))
+        {
+            archetype.component_types.push_back(component_type);
+            entity_size += component_registry[component_type].size;
+        }
+    }
+
+    // Fit as many entities as possible, then back off until every aligned array fits in the chunk
+    uint32_t capacity = SCENE_CHUNK_SIZE / entity_size;
+    while (true)
+    {
+        uint32_t offset = capacity * sizeof(EntityHandle);
+        for (uint32_t component_type : archetype.component_types)
+        {
+            offset = align_offset(offset, component_registry[component_type].alignment);
+            archetype.component_offsets[component_type] = offset;
+            offset += capacity * component_registry[component_type].size;
+        }
+        if (offset <= SCENE_CHUNK_SIZE)
+            break;
+        capacity--;
+    }
+    ASSERT(capacity > 0);
+    archetype.capacity = capacity;
+
+    uint32_t archetype_idx = (uint32_t)m_archetypes.size();
+    m_archetypes.push_back(std::move(archetype));
+    m_archetype_index[signature] = archetype_idx;
+
+    // Cached queries stay valid by picking up the new archetype
+    for (auto& [query_signature, archetype_indices] : m_query_cache)
+    {
+        if ((signature & query_signature) == query_signature)
+            archetype_indices.push_back(archetype_idx);
+    }
+
+    return archetype_idx;
+}
+
+
+const std::vector<uint32_t>& Scene::match_archetypes(uint64_t signature)
+{
+    auto it = m_query_cache.find(signature);
+    if (it != m_query_cache.end())
+        return it->second;
+
+    std::vector<uint32_t> archetype_indices;
+    for (uint32_t archetype_idx = 0; archetype_idx < m_archetypes.size(); archetype_idx++)
+    {
+        if ((m_archetypes[archetype_idx].signature & signature) == signature)
+            archetype_indices.push_back(archetype_idx);
+    }
+
+    return m_query_cache.emplace(signature, std::move(archetype_indices)).first->second;
+}
+
+
+void Scene::allocate_row(EntityHandle entity, uint32_t archetype_idx)
+{
+    SceneArchetype& archetype = m_archetypes[archetype_idx];
+    if (archetype.chunks.empty() || archetype.chunks.back().count == archetype.capacity)
+        archetype.chunks.push_back({ std::make_unique<SceneChunkStorage>(), 0 });
+
+    SceneChunk& chunk = archetype.chunks.back();
+    uint32_t row = chunk.count++;
+    ((EntityHandle*)chunk.storage->bytes)[row] = entity;
+
+    m_entities[entity] = { archetype_idx, (uint32_t)archetype.chunks.size() - 1, row };
+}
+
+
+void Scene::release_row(const SceneEntityRecord& record)
+{
+    const std::vector<SceneComponentInfo>& component_registry = get_component_registry();
+    SceneArchetype& archetype = m_archetypes[record.archetype];
+    SceneChunk& chunk = archetype.chunks[record.chunk];
+    SceneChunk& last_chunk = archetype.chunks.back();
+    uint32_t last_row = last_chunk.count - 1;
+
+    // Fill the hole with the archetype's last entity
+    if (&chunk != &last_chunk || record.row != last_row)
+    {
+        EntityHandle moved_entity = ((EntityHandle*)last_chunk.storage->bytes)[last_row];
+        ((EntityHandle*)chunk.storage->bytes)[record.row] = moved_entity;
+        for (uint32_t component_type : archetype.component_types)
+        {
+            uint32_t offset = archetype.component_offsets[component_type];
+            uint32_t size = component_registry[component_type].size;
+            memcpy(chunk.storage->bytes + offset + record.row * size, last_chunk.storage->bytes + offset + last_row * size, size);
+        }
+        m_entities[moved_entity].chunk = record.chunk;
+        m_entities[moved_entity].row = record.row;
+    }
+
+    if (!--last_chunk.count)
+        archetype.chunks.pop_back();
+}
+
+
+void Scene::move_entity(EntityHandle entity, uint64_t signature)
+{
+    const std::vector<SceneComponentInfo>& component_registry = get_component_registry();
+    SceneEntityRecord old_record = m_entities[entity];
+    uint32_t archetype_idx = get_archetype(signature);
+    allocate_row(entity, archetype_idx);
+    const SceneEntityRecord& new_record = m_entities[entity];
+
+    // Copy every component both archetypes share; added components are left for the caller to write
+    const SceneArchetype& old_archetype = m_archetypes[old_record.archetype];
+    const SceneArchetype& new_archetype = m_archetypes[archetype_idx];
+    const SceneChunk& old_chunk = old_archetype.chunks[old_record.chunk];
+    const SceneChunk& new_chunk = new_archetype.chunks[new_record.chunk];
+    for (uint32_t component_type : old_archetype.component_types)
+    {
+        if (new_archetype.component_offsets[component_type] == INVALID_INDEX)
+            continue;
+
+        uint32_t size = component_registry[component_type].size;
+        memcpy(new_chunk.storage->bytes + new_archetype.component_offsets[component_type] + new_record.row * size,
+            old_chunk.storage->bytes + old_archetype.component_offsets[component_type] + old_record.row * size, size);
+    }
+
+    release_row(old_record);
+}
+
+
+EntityHandle Scene::create(uint64_t signature)
+{
+    EntityHandle entity;
+    if (!m_free_handles.empty())
+    {
+        entity = m_free_handles.back();
+        m_free_handles.pop_back();
+    }
+    else
+    {
+        entity = (EntityHandle)m_entities.size();
+        m_entities.push_back({ INVALID_INDEX, 0, 0 });
+    }
+
+    allocate_row(entity, get_archetype(signature));
+    m_entity_count++;
+    return entity;
+}
+
+
+void Scene::destroy(EntityHandle entity)
+{
+    ASSERT(is_alive(entity));
+
+    release_row(m_entities[entity]);
+    m_entities[entity] = { INVALID_INDEX, 0, 0 };
+    m_free_handles.push_back(entity);
+    m_entity_count--;
+}
+
+
+void* Scene::get_component(EntityHandle entity, uint32_t component_type) const
+{
+    const SceneEntityRecord& record = m_entities[entity];
+    const SceneArchetype& archetype = m_archetypes[record.archetype];
+    uint32_t offset = archetype.component_offsets[component_type];
+    if (offset == INVALID_INDEX)
+        return nullptr;
+
+    return archetype.chunks[record.chunk].storage->bytes + offset + record.row * get_component_registry()[component_type].size;
+}
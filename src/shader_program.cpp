@@ -1,10 +1,19 @@
 #include "shader_program.h"
 #include "renderer.h"
 #include "file_utils.h"
+#include "string_interner.h"
+#include "profiler.h"
+#include "hot_reload.h"
+#include <cstring>
 #include <iostream>
 
 
-GL_ShaderProgram::GL_ShaderProgram()
+GL_UniformStats GL_ShaderProgram::s_frame_stats = {};
+uint32_t GL_ShaderProgram::s_next_sort_id = 0;
+
+
+GL_ShaderProgram::GL_ShaderProgram() :
+    m_sort_id(s_next_sort_id++), m_work_group_size{ 0, 0, 0 }
 {
     GL_CALL(m_gl_id = glCreateProgram());
     ASSERT(m_gl_id);
@@ -20,6 +29,7 @@ GL_ShaderProgram::GL_ShaderProgram(const std::string& vert_file_path, const std:
 
 GL_ShaderProgram::~GL_ShaderProgram()
 {
+    HotReloader::notify_destroyed(this);
     GL_CALL(glDeleteProgram(m_gl_id));
 }
 
@@ -48,63 +58,274 @@ uint32_t GL_ShaderProgram::compile_shader(uint32_t gl_shader_type, const char* s
 }
 
 
-int32_t GL_ShaderProgram::get_uniform_location(const std::string& uniform_name)
+int32_t GL_ShaderProgram::get_uniform_location(uint32_t name_id)
+{
+    const char* name_raw = get_interned_string(name_id).c_str();
+
+    GL_CALL(int32_t uniform_location = glGetUniformLocation(m_gl_id, name_raw));
+    if (uniform_location == -1)
+    {
+        fprintf(stdout, "WARN | Shader uniform location not found [uniform: %s, shader_program_id: %d]\n", name_raw, m_gl_id);
+    }
+
+    return uniform_location;
+}
+
+
+uint32_t GL_ShaderProgram::link_program(const std::vector<std::string>& stage_sources)
+{
+    ASSERT(stage_sources.size() == m_stages.size());
+
+    std::vector<uint32_t> shader_ids;
+    for (size_t stage_idx = 0; stage_idx < m_stages.size(); stage_idx++)
+    {
+        uint32_t shader_id = compile_shader(m_stages[stage_idx].gl_shader_type, stage_sources[stage_idx].c_str());
+        if (!shader_id)
+        {
+            for (uint32_t compiled_shader_id : shader_ids)
+            {
+                GL_CALL(glDeleteShader(compiled_shader_id));
+            }
+            return 0;
+        }
+        shader_ids.push_back(shader_id);
+    }
+
+    GL_CALL(uint32_t program_id = glCreateProgram());
+    for (uint32_t shader_id : shader_ids)
+    {
+        GL_CALL(glAttachShader(program_id, shader_id));
+    }
+
+    GL_CALL(glLinkProgram(program_id));
+
+    for (uint32_t shader_id : shader_ids)
+    {
+        GL_CALL(glDeleteShader(shader_id));
+    }
+
+    int32_t link_result;
+    GL_CALL(glGetProgramiv(program_id, GL_LINK_STATUS, &link_result));
+    if (link_result == GL_FALSE)
+    {
+        int log_length;
+        GL_CALL(glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &log_length));
+        char* log_message = (char*)alloca(log_length * sizeof(char));
+        GL_CALL(glGetProgramInfoLog(program_id, log_length, &log_length, log_message));
+        GL_CALL(glDeleteProgram(program_id));
+
+        fprintf(stderr, "ERROR | Failed to link shader program\n%s\n", log_message);
+        return 0;
+    }
+
+    GL_CALL(glValidateProgram(program_id));
+
+    return program_id;
+}
+
+
+void GL_ShaderProgram::swap_program(uint32_t gl_program_id)
+{
+    GL_CALL(glDeleteProgram(m_gl_id));
+    m_gl_id = gl_program_id;
+
+    if (m_stages.size() == 1 && m_stages[0].gl_shader_type == GL_COMPUTE_SHADER)
+    {
+        int32_t work_group_size[3];
+        GL_CALL(glGetProgramiv(m_gl_id, GL_COMPUTE_WORK_GROUP_SIZE, work_group_size));
+        for (uint32_t axis = 0; axis < 3; axis++)
+            m_work_group_size[axis] = (uint32_t)work_group_size[axis];
+    }
+
+    // Re-resolve locations and re-upload every shadowed value on the next bind
+    m_dirty_slots.clear();
+    for (uint32_t slot_idx = 0; slot_idx < (uint32_t)m_uniform_slots.size(); slot_idx++)
+    {
+        GL_UniformSlot& uniform_slot = m_uniform_slots[slot_idx];
+        uniform_slot.location = get_uniform_location(uniform_slot.name_id);
+        uniform_slot.dirty = true;
+        m_dirty_slots.push_back(slot_idx);
+    }
+}
+
+
+void GL_ShaderProgram::create(const std::vector<GL_ShaderStage>& stages)
 {
-    const char* name_raw = uniform_name.c_str();
+    PROFILE_ZONE("GL_ShaderProgram::create");
 
-    if (m_uniform_location_cache.find(name_raw) == m_uniform_location_cache.end())
+    // Compute programs can't be combined with any other stage
+    for (const GL_ShaderStage& stage : stages)
     {
-        GL_CALL(int32_t uniform_location = glGetUniformLocation(m_gl_id, name_raw));
-        if (uniform_location == -1)
+        if (stage.gl_shader_type == GL_COMPUTE_SHADER && stages.size() != 1)
         {
-            fprintf(stdout, "WARN | Shader uniform location not found [uniform: %s, shader_program_id: %d]\n", name_raw, m_gl_id);
+            fprintf(stderr, "ERROR | A compute shader must be the only stage of its program [%s]\n", stage.file_path.c_str());
+            ASSERT(0);
+            return;
         }
-        m_uniform_location_cache[name_raw] = uniform_location;
     }
 
-    return m_uniform_location_cache[name_raw];
+    m_stages = stages;
+
+    std::vector<std::string> stage_sources;
+    for (const GL_ShaderStage& stage : m_stages)
+        stage_sources.push_back(read_file(stage.file_path));
+
+    uint32_t program_id = link_program(stage_sources);
+    ASSERT(program_id);
+    swap_program(program_id);
+
+    HotReloader::notify_loaded(this);
 }
 
 
 void GL_ShaderProgram::create(const std::string& vert_file_path, const std::string& frag_file_path)
 {
-    uint32_t vert_shader_id = compile_shader(GL_VERTEX_SHADER, read_file(vert_file_path).c_str());
-    ASSERT(vert_shader_id);
-    uint32_t frag_shader_id = compile_shader(GL_FRAGMENT_SHADER, read_file(frag_file_path).c_str());
-    ASSERT(frag_shader_id);
+    create({ { GL_VERTEX_SHADER, vert_file_path }, { GL_FRAGMENT_SHADER, frag_file_path } });
+}
+
+
+void GL_ShaderProgram::create_compute(const std::string& comp_file_path)
+{
+    create({ { GL_COMPUTE_SHADER, comp_file_path } });
+}
+
+
+bool GL_ShaderProgram::reload(const std::vector<std::string>& stage_sources)
+{
+    /**
+     * NOTE: the replacement program is fully linked before the current one is released, so a
+     * shader which fails to compile leaves the previous program in place
+     */
+    uint32_t program_id = link_program(stage_sources);
+    if (!program_id)
+        return false;
+
+    swap_program(program_id);
+    return true;
+}
+
+
+void GL_ShaderProgram::set_uniform(uint32_t name_id, const GL_UniformValue& value)
+{
+    auto it = m_uniform_slot_index.find(name_id);
+    if (it == m_uniform_slot_index.end())
+    {
+        it = m_uniform_slot_index.emplace(name_id, (uint32_t)m_uniform_slots.size()).first;
+        // A zero `gl_type` matches no written value, so the first write is always uploaded
+        m_uniform_slots.push_back({ name_id, get_uniform_location(name_id), false, GL_UniformValue{} });
+    }
+
+    GL_UniformSlot& uniform_slot = m_uniform_slots[it->second];
+    if (uniform_slot.value.gl_type == value.gl_type && !memcmp(uniform_slot.value.f, value.f, sizeof(value.f)))
+    {
+        s_frame_stats.redundant++;
+        return;
+    }
+
+    uniform_slot.value = value;
+    if (!uniform_slot.dirty)
+    {
+        uniform_slot.dirty = true;
+        m_dirty_slots.push_back(it->second);
+    }
+}
+
+
+void GL_ShaderProgram::flush_uniforms()
+{
+    for (uint32_t slot_idx : m_dirty_slots)
+    {
+        GL_UniformSlot& uniform_slot = m_uniform_slots[slot_idx];
+        uniform_slot.dirty = false;
+        if (uniform_slot.location == -1)
+            continue;
+
+        switch (uniform_slot.value.gl_type)
+        {
+        case GL_INT:
+            GL_CALL(glUniform1i(uniform_slot.location, uniform_slot.value.i[0]));
+            break;
+
+        case GL_FLOAT:
+            GL_CALL(glUniform1f(uniform_slot.location, uniform_slot.value.f[0]));
+            break;
+
+        case GL_FLOAT_VEC4:
+            GL_CALL(glUniform4fv(uniform_slot.location, 1, uniform_slot.value.f));
+            break;
+
+        case GL_FLOAT_MAT4:
+            GL_CALL(glUniformMatrix4fv(uniform_slot.location, 1, GL_FALSE, uniform_slot.value.f));
+            break;
+        }
+        s_frame_stats.uploads++;
+    }
+    m_dirty_slots.clear();
+}
+
+
+void GL_ShaderProgram::set_uniform_1i(uint32_t name_id, int32_t value)
+{
+    GL_UniformValue uniform_value = { GL_INT, { value } };
+    set_uniform(name_id, uniform_value);
+}
+
+
+void GL_ShaderProgram::set_uniform_1f(uint32_t name_id, float value)
+{
+    GL_UniformValue uniform_value = { GL_FLOAT, { 0 } };
+    uniform_value.f[0] = value;
+    set_uniform(name_id, uniform_value);
+}
+
+
+void GL_ShaderProgram::set_uniform_4f(uint32_t name_id, float v0, float v1, float v2, float v3)
+{
+    GL_UniformValue uniform_value = { GL_FLOAT_VEC4, { 0 } };
+    uniform_value.f[0] = v0;
+    uniform_value.f[1] = v1;
+    uniform_value.f[2] = v2;
+    uniform_value.f[3] = v3;
+    set_uniform(name_id, uniform_value);
+}
+
 
-    GL_CALL(glAttachShader(m_gl_id, vert_shader_id));
-    GL_CALL(glAttachShader(m_gl_id, frag_shader_id));
+void GL_ShaderProgram::set_uniform_mat4(uint32_t name_id, const float* matrix)
+{
+    GL_UniformValue uniform_value = { GL_FLOAT_MAT4, { 0 } };
+    memcpy(uniform_value.f, matrix, sizeof(uniform_value.f));
+    set_uniform(name_id, uniform_value);
+}
 
-    GL_CALL(glLinkProgram(m_gl_id));
-    GL_CALL(glValidateProgram(m_gl_id));
 
-    GL_CALL(glDeleteShader(vert_shader_id));
-    GL_CALL(glDeleteShader(frag_shader_id));
+void GL_ShaderProgram::set_uniform_1i(std::string_view uniform_name, int32_t value)
+{
+    set_uniform_1i(intern_string(uniform_name), value);
 }
 
 
-void GL_ShaderProgram::set_uniform_1i(const std::string& uniform_name, int32_t value)
+void GL_ShaderProgram::set_uniform_1f(std::string_view uniform_name, float value)
 {
-    GL_CALL(glUniform1i(get_uniform_location(uniform_name), value));
+    set_uniform_1f(intern_string(uniform_name), value);
 }
 
 
-void GL_ShaderProgram::set_uniform_1f(const std::string& uniform_name, float value)
+void GL_ShaderProgram::set_uniform_4f(std::string_view uniform_name, float v0, float v1, float v2, float v3)
 {
-    GL_CALL(glUniform1f(get_uniform_location(uniform_name), value));
+    set_uniform_4f(intern_string(uniform_name), v0, v1, v2, v3);
 }
 
 
-void GL_ShaderProgram::set_uniform_4f(const std::string& uniform_name, float v0, float v1, float v2, float v3)
+void GL_ShaderProgram::set_uniform_mat4(std::string_view uniform_name, const float* matrix)
 {
-    GL_CALL(glUniform4f(get_uniform_location(uniform_name), v0, v1, v2, v3));
+    set_uniform_mat4(intern_string(uniform_name), matrix);
 }
 
 
-void GL_ShaderProgram::bind() const
+void GL_ShaderProgram::bind()
 {
     GL_CALL(glUseProgram(m_gl_id));
+    flush_uniforms();
 }
 
 
@@ -112,3 +333,53 @@ void GL_ShaderProgram::unbind() const
 {
     GL_CALL(glUseProgram(0));
 }
+
+
+void GL_ShaderProgram::dispatch(uint32_t group_count_x, uint32_t group_count_y, uint32_t group_count_z)
+{
+    bind();
+    GL_CALL(glDispatchCompute(group_count_x, group_count_y, group_count_z));
+}
+
+
+void GL_ShaderProgram::dispatch_invocations(uint32_t invocation_count_x, uint32_t invocation_count_y, uint32_t invocation_count_z)
+{
+    ASSERT(m_work_group_size[0] && m_work_group_size[1] && m_work_group_size[2]);
+    dispatch(
+        (invocation_count_x + m_work_group_size[0] - 1) / m_work_group_size[0],
+        (invocation_count_y + m_work_group_size[1] - 1) / m_work_group_size[1],
+        (invocation_count_z + m_work_group_size[2] - 1) / m_work_group_size[2]);
+}
+
+
+void GL_ShaderProgram::dispatch_indirect(uint32_t dispatch_buffer_id, uint32_t byte_offset)
+{
+    bind();
+    GL_CALL(glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, dispatch_buffer_id));
+    GL_CALL(glDispatchComputeIndirect((GLintptr)byte_offset));
+    GL_CALL(glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0));
+}
+
+
+void GL_ShaderProgram::bind_storage_buffer(uint32_t binding_index, uint32_t buffer_id)
+{
+    GL_CALL(glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding_index, buffer_id));
+}
+
+
+void GL_ShaderProgram::bind_image(uint32_t image_unit, uint32_t texture_id, uint32_t gl_access, uint32_t gl_format, uint32_t level)
+{
+    // Layered textures bind every layer
+    GL_CALL(glBindImageTexture(image_unit, texture_id, level, GL_TRUE, 0, gl_access, gl_format));
+}
+
+
+void GL_ShaderProgram::memory_barrier(uint32_t gl_barrier_bits)
+{
+    /**
+     * Barrier bits name how the data will be *consumed* next, e.g. GL_SHADER_STORAGE_BARRIER_BIT before
+     * another dispatch reads an SSBO, GL_COMMAND_BARRIER_BIT before indirect draws/dispatches and
+     * GL_TEXTURE_FETCH_BARRIER_BIT before sampling a texture written through an image
+     */
+    GL_CALL(glMemoryBarrier(gl_barrier_bits));
+}
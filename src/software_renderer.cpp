@@ -0,0 +1,728 @@
+#include "software_renderer.h"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include "job_system.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "simd_utils.h"
+#include "vertex_packing.h"
+
+
+static const uint32_t SOFTWARE_MIN_VERTICES_PER_JOB = 1024;
+static const uint32_t SOFTWARE_MIN_TRIANGLES_PER_JOB = 512;
+// Clipping a triangle against the near and far planes leaves at most a pentagon, fanned into 3 triangles
+static const uint32_t SOFTWARE_MAX_CLIPPED_VERTICES = 5;
+static const uint32_t SOFTWARE_MAX_CLIPPED_TRIANGLES = SOFTWARE_MAX_CLIPPED_VERTICES - 2;
+// Tiles are only rejected/accepted whole when every corner is this far (in pixels) past an edge
+static const float SOFTWARE_TILE_EDGE_MARGIN = 1.0f / 64.0f;
+// Queued uniform structs start at this alignment (any scalar or pointer member)
+static const size_t SOFTWARE_UNIFORM_ALIGNMENT = alignof(std::max_align_t);
+
+
+static float decode_component(const uint8_t* data, uint32_t gl_type, bool normalized)
+{
+    switch (gl_type)
+    {
+    case GL_FLOAT: { float value; memcpy(&value, data, sizeof(value)); return value; }
+    case GL_DOUBLE: { double value; memcpy(&value, data, sizeof(value)); return (float)value; }
+    case GL_HALF_FLOAT: { GL_Half value; memcpy(&value, data, sizeof(value)); return unpack_half(value); }
+    case GL_UNSIGNED_BYTE: return normalized ? *data / 255.0f : (float)*data;
+    case GL_BYTE: { int8_t value = (int8_t)*data; return normalized ? std::max(value / 127.0f, -1.0f) : (float)value; }
+    case GL_UNSIGNED_SHORT: { uint16_t value; memcpy(&value, data, sizeof(value)); return normalized ? value / 65535.0f : (float)value; }
+    case GL_SHORT: { int16_t value; memcpy(&value, data, sizeof(value)); return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value; }
+    case GL_UNSIGNED_INT: { uint32_t value; memcpy(&value, data, sizeof(value)); return normalized ? (float)(value / 4294967295.0) : (float)value; }
+    case GL_INT: { int32_t value; memcpy(&value, data, sizeof(value)); return normalized ? (float)std::max(value / 2147483647.0, -1.0) : (float)value; }
+    }
+    return 0.0f;
+}
+
+
+// Decodes one attribute the way the vertex puller would: missing components default to (0, 0, 0, 1)
+static void decode_attribute(const uint8_t* vertex_data, const GL_AttribElement& element, float* attribute)
+{
+    attribute[0] = 0.0f;
+    attribute[1] = 0.0f;
+    attribute[2] = 0.0f;
+    attribute[3] = 1.0f;
+
+    const uint8_t* data = vertex_data + element.offset;
+    uint32_t component_count = std::min(element.component_count, 4u);
+    if (element.gl_type == GL_INT_2_10_10_10_REV)
+    {
+        uint32_t bits;
+        memcpy(&bits, data, sizeof(bits));
+        const int32_t components[4] = { (int32_t)(bits << 22) >> 22, (int32_t)(bits << 12) >> 22, (int32_t)(bits << 2) >> 22, (int32_t)bits >> 30 };
+        for (uint32_t component = 0; component < component_count; component++)
+        {
+            float scale = component < 3 ? 511.0f : 1.0f;
+            attribute[component] = element.normalized ? std::max(components[component] / scale, -1.0f) : (float)components[component];
+        }
+        return;
+    }
+
+    size_t component_size = get_gl_type_size(element.gl_type);
+    for (uint32_t component = 0; component < component_count; component++)
+        attribute[component] = decode_component(data + component * component_size, element.gl_type, element.normalized);
+}
+
+
+static inline uint8_t to_unorm8(float value)
+{
+    // NaN goes to 0
+    value = value > 0.0f ? (value < 1.0f ? value : 1.0f) : 0.0f;
+    return (uint8_t)(value * 255.0f + 0.5f);
+}
+
+
+SoftwareTexture::SoftwareTexture() :
+    m_width(0), m_height(0)
+{
+}
+
+
+SoftwareTexture::SoftwareTexture(const GL_ImageData& image_data) :
+    SoftwareTexture()
+{
+    set_image(image_data);
+}
+
+
+void SoftwareTexture::load_image(const std::string& image_file_path, bool flip_vertically)
+{
+    // Same decode as `GL_Texture2D::load_image`, so both backends sample the same texels
+    GL_ImageData image_data = GL_Texture2D::decode_image(image_file_path, flip_vertically, 0);
+    set_image(image_data);
+    GL_Texture2D::free_image(image_data);
+}
+
+
+void SoftwareTexture::set_image(const GL_ImageData& image_data)
+{
+    m_texels.clear();
+    m_width = 0;
+    m_height = 0;
+    if (!image_data.pixels || image_data.channels < 1 || image_data.channels > 4)
+        return;
+
+    // Expanded to RGBA as GL does: missing color channels read 0, missing alpha 1
+    m_width = image_data.width;
+    m_height = image_data.height;
+    m_texels.resize((size_t)m_width * m_height);
+    const uint8_t* src = image_data.pixels;
+    for (size_t texel_idx = 0; texel_idx < m_texels.size(); texel_idx++, src += image_data.channels)
+    {
+        uint8_t texel[4] = { 0, 0, 0, 255 };
+        memcpy(texel, src, image_data.channels);
+        memcpy(&m_texels[texel_idx], texel, sizeof(texel));
+    }
+}
+
+
+void SoftwareTexture::sample(float u, float v, float* rgba) const
+{
+    if (m_texels.empty())
+    {
+        rgba[0] = rgba[1] = rgba[2] = 0.0f;
+        rgba[3] = 1.0f;
+        return;
+    }
+
+    // GL_LINEAR with GL_CLAMP_TO_EDGE: blend the 4 texels around (u, v), texel centers at half coordinates
+    float s = u * m_width - 0.5f;
+    float t = v * m_height - 0.5f;
+    s = s >= -1.0f ? (s <= (float)m_width ? s : (float)m_width) : -1.0f;
+    t = t >= -1.0f ? (t <= (float)m_height ? t : (float)m_height) : -1.0f;
+    float s_floor = std::floor(s);
+    float t_floor = std::floor(t);
+    float s_weight = s - s_floor;
+    float t_weight = t - t_floor;
+
+    int32_t x0 = std::clamp((int32_t)s_floor, 0, m_width - 1);
+    int32_t x1 = std::clamp((int32_t)s_floor + 1, 0, m_width - 1);
+    int32_t y0 = std::clamp((int32_t)t_floor, 0, m_height - 1);
+    int32_t y1 = std::clamp((int32_t)t_floor + 1, 0, m_height - 1);
+    const uint8_t* texel00 = (const uint8_t*)&m_texels[(size_t)y0 * m_width + x0];
+    const uint8_t* texel10 = (const uint8_t*)&m_texels[(size_t)y0 * m_width + x1];
+    const uint8_t* texel01 = (const uint8_t*)&m_texels[(size_t)y1 * m_width + x0];
+    const uint8_t* texel11 = (const uint8_t*)&m_texels[(size_t)y1 * m_width + x1];
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        float bottom = texel00[channel] + (texel10[channel] - texel00[channel]) * s_weight;
+        float top = texel01[channel] + (texel11[channel] - texel01[channel]) * s_weight;
+        rgba[channel] = (bottom + (top - bottom) * t_weight) * (1.0f / 255.0f);
+    }
+}
+
+
+void SoftwareTexture::sample(const float* u, const float* v, [[maybe_unused]] uint32_t mask, float (*rgba)[SOFTWARE_TILE_SIZE]) const
+{
+#if defined(SIMD_AVX2)
+    if (m_texels.empty())
+    {
+        for (uint32_t channel = 0; channel < 4; channel++)
+            _mm256_storeu_ps(rgba[channel], _mm256_set1_ps(channel == 3 ? 1.0f : 0.0f));
+        return;
+    }
+
+    // As the scalar path, gathering the 4 texels of every lane (gathers cost the same whatever the mask); max/min order maps NaN to -1
+    __m256 s = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(u), _mm256_set1_ps((float)m_width)), _mm256_set1_ps(0.5f));
+    __m256 t = _mm256_sub_ps(_mm256_mul_ps(_mm256_loadu_ps(v), _mm256_set1_ps((float)m_height)), _mm256_set1_ps(0.5f));
+    s = _mm256_min_ps(_mm256_max_ps(s, _mm256_set1_ps(-1.0f)), _mm256_set1_ps((float)m_width));
+    t = _mm256_min_ps(_mm256_max_ps(t, _mm256_set1_ps(-1.0f)), _mm256_set1_ps((float)m_height));
+    __m256 s_floor = _mm256_floor_ps(s);
+    __m256 t_floor = _mm256_floor_ps(t);
+    __m256 s_weight = _mm256_sub_ps(s, s_floor);
+    __m256 t_weight = _mm256_sub_ps(t, t_floor);
+
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max_x = _mm256_set1_epi32(m_width - 1);
+    const __m256i max_y = _mm256_set1_epi32(m_height - 1);
+    __m256i x = _mm256_cvttps_epi32(s_floor);
+    __m256i y = _mm256_cvttps_epi32(t_floor);
+    __m256i x0 = _mm256_min_epi32(_mm256_max_epi32(x, zero), max_x);
+    __m256i x1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(x, one), zero), max_x);
+    __m256i row0 = _mm256_mullo_epi32(_mm256_min_epi32(_mm256_max_epi32(y, zero), max_y), _mm256_set1_epi32(m_width));
+    __m256i row1 = _mm256_mullo_epi32(_mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(y, one), zero), max_y), _mm256_set1_epi32(m_width));
+
+    const int32_t* texels = (const int32_t*)m_texels.data();
+    __m256i texel00 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row0, x0), 4);
+    __m256i texel10 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row0, x1), 4);
+    __m256i texel01 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row1, x0), 4);
+    __m256i texel11 = _mm256_i32gather_epi32(texels, _mm256_add_epi32(row1, x1), 4);
+
+    const __m256i channel_mask = _mm256_set1_epi32(0xFF);
+    auto unpack = [&channel_mask](__m256i texel, uint32_t channel) {
+        return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(texel, channel * 8), channel_mask));
+    };
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        __m256 value00 = unpack(texel00, channel), value10 = unpack(texel10, channel);
+        __m256 value01 = unpack(texel01, channel), value11 = unpack(texel11, channel);
+        __m256 bottom = _mm256_add_ps(value00, _mm256_mul_ps(_mm256_sub_ps(value10, value00), s_weight));
+        __m256 top = _mm256_add_ps(value01, _mm256_mul_ps(_mm256_sub_ps(value11, value01), s_weight));
+        __m256 value = _mm256_add_ps(bottom, _mm256_mul_ps(_mm256_sub_ps(top, bottom), t_weight));
+        _mm256_storeu_ps(rgba[channel], _mm256_mul_ps(value, _mm256_set1_ps(1.0f / 255.0f)));
+    }
+#else
+    for (uint32_t lanes = mask; lanes; lanes &= lanes - 1)
+    {
+        uint32_t lane = (uint32_t)std::countr_zero(lanes);
+        float texel[4];
+        sample(u[lane], v[lane], texel);
+        for (uint32_t channel = 0; channel < 4; channel++)
+            rgba[channel][lane] = texel[channel];
+    }
+#endif
+}
+
+
+SoftwareRenderer::SoftwareRenderer(uint32_t width, uint32_t height) :
+    m_width(0), m_height(0), m_depth_test(false), m_cull_back_faces(false), m_clear_pending(false), m_clear_color(0), m_clear_depth(1.0f),
+    m_bin_columns(0), m_bin_rows(0), m_frame_stats()
+{
+    resize(width, height);
+}
+
+
+void SoftwareRenderer::resize(uint32_t width, uint32_t height)
+{
+    m_width = width;
+    m_height = height;
+    m_color_buffer.assign((size_t)width * height, 0);
+    m_depth_buffer.assign((size_t)width * height, 1.0f);
+
+    m_bin_columns = (width + SOFTWARE_BIN_SIZE - 1) / SOFTWARE_BIN_SIZE;
+    m_bin_rows = (height + SOFTWARE_BIN_SIZE - 1) / SOFTWARE_BIN_SIZE;
+    discard_draws();
+    m_clear_pending = false;
+    m_bins.resize((size_t)m_bin_columns * m_bin_rows);
+}
+
+
+void SoftwareRenderer::clear(float red, float green, float blue, float alpha, float depth)
+{
+    const uint8_t channels[4] = { to_unorm8(red), to_unorm8(green), to_unorm8(blue), to_unorm8(alpha) };
+    memcpy(&m_clear_color, channels, sizeof(m_clear_color));
+    m_clear_depth = depth;
+    m_clear_pending = true;
+    discard_draws();
+}
+
+
+void SoftwareRenderer::setup_triangles(const SoftwareVertex* const vertices[3], uint32_t varying_count, SoftwareTriangle* triangles) const
+{
+    for (uint32_t triangle_idx = 0; triangle_idx < SOFTWARE_MAX_CLIPPED_TRIANGLES; triangle_idx++)
+        triangles[triangle_idx].valid = false;
+
+    // Distances to the near (z >= -w) and far (z <= w) planes; x/y are left to the bounds clamp
+    bool inside = true;
+    uint32_t outside_near = 0, outside_far = 0;
+    for (uint32_t vertex_idx = 0; vertex_idx < 3; vertex_idx++)
+    {
+        const float* position = vertices[vertex_idx]->position;
+        bool near = position[3] + position[2] >= 0.0f;
+        bool far = position[3] - position[2] >= 0.0f;
+        inside &= near && far;
+        outside_near += !near;
+        outside_far += !far;
+    }
+    if (inside)
+    {
+        setup_triangle(vertices, varying_count, triangles[0]);
+        return;
+    }
+    if (outside_near == 3 || outside_far == 3)
+        return;
+
+    // Sutherland-Hodgman against each plane in turn
+    SoftwareVertex clipped_vertices[4];
+    uint32_t clipped_count = 0;
+    const SoftwareVertex* polygon[SOFTWARE_MAX_CLIPPED_VERTICES] = { vertices[0], vertices[1], vertices[2] };
+    uint32_t polygon_count = 3;
+    for (float plane_sign : { 1.0f, -1.0f })
+    {
+        const SoftwareVertex* clipped_polygon[SOFTWARE_MAX_CLIPPED_VERTICES];
+        uint32_t clipped_polygon_count = 0;
+        for (uint32_t vertex_idx = 0; vertex_idx < polygon_count; vertex_idx++)
+        {
+            const SoftwareVertex* current = polygon[vertex_idx];
+            const SoftwareVertex* next = polygon[(vertex_idx + 1) % polygon_count];
+            float current_distance = current->position[3] + plane_sign * current->position[2];
+            float next_distance = next->position[3] + plane_sign * next->position[2];
+            if (current_distance >= 0.0f)
+                clipped_polygon[clipped_polygon_count++] = current;
+            if ((current_distance >= 0.0f) == (next_distance >= 0.0f))
+                continue;
+
+            // Always interpolated from the inside vertex, so triangles sharing the edge clip it identically
+            const SoftwareVertex* inside_vertex = current_distance >= 0.0f ? current : next;
+            const SoftwareVertex* outside_vertex = current_distance >= 0.0f ? next : current;
+            float inside_distance = current_distance >= 0.0f ? current_distance : next_distance;
+            float outside_distance = current_distance >= 0.0f ? next_distance : current_distance;
+            float t = inside_distance / (inside_distance - outside_distance);
+
+            SoftwareVertex& clipped_vertex = clipped_vertices[clipped_count++];
+            for (uint32_t component = 0; component < 4; component++)
+                clipped_vertex.position[component] = inside_vertex->position[component] + (outside_vertex->position[component] - inside_vertex->position[component]) * t;
+            for (uint32_t varying = 0; varying < varying_count; varying++)
+                clipped_vertex.varyings[varying] = inside_vertex->varyings[varying] + (outside_vertex->varyings[varying] - inside_vertex->varyings[varying]) * t;
+            clipped_polygon[clipped_polygon_count++] = &clipped_vertex;
+        }
+
+        std::copy(clipped_polygon, clipped_polygon + clipped_polygon_count, polygon);
+        polygon_count = clipped_polygon_count;
+        if (polygon_count < 3)
+            return;
+    }
+
+    for (uint32_t vertex_idx = 1; vertex_idx + 1 < polygon_count; vertex_idx++)
+    {
+        const SoftwareVertex* const fan_vertices[3] = { polygon[0], polygon[vertex_idx], polygon[vertex_idx + 1] };
+        setup_triangle(fan_vertices, varying_count, triangles[vertex_idx - 1]);
+    }
+}
+
+
+void SoftwareRenderer::setup_triangle(const SoftwareVertex* const vertices[3], uint32_t varying_count, SoftwareTriangle& triangle) const
+{
+    // Perspective divide and viewport transform
+    float x[3], y[3];
+    for (uint32_t vertex_idx = 0; vertex_idx < 3; vertex_idx++)
+    {
+        const float* position = vertices[vertex_idx]->position;
+        if (!(position[3] > 0.0f))
+            return;
+
+        float inverse_w = 1.0f / position[3];
+        x[vertex_idx] = (position[0] * inverse_w * 0.5f + 0.5f) * m_width;
+        y[vertex_idx] = (position[1] * inverse_w * 0.5f + 0.5f) * m_height;
+        triangle.z[vertex_idx] = position[2] * inverse_w * 0.5f + 0.5f;
+        triangle.inverse_w[vertex_idx] = inverse_w;
+    }
+
+    float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+    if (!(std::fabs(area) > 0.0f))
+        return;
+
+    // Rasterize counter-clockwise; clockwise triangles are back faces
+    uint32_t order[3] = { 0, 1, 2 };
+    if (area < 0.0f)
+    {
+        if (m_cull_back_faces)
+            return;
+
+        std::swap(order[1], order[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+        std::swap(triangle.inverse_w[1], triangle.inverse_w[2]);
+        area = -area;
+    }
+
+    float min_x = std::floor(std::min({ x[0], x[1], x[2] }));
+    float min_y = std::floor(std::min({ y[0], y[1], y[2] }));
+    float max_x = std::ceil(std::max({ x[0], x[1], x[2] }));
+    float max_y = std::ceil(std::max({ y[0], y[1], y[2] }));
+    if (max_x < 0.0f || max_y < 0.0f || min_x > (float)m_width - 1.0f || min_y > (float)m_height - 1.0f)
+        return;
+
+    triangle.min_x = (int32_t)std::max(min_x, 0.0f);
+    triangle.min_y = (int32_t)std::max(min_y, 0.0f);
+    triangle.max_x = (int32_t)std::min(max_x, (float)m_width - 1.0f);
+    triangle.max_y = (int32_t)std::min(max_y, (float)m_height - 1.0f);
+
+    /**
+     * Edge k runs from vertex k + 1 to vertex k + 2 and is positive inside. It is evaluated from its
+     * lexicographically smaller endpoint, then sign-corrected, so a neighbour sharing the edge computes
+     * the exact negation and the fill rule (top and left edges own their pixels) splits them cleanly
+     */
+    triangle.top_left_mask = 0;
+    for (uint32_t edge_idx = 0; edge_idx < 3; edge_idx++)
+    {
+        uint32_t begin = order[(edge_idx + 1) % 3];
+        uint32_t end = order[(edge_idx + 2) % 3];
+        float dx = x[end] - x[begin];
+        float dy = y[end] - y[begin];
+        if (dy < 0.0f || (dy == 0.0f && dx < 0.0f))
+            triangle.top_left_mask |= 1u << edge_idx;
+
+        bool flip = y[end] < y[begin] || (y[end] == y[begin] && x[end] < x[begin]);
+        uint32_t origin = flip ? end : begin;
+        triangle.edge_x[edge_idx] = x[origin];
+        triangle.edge_y[edge_idx] = y[origin];
+        triangle.edge_dx[edge_idx] = flip ? -dx : dx;
+        triangle.edge_dy[edge_idx] = flip ? -dy : dy;
+        triangle.edge_sign[edge_idx] = flip ? -1.0f : 1.0f;
+    }
+    triangle.inverse_area = 1.0f / area;
+
+    // Varyings are interpolated as v/w and divided by the interpolated 1/w per fragment
+    for (uint32_t vertex_idx = 0; vertex_idx < 3; vertex_idx++)
+    {
+        const SoftwareVertex* vertex = vertices[order[vertex_idx]];
+        for (uint32_t varying = 0; varying < varying_count; varying++)
+            triangle.varyings[vertex_idx][varying] = vertex->varyings[varying] * triangle.inverse_w[vertex_idx];
+    }
+    triangle.valid = true;
+}
+
+
+static inline float evaluate_edge(const SoftwareTriangle& triangle, uint32_t edge_idx, float x, float y)
+{
+    return triangle.edge_sign[edge_idx] *
+        (triangle.edge_dx[edge_idx] * (y - triangle.edge_y[edge_idx]) - triangle.edge_dy[edge_idx] * (x - triangle.edge_x[edge_idx]));
+}
+
+
+/**
+ * Coverage of one 8-pixel row starting at `x` (restricted to `lane_mask`), with the covered fragments'
+ * window position, depth and perspective-correct varyings written to `fragments`
+ */
+static uint32_t rasterize_row(const SoftwareTriangle& triangle, int32_t x, int32_t y, uint32_t lane_mask, bool covered,
+    uint32_t varying_count, SoftwareFragments& fragments)
+{
+#if defined(SIMD_AVX2)
+    const __m256 pixel_x = _mm256_add_ps(_mm256_set1_ps((float)x), _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f));
+    const __m256 pixel_y = _mm256_set1_ps(y + 0.5f);
+    const __m256 zero = _mm256_setzero_ps();
+
+    __m256 weights[3];
+    uint32_t mask = lane_mask;
+    for (uint32_t edge_idx = 0; edge_idx < 3; edge_idx++)
+    {
+        __m256 value = _mm256_sub_ps(
+            _mm256_mul_ps(_mm256_set1_ps(triangle.edge_dx[edge_idx]), _mm256_sub_ps(pixel_y, _mm256_set1_ps(triangle.edge_y[edge_idx]))),
+            _mm256_mul_ps(_mm256_set1_ps(triangle.edge_dy[edge_idx]), _mm256_sub_ps(pixel_x, _mm256_set1_ps(triangle.edge_x[edge_idx]))));
+        value = _mm256_mul_ps(value, _mm256_set1_ps(triangle.edge_sign[edge_idx]));
+        if (!covered)
+        {
+            __m256 inside = triangle.top_left_mask & (1u << edge_idx) ? _mm256_cmp_ps(value, zero, _CMP_GE_OQ) : _mm256_cmp_ps(value, zero, _CMP_GT_OQ);
+            mask &= (uint32_t)_mm256_movemask_ps(inside);
+            if (!mask)
+                return 0;
+        }
+        weights[edge_idx] = _mm256_mul_ps(value, _mm256_set1_ps(triangle.inverse_area));
+    }
+
+    auto interpolate = [&weights](const float* values) {
+        return _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(weights[0], _mm256_set1_ps(values[0])),
+            _mm256_mul_ps(weights[1], _mm256_set1_ps(values[1]))),
+            _mm256_mul_ps(weights[2], _mm256_set1_ps(values[2])));
+    };
+    _mm256_storeu_ps(fragments.x, pixel_x);
+    _mm256_storeu_ps(fragments.y, pixel_y);
+    _mm256_storeu_ps(fragments.z, interpolate(triangle.z));
+    __m256 w = _mm256_div_ps(_mm256_set1_ps(1.0f), interpolate(triangle.inverse_w));
+    for (uint32_t varying = 0; varying < varying_count; varying++)
+    {
+        const float values[3] = { triangle.varyings[0][varying], triangle.varyings[1][varying], triangle.varyings[2][varying] };
+        _mm256_storeu_ps(fragments.varyings[varying], _mm256_mul_ps(interpolate(values), w));
+    }
+#else
+    uint32_t mask = lane_mask;
+    float weights[3][SOFTWARE_TILE_SIZE];
+    float pixel_y = y + 0.5f;
+    for (uint32_t lane = 0; lane < SOFTWARE_TILE_SIZE; lane++)
+    {
+        float pixel_x = x + lane + 0.5f;
+        for (uint32_t edge_idx = 0; edge_idx < 3; edge_idx++)
+        {
+            float value = evaluate_edge(triangle, edge_idx, pixel_x, pixel_y);
+            bool inside = triangle.top_left_mask & (1u << edge_idx) ? value >= 0.0f : value > 0.0f;
+            if (!covered && !inside)
+                mask &= ~(1u << lane);
+            weights[edge_idx][lane] = value * triangle.inverse_area;
+        }
+    }
+    if (!mask)
+        return 0;
+
+    for (uint32_t lane = 0; lane < SOFTWARE_TILE_SIZE; lane++)
+    {
+        float weight0 = weights[0][lane], weight1 = weights[1][lane], weight2 = weights[2][lane];
+        fragments.x[lane] = x + lane + 0.5f;
+        fragments.y[lane] = pixel_y;
+        fragments.z[lane] = weight0 * triangle.z[0] + weight1 * triangle.z[1] + weight2 * triangle.z[2];
+        float w = 1.0f / (weight0 * triangle.inverse_w[0] + weight1 * triangle.inverse_w[1] + weight2 * triangle.inverse_w[2]);
+        for (uint32_t varying = 0; varying < varying_count; varying++)
+        {
+            fragments.varyings[varying][lane] =
+                (weight0 * triangle.varyings[0][varying] + weight1 * triangle.varyings[1][varying] + weight2 * triangle.varyings[2][varying]) * w;
+        }
+    }
+#endif
+    return mask;
+}
+
+
+// Converts the shaded row to RGBA8 and stores the lanes in `mask`
+static void write_row(uint32_t* pixels, const SoftwareColors& colors, uint32_t mask)
+{
+#if defined(SIMD_AVX2)
+    // max/min order maps NaN to 0, as `to_unorm8` does
+    __m256i packed = _mm256_setzero_si256();
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        __m256 value = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(colors.rgba[channel]), _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        __m256i unorm = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(value, _mm256_set1_ps(255.0f)), _mm256_set1_ps(0.5f)));
+        packed = _mm256_or_si256(packed, _mm256_slli_epi32(unorm, channel * 8));
+    }
+    const __m256i lane_bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    __m256i lane_mask = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int32_t)mask), lane_bits), lane_bits);
+    _mm256_maskstore_epi32((int32_t*)pixels, lane_mask, packed);
+#else
+    for (uint32_t lanes = mask; lanes; lanes &= lanes - 1)
+    {
+        uint32_t lane = (uint32_t)std::countr_zero(lanes);
+        uint8_t* pixel = (uint8_t*)(pixels + lane);
+        for (uint32_t channel = 0; channel < 4; channel++)
+            pixel[channel] = to_unorm8(colors.rgba[channel][lane]);
+    }
+#endif
+}
+
+
+uint32_t SoftwareRenderer::rasterize_bin(uint32_t bin_idx)
+{
+    int32_t bin_min_x = (int32_t)(bin_idx % m_bin_columns * SOFTWARE_BIN_SIZE);
+    int32_t bin_min_y = (int32_t)(bin_idx / m_bin_columns * SOFTWARE_BIN_SIZE);
+    int32_t bin_max_x = std::min(bin_min_x + (int32_t)SOFTWARE_BIN_SIZE, (int32_t)m_width) - 1;
+    int32_t bin_max_y = std::min(bin_min_y + (int32_t)SOFTWARE_BIN_SIZE, (int32_t)m_height) - 1;
+    const int32_t tile_size = (int32_t)SOFTWARE_TILE_SIZE;
+
+    if (m_clear_pending)
+    {
+        for (int32_t y = bin_min_y; y <= bin_max_y; y++)
+        {
+            size_t row_offset = (size_t)y * m_width;
+            std::fill(m_color_buffer.begin() + row_offset + bin_min_x, m_color_buffer.begin() + row_offset + bin_max_x + 1, m_clear_color);
+            std::fill(m_depth_buffer.begin() + row_offset + bin_min_x, m_depth_buffer.begin() + row_offset + bin_max_x + 1, m_clear_depth);
+        }
+    }
+
+    SoftwareFragments fragments;
+    SoftwareColors colors;
+    uint32_t fragment_count = 0;
+    for (uint32_t triangle_idx : m_bins[bin_idx])
+    {
+        const SoftwareTriangle& triangle = m_triangles[triangle_idx];
+        const SoftwareDraw& draw_state = m_draws[triangle.draw_idx];
+        const void* uniforms = m_uniform_data.data() + draw_state.uniform_offset;
+        int32_t min_x = std::max(triangle.min_x, bin_min_x);
+        int32_t min_y = std::max(triangle.min_y, bin_min_y);
+        int32_t max_x = std::min(triangle.max_x, bin_max_x);
+        int32_t max_y = std::min(triangle.max_y, bin_max_y);
+
+        for (int32_t tile_y = min_y / tile_size * tile_size; tile_y <= max_y; tile_y += tile_size)
+        {
+            for (int32_t tile_x = min_x / tile_size * tile_size; tile_x <= max_x; tile_x += tile_size)
+            {
+                // Test the tile's corner pixels: skip it when all lie outside one edge, drop the edge tests when all lie inside every edge
+                bool covered = true, rejected = false;
+                for (uint32_t edge_idx = 0; edge_idx < 3 && !rejected; edge_idx++)
+                {
+                    float corner_min = INFINITY, corner_max = -INFINITY;
+                    for (int32_t corner = 0; corner < 4; corner++)
+                    {
+                        float value = evaluate_edge(triangle, edge_idx, tile_x + (corner & 1 ? tile_size - 0.5f : 0.5f), tile_y + (corner & 2 ? tile_size - 0.5f : 0.5f));
+                        corner_min = std::min(corner_min, value);
+                        corner_max = std::max(corner_max, value);
+                    }
+                    float margin = (std::fabs(triangle.edge_dx[edge_idx]) + std::fabs(triangle.edge_dy[edge_idx])) * SOFTWARE_TILE_EDGE_MARGIN;
+                    rejected = corner_max < -margin;
+                    covered &= corner_min > margin;
+                }
+                if (rejected)
+                    continue;
+
+                int32_t first_lane = std::max(min_x - tile_x, 0);
+                int32_t last_lane = std::min(max_x - tile_x, tile_size - 1);
+                uint32_t lane_mask = ((1u << (last_lane + 1)) - 1) & ~((1u << first_lane) - 1);
+                for (int32_t y = std::max(tile_y, min_y); y <= std::min(tile_y + tile_size - 1, max_y); y++)
+                {
+                    uint32_t mask = rasterize_row(triangle, tile_x, y, lane_mask, covered, draw_state.shader.varying_count, fragments);
+                    if (!mask)
+                        continue;
+
+                    size_t row_offset = (size_t)y * m_width + tile_x;
+                    if (draw_state.depth_test)
+                    {
+                        float* depth = m_depth_buffer.data() + row_offset;
+                        for (uint32_t lanes = mask; lanes; lanes &= lanes - 1)
+                        {
+                            uint32_t lane = (uint32_t)std::countr_zero(lanes);
+                            if (fragments.z[lane] < depth[lane])
+                                depth[lane] = fragments.z[lane];
+                            else
+                                mask &= ~(1u << lane);
+                        }
+                        if (!mask)
+                            continue;
+                    }
+
+                    fragments.mask = mask;
+                    draw_state.shader.fragment_shader(uniforms, fragments, colors);
+                    write_row(m_color_buffer.data() + row_offset, colors, mask);
+                    fragment_count += (uint32_t)std::popcount(mask);
+                }
+            }
+        }
+    }
+    return fragment_count;
+}
+
+
+void SoftwareRenderer::draw(const SoftwareMesh& mesh, const SoftwareShader& shader, const void* uniforms)
+{
+    PROFILE_ZONE("SoftwareRenderer::draw");
+
+    ASSERT(mesh.layout.count <= SOFTWARE_MAX_ATTRIBUTES && shader.varying_count <= SOFTWARE_MAX_VARYINGS);
+    JobSystem& job_system = JobSystem::get();
+    m_frame_stats.draw_calls++;
+
+    // State for the deferred rasterization; uniforms are copied, so the caller may change them right away
+    uint32_t draw_idx = (uint32_t)m_draws.size();
+    size_t uniform_offset = (m_uniform_data.size() + SOFTWARE_UNIFORM_ALIGNMENT - 1) / SOFTWARE_UNIFORM_ALIGNMENT * SOFTWARE_UNIFORM_ALIGNMENT;
+    m_uniform_data.resize(uniform_offset + shader.uniform_size);
+    if (shader.uniform_size)
+        memcpy(m_uniform_data.data() + uniform_offset, uniforms, shader.uniform_size);
+    m_draws.push_back({ shader, uniform_offset, m_depth_test });
+
+    // Vertex shading
+    m_vertices.resize(mesh.vertex_count);
+    job_system.parallel_for(mesh.vertex_count, [this, &mesh, &shader, uniforms](size_t begin, size_t end) {
+        float attributes[SOFTWARE_MAX_ATTRIBUTES][4];
+        for (size_t vertex_idx = begin; vertex_idx < end; vertex_idx++)
+        {
+            const uint8_t* vertex_data = mesh.vertex_data + vertex_idx * mesh.layout.stride;
+            for (uint32_t attribute_idx = 0; attribute_idx < mesh.layout.count; attribute_idx++)
+                decode_attribute(vertex_data, mesh.layout.elements[attribute_idx], attributes[attribute_idx]);
+            shader.vertex_shader(uniforms, attributes, m_vertices[vertex_idx]);
+        }
+    }, SOFTWARE_MIN_VERTICES_PER_JOB);
+
+    // Clipping and triangle setup after the queued triangles, each input triangle owning a fixed slot range
+    // so submission order is kept
+    uint32_t triangle_count = mesh.index_count / 3;
+    size_t first_slot = m_triangles.size();
+    m_triangles.resize(first_slot + (size_t)triangle_count * SOFTWARE_MAX_CLIPPED_TRIANGLES);
+    job_system.parallel_for(triangle_count, [this, &mesh, &shader, first_slot](size_t begin, size_t end) {
+        for (size_t triangle_idx = begin; triangle_idx < end; triangle_idx++)
+        {
+            const uint32_t* indices = mesh.index_data + triangle_idx * 3;
+            SoftwareTriangle* triangles = m_triangles.data() + first_slot + triangle_idx * SOFTWARE_MAX_CLIPPED_TRIANGLES;
+            if (indices[0] >= mesh.vertex_count || indices[1] >= mesh.vertex_count || indices[2] >= mesh.vertex_count)
+            {
+                for (uint32_t clipped_idx = 0; clipped_idx < SOFTWARE_MAX_CLIPPED_TRIANGLES; clipped_idx++)
+                    triangles[clipped_idx].valid = false;
+                continue;
+            }
+
+            const SoftwareVertex* const vertices[3] = { &m_vertices[indices[0]], &m_vertices[indices[1]], &m_vertices[indices[2]] };
+            setup_triangles(vertices, shader.varying_count, triangles);
+        }
+    }, SOFTWARE_MIN_TRIANGLES_PER_JOB);
+
+    // Binning, compacting the valid triangles to the front of the draw's slots
+    uint32_t binned_count = (uint32_t)first_slot;
+    for (uint32_t triangle_idx = (uint32_t)first_slot; triangle_idx < (uint32_t)m_triangles.size(); triangle_idx++)
+    {
+        if (!m_triangles[triangle_idx].valid)
+            continue;
+
+        SoftwareTriangle& triangle = m_triangles[binned_count];
+        if (binned_count != triangle_idx)
+            triangle = m_triangles[triangle_idx];
+        triangle.draw_idx = draw_idx;
+
+        m_frame_stats.triangles++;
+        for (uint32_t bin_y = triangle.min_y / SOFTWARE_BIN_SIZE; bin_y <= triangle.max_y / SOFTWARE_BIN_SIZE; bin_y++)
+        {
+            for (uint32_t bin_x = triangle.min_x / SOFTWARE_BIN_SIZE; bin_x <= triangle.max_x / SOFTWARE_BIN_SIZE; bin_x++)
+                m_bins[bin_y * m_bin_columns + bin_x].push_back(binned_count);
+        }
+        binned_count++;
+    }
+    m_triangles.resize(binned_count);
+}
+
+
+void SoftwareRenderer::flush()
+{
+    PROFILE_ZONE("SoftwareRenderer::flush");
+
+    if (m_draws.empty() && !m_clear_pending)
+        return;
+
+    // Rasterization (after the pending clear), one bin per job; bins own disjoint pixels and keep their
+    // triangles in submission order
+    std::atomic<uint32_t> fragment_count = 0;
+    JobSystem::get().parallel_for(m_bins.size(), [this, &fragment_count](size_t begin, size_t end) {
+        uint32_t range_fragment_count = 0;
+        for (size_t bin_idx = begin; bin_idx < end; bin_idx++)
+        {
+            if (m_clear_pending || !m_bins[bin_idx].empty())
+                range_fragment_count += rasterize_bin((uint32_t)bin_idx);
+        }
+        fragment_count.fetch_add(range_fragment_count, std::memory_order_relaxed);
+    });
+    m_frame_stats.fragments += fragment_count.load(std::memory_order_relaxed);
+
+    m_clear_pending = false;
+    discard_draws();
+}
+
+
+// Keeps every buffer's capacity, so steady-state frames don't allocate
+void SoftwareRenderer::discard_draws()
+{
+    for (std::vector<uint32_t>& bin : m_bins)
+        bin.clear();
+    m_triangles.clear();
+    m_draws.clear();
+    m_uniform_data.clear();
+}
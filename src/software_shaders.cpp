@@ -0,0 +1,36 @@
+#include "software_shaders.h"
+#include <cmath>
+
+
+static void example_vertex_shader(const void* uniforms, const float (*attributes)[4], SoftwareVertex& vertex)
+{
+    const SoftwareExampleUniforms& example_uniforms = *(const SoftwareExampleUniforms*)uniforms;
+    const float* matrix = example_uniforms.model_view_projection;
+    const float* position = attributes[0];
+    for (uint32_t row = 0; row < 4; row++)
+        vertex.position[row] = matrix[row] * position[0] + matrix[4 + row] * position[1] + matrix[8 + row] * position[2] + matrix[12 + row] * position[3];
+
+    vertex.varyings[0] = attributes[1][0];
+    vertex.varyings[1] = attributes[1][1];
+}
+
+
+static void example_fragment_shader(const void* uniforms, const SoftwareFragments& fragments, SoftwareColors& colors)
+{
+    const SoftwareExampleUniforms& example_uniforms = *(const SoftwareExampleUniforms*)uniforms;
+    float pulse = (std::sin(example_uniforms.time) + 1.0f) * 0.5f;
+
+    // Whole rows are blended; lanes outside the mask are discarded by the renderer
+    float texel0[4][SOFTWARE_TILE_SIZE] = {}, texel1[4][SOFTWARE_TILE_SIZE] = {};
+    example_uniforms.texture0->sample(fragments.varyings[0], fragments.varyings[1], fragments.mask, texel0);
+    example_uniforms.texture1->sample(fragments.varyings[0], fragments.varyings[1], fragments.mask, texel1);
+    for (uint32_t channel = 0; channel < 4; channel++)
+    {
+        float color = channel < 3 ? example_uniforms.color[channel] * pulse : 1.0f;
+        for (uint32_t lane = 0; lane < SOFTWARE_TILE_SIZE; lane++)
+            colors.rgba[channel][lane] = (color * 0.5f + texel0[channel][lane] * 0.5f) * 0.7f + texel1[channel][lane] * 0.3f;
+    }
+}
+
+
+const SoftwareShader software_example_shader = { example_vertex_shader, example_fragment_shader, 2, sizeof(SoftwareExampleUniforms) };
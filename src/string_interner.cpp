@@ -0,0 +1,40 @@
+#include "string_interner.h"
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+
+static std::shared_mutex s_interner_mutex;
+static std::deque<std::string> s_interned_strings;
+static std::unordered_map<std::string_view, uint32_t> s_interned_ids;
+
+
+uint32_t intern_string(std::string_view string)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(s_interner_mutex);
+        auto it = s_interned_ids.find(string);
+        if (it != s_interned_ids.end())
+            return it->second;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(s_interner_mutex);
+    auto it = s_interned_ids.find(string);
+    if (it != s_interned_ids.end())
+        return it->second;
+
+    // Strings live in a deque so the views used as map keys are never invalidated
+    uint32_t string_id = (uint32_t)s_interned_strings.size();
+    const std::string& interned_string = s_interned_strings.emplace_back(string);
+    s_interned_ids.emplace(interned_string, string_id);
+
+    return string_id;
+}
+
+
+const std::string& get_interned_string(uint32_t string_id)
+{
+    std::shared_lock<std::shared_mutex> lock(s_interner_mutex);
+    return s_interned_strings[string_id];
+}
@@ -1,9 +1,13 @@
 #include "texture_2d.h"
+#include <cstdio>
 #include <stb_image.h>
+#include "profiler.h"
+#include "hot_reload.h"
 
 
 GL_Texture2D::GL_Texture2D() :
-    m_gl_id(0), m_file_path(""), m_image_buffer(nullptr), m_width(0), m_height(0), m_channels(0)
+    m_gl_id(0), m_file_path(""), m_gl_texture_slot(0), m_flip_vertically(false), m_transparent(false), m_requested_channels(0),
+    m_width(0), m_height(0), m_channels(0)
 {
     GL_CALL(glGenTextures(1, &m_gl_id));
     ASSERT(m_gl_id);
@@ -19,33 +23,79 @@ GL_Texture2D::GL_Texture2D(uint32_t gl_texture_slot, const std::string& image_fi
 
 GL_Texture2D::~GL_Texture2D()
 {
+    HotReloader::notify_destroyed(this);
     GL_CALL(glDeleteTextures(1, &m_gl_id));
 }
 
 
 void GL_Texture2D::load_image(uint32_t gl_texture_slot, const std::string& image_file_path, bool flip_vertically, bool transparent, int32_t channels)
 {
-    // Load image
-    stbi_set_flip_vertically_on_load(flip_vertically);
-    m_image_buffer = stbi_load(image_file_path.c_str(), &m_width, &m_height, &m_channels, channels);
+    PROFILE_ZONE("GL_Texture2D::load_image");
+
     m_file_path = image_file_path;
+    m_gl_texture_slot = gl_texture_slot;
+    m_flip_vertically = flip_vertically;
+    m_transparent = transparent;
+    m_requested_channels = channels;
+
+    // Load image
+    GL_ImageData image_data = decode_image(image_file_path, flip_vertically, channels);
+
+    // Load image into texture
+    upload_image(image_data);
+
+    // Clear image buffer (which may be empty)
+    free_image(image_data);
+
+    HotReloader::notify_loaded(this);
+}
+
+
+void GL_Texture2D::upload_image(const GL_ImageData& image_data)
+{
+    m_width = image_data.width;
+    m_height = image_data.height;
+    m_channels = image_data.channels;
 
     // Bind texture
-    gl_bind(gl_texture_slot);
+    gl_bind(m_gl_texture_slot);
 
     // Configure texture
     GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
     GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP));
-    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
     // Load image into texture
-    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_width, m_height, 0, transparent ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, m_image_buffer));
+    GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, m_width, m_height, 0, m_transparent ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE, image_data.pixels));
     GL_CALL(glGenerateMipmap(GL_TEXTURE_2D));
+    if (image_data.pixels)
+        Profiler::get().count_upload((uint64_t)m_width * m_height * (m_transparent ? 4 : 3));
+}
 
-    // Clear image buffer (which may be empty)
-    if (m_image_buffer)
-        stbi_image_free(m_image_buffer);
+
+GL_ImageData GL_Texture2D::decode_image(const std::string& image_file_path, bool flip_vertically, int32_t channels)
+{
+    /**
+     * NOTE: the flip flag is set per-thread so images can be decoded off the GL thread concurrently
+     */
+    GL_ImageData image_data = {};
+    stbi_set_flip_vertically_on_load_thread(flip_vertically);
+    image_data.pixels = stbi_load(image_file_path.c_str(), &image_data.width, &image_data.height, &image_data.channels, channels);
+    if (!image_data.pixels)
+    {
+        fprintf(stderr, "ERROR | Failed to load image [%s]: %s\n", image_file_path.c_str(), stbi_failure_reason());
+    }
+
+    return image_data;
+}
+
+
+void GL_Texture2D::free_image(GL_ImageData& image_data)
+{
+    if (image_data.pixels)
+        stbi_image_free(image_data.pixels);
+    image_data.pixels = nullptr;
 }
 
 
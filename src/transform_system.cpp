@@ -0,0 +1,304 @@
+#include "transform_system.h"
+#include "renderer.h"
+#include <algorithm>
+#include "profiler.h"
+
+
+TransformSystem::TransformSystem() :
+    m_order_dirty(false), m_changed_begin(0), m_changed_end(0), m_uploaded_count(0)
+{
+}
+
+
+void TransformSystem::reserve(uint32_t count)
+{
+    for (std::vector<float>* component : { &m_position_x, &m_position_y, &m_position_z, &m_rotation_x, &m_rotation_y, &m_rotation_z, &m_rotation_w, &m_scale_x, &m_scale_y, &m_scale_z })
+        component->reserve(count);
+    for (std::vector<uint8_t>* flags : { &m_local_dirty, &m_subtree_dirty, &m_world_changed, &m_alive })
+        flags->reserve(count);
+    m_parents.reserve(count);
+    m_subtree_sizes.reserve(count);
+    m_world.reserve(count);
+    m_index_to_handle.reserve(count);
+    m_handle_to_index.reserve(count);
+}
+
+
+void TransformSystem::mark_dirty(uint32_t index)
+{
+    m_local_dirty[index] = 1;
+    for (uint32_t ancestor = index; ancestor != INVALID_INDEX && !m_subtree_dirty[ancestor]; ancestor = m_parents[ancestor])
+        m_subtree_dirty[ancestor] = 1;
+}
+
+
+TransformHandle TransformSystem::create(TransformHandle parent)
+{
+    uint32_t index = (uint32_t)m_index_to_handle.size();
+
+    TransformHandle handle;
+    if (!m_free_handles.empty())
+    {
+        handle = m_free_handles.back();
+        m_free_handles.pop_back();
+        m_handle_to_index[handle] = index;
+    }
+    else
+    {
+        handle = (TransformHandle)m_handle_to_index.size();
+        m_handle_to_index.push_back(index);
+    }
+    m_index_to_handle.push_back(handle);
+
+    m_position_x.push_back(0.0f);
+    m_position_y.push_back(0.0f);
+    m_position_z.push_back(0.0f);
+    m_rotation_x.push_back(0.0f);
+    m_rotation_y.push_back(0.0f);
+    m_rotation_z.push_back(0.0f);
+    m_rotation_w.push_back(1.0f);
+    m_scale_x.push_back(1.0f);
+    m_scale_y.push_back(1.0f);
+    m_scale_z.push_back(1.0f);
+
+    m_parents.push_back(parent == INVALID_HANDLE ? INVALID_INDEX : m_handle_to_index[parent]);
+    m_subtree_sizes.push_back(1);
+    m_local_dirty.push_back(0);
+    m_subtree_dirty.push_back(0);
+    m_world_changed.push_back(0);
+    m_alive.push_back(1);
+    m_world.push_back(mat4_identity());
+
+    // Roots appended at the end keep pre-order; children have to be moved behind their parent
+    if (parent != INVALID_HANDLE)
+        m_order_dirty = true;
+
+    mark_dirty(index);
+    return handle;
+}
+
+
+void TransformSystem::destroy(TransformHandle handle)
+{
+    // Descendants are dropped along with the node when the order is rebuilt
+    m_alive[m_handle_to_index[handle]] = 0;
+    m_order_dirty = true;
+}
+
+
+void TransformSystem::set_parent(TransformHandle handle, TransformHandle parent)
+{
+    uint32_t index = m_handle_to_index[handle];
+    uint32_t parent_index = parent == INVALID_HANDLE ? INVALID_INDEX : m_handle_to_index[parent];
+    for (uint32_t ancestor = parent_index; ancestor != INVALID_INDEX; ancestor = m_parents[ancestor])
+    {
+        if (ancestor == index)
+        {
+            fprintf(stderr, "ERROR | TransformSystem > Can't parent a node to its own descendant\n");
+            ASSERT(0);
+            return;
+        }
+    }
+
+    m_parents[index] = parent_index;
+    m_order_dirty = true;
+    mark_dirty(index);
+}
+
+
+void TransformSystem::set_position(TransformHandle handle, float x, float y, float z)
+{
+    uint32_t index = m_handle_to_index[handle];
+    m_position_x[index] = x;
+    m_position_y[index] = y;
+    m_position_z[index] = z;
+    mark_dirty(index);
+}
+
+
+void TransformSystem::set_rotation(TransformHandle handle, float x, float y, float z, float w)
+{
+    uint32_t index = m_handle_to_index[handle];
+    m_rotation_x[index] = x;
+    m_rotation_y[index] = y;
+    m_rotation_z[index] = z;
+    m_rotation_w[index] = w;
+    mark_dirty(index);
+}
+
+
+void TransformSystem::set_scale(TransformHandle handle, float x, float y, float z)
+{
+    uint32_t index = m_handle_to_index[handle];
+    m_scale_x[index] = x;
+    m_scale_y[index] = y;
+    m_scale_z[index] = z;
+    mark_dirty(index);
+}
+
+
+template<typename T>
+static void permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    std::vector<T> permuted(order.size());
+    for (size_t new_index = 0; new_index < order.size(); new_index++)
+        permuted[new_index] = values[order[new_index]];
+    values.swap(permuted);
+}
+
+
+void TransformSystem::rebuild_order()
+{
+    uint32_t count = (uint32_t)m_index_to_handle.size();
+
+    // Children of each live node (CSR), in index order
+    std::vector<uint32_t> child_offsets(count + 1, 0);
+    for (uint32_t index = 0; index < count; index++)
+    {
+        if (m_alive[index] && m_parents[index] != INVALID_INDEX)
+            child_offsets[m_parents[index] + 1]++;
+    }
+    for (uint32_t index = 0; index < count; index++)
+        child_offsets[index + 1] += child_offsets[index];
+
+    std::vector<uint32_t> children(child_offsets[count]);
+    std::vector<uint32_t> fill_offsets(child_offsets.begin(), child_offsets.end() - 1);
+    for (uint32_t index = 0; index < count; index++)
+    {
+        if (m_alive[index] && m_parents[index] != INVALID_INDEX)
+            children[fill_offsets[m_parents[index]]++] = index;
+    }
+
+    // Depth-first pre-order from every live root; dead nodes (and so their subtrees) are never reached
+    std::vector<uint32_t> order;
+    order.reserve(count);
+    std::vector<uint32_t> stack;
+    for (uint32_t root = 0; root < count; root++)
+    {
+        if (!m_alive[root] || m_parents[root] != INVALID_INDEX)
+            continue;
+
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            uint32_t index = stack.back();
+            stack.pop_back();
+            if (!m_alive[index])
+                continue;
+
+            order.push_back(index);
+            for (uint32_t child_idx = child_offsets[index + 1]; child_idx-- > child_offsets[index];)
+                stack.push_back(children[child_idx]);
+        }
+    }
+
+    // Free the handles of every node which was dropped
+    std::vector<uint32_t> new_indices(count, INVALID_INDEX);
+    for (uint32_t new_index = 0; new_index < (uint32_t)order.size(); new_index++)
+        new_indices[order[new_index]] = new_index;
+    for (uint32_t index = 0; index < count; index++)
+    {
+        if (new_indices[index] == INVALID_INDEX)
+        {
+            m_handle_to_index[m_index_to_handle[index]] = INVALID_INDEX;
+            m_free_handles.push_back(m_index_to_handle[index]);
+        }
+    }
+
+    for (std::vector<float>* component : { &m_position_x, &m_position_y, &m_position_z, &m_rotation_x, &m_rotation_y, &m_rotation_z, &m_rotation_w, &m_scale_x, &m_scale_y, &m_scale_z })
+        permute(*component, order);
+    for (std::vector<uint8_t>* flags : { &m_local_dirty, &m_world_changed, &m_alive })
+        permute(*flags, order);
+    permute(m_parents, order);
+    permute(m_world, order);
+    permute(m_index_to_handle, order);
+
+    uint32_t new_count = (uint32_t)order.size();
+    for (uint32_t index = 0; index < new_count; index++)
+    {
+        if (m_parents[index] != INVALID_INDEX)
+            m_parents[index] = new_indices[m_parents[index]];
+        m_handle_to_index[m_index_to_handle[index]] = index;
+    }
+
+    // Subtree sizes and dirty subtrees accumulate from the back, children before parents
+    m_subtree_sizes.assign(new_count, 1);
+    m_subtree_dirty.assign(m_local_dirty.begin(), m_local_dirty.end());
+    for (uint32_t index = new_count; index-- > 0;)
+    {
+        uint32_t parent = m_parents[index];
+        if (parent == INVALID_INDEX)
+            continue;
+        m_subtree_sizes[parent] += m_subtree_sizes[index];
+        m_subtree_dirty[parent] |= m_subtree_dirty[index];
+    }
+
+    // Every instance moved, so the next upload has to be a full one
+    m_uploaded_count = 0;
+    m_order_dirty = false;
+}
+
+
+void TransformSystem::update()
+{
+    PROFILE_ZONE("TransformSystem::update");
+
+    if (m_order_dirty)
+        rebuild_order();
+
+    uint32_t count = (uint32_t)m_index_to_handle.size();
+    m_changed_begin = count;
+    m_changed_end = 0;
+
+    /**
+     * A node is visited when something in its subtree changed or its parent's world matrix did; its parent
+     * is always visited first, so `m_world_changed[parent]` is up to date whenever it is read
+     */
+    uint32_t index = 0;
+    while (index < count)
+    {
+        uint32_t parent = m_parents[index];
+        bool parent_changed = parent != INVALID_INDEX && m_world_changed[parent];
+        if (!m_subtree_dirty[index] && !parent_changed)
+        {
+            index += m_subtree_sizes[index];
+            continue;
+        }
+
+        bool changed = m_local_dirty[index] || parent_changed;
+        if (changed)
+        {
+            const float position[3] = { m_position_x[index], m_position_y[index], m_position_z[index] };
+            const float rotation[4] = { m_rotation_x[index], m_rotation_y[index], m_rotation_z[index], m_rotation_w[index] };
+            const float scale[3] = { m_scale_x[index], m_scale_y[index], m_scale_z[index] };
+            Mat4 local = mat4_from_trs(position, rotation, scale);
+            m_world[index] = parent == INVALID_INDEX ? local : mat4_multiply(m_world[parent], local);
+
+            m_changed_begin = std::min(m_changed_begin, index);
+            m_changed_end = index + 1;
+        }
+
+        m_world_changed[index] = changed;
+        m_local_dirty[index] = 0;
+        m_subtree_dirty[index] = 0;
+        index++;
+    }
+}
+
+
+void TransformSystem::upload(GL_DataBuffer<float>* instance_buffer)
+{
+    const uint32_t floats_per_matrix = 16;
+    uint32_t count = (uint32_t)m_index_to_handle.size();
+
+    if (m_uploaded_count != count || instance_buffer->get_count() < count * floats_per_matrix)
+    {
+        uint32_t gl_buffer_type = instance_buffer->get_type() ? instance_buffer->get_type() : GL_ARRAY_BUFFER;
+        instance_buffer->set_data(gl_buffer_type, count * floats_per_matrix, m_world.data()->m, GL_DYNAMIC_DRAW);
+        m_uploaded_count = count;
+        return;
+    }
+
+    if (m_changed_begin < m_changed_end)
+        instance_buffer->update_data(m_changed_begin * floats_per_matrix, (m_changed_end - m_changed_begin) * floats_per_matrix, m_world[m_changed_begin].m);
+}
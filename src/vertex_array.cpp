@@ -1,6 +1,5 @@
 #include "vertex_array.h"
 #include "renderer.h"
-#include <type_traits>
 #include "gl_utils.h"
 
 
@@ -29,25 +28,29 @@ GL_VertexArray<T>::~GL_VertexArray()
 
 template<typename T>
 void GL_VertexArray<T>::set_buffer(GL_AttribArray* attrib_array, GL_DataBuffer<T>* data_buffer)
+{
+    set_buffer(attrib_array->get_table(), data_buffer);
+}
+
+
+template<typename T>
+void GL_VertexArray<T>::set_buffer(const GL_LayoutTable& layout, GL_DataBuffer<T>* data_buffer)
 {
     GL_CALL(glBindVertexArray(m_gl_id));
     data_buffer->bind();
 
-    uint32_t attrib_offset = 0;
-    for (uint32_t idx = 0; idx < attrib_array->get_count(); idx++)
+    for (uint32_t idx = 0; idx < layout.count; idx++)
     {
-        const GL_AttribElement& current_attrib = attrib_array->get(idx);
+        const GL_AttribElement& current_attrib = layout.elements[idx];
 
         GL_CALL(glVertexAttribPointer(
             idx,
             current_attrib.component_count,
             current_attrib.gl_type,
             current_attrib.normalized,
-            attrib_array->get_stride(),
-            (const void*)attrib_offset));
+            layout.stride,
+            (const void*)(uintptr_t)current_attrib.offset));
         GL_CALL(glEnableVertexAttribArray(idx));
-
-        attrib_offset += current_attrib.stride;
     }
 }
 
@@ -74,4 +77,6 @@ template class GL_VertexArray<int32_t>;
 template class GL_VertexArray<uint32_t>;
 template class GL_VertexArray<float>;
 template class GL_VertexArray<double>;
+template class GL_VertexArray<GL_Half>;
+template class GL_VertexArray<GL_Packed_2_10_10_10>;
 template class GL_VertexArray<int32_t>;
@@ -0,0 +1,118 @@
+#include "vertex_format.h"
+#include "renderer.h"
+
+
+uint64_t hash_layout(const GL_LayoutTable& layout)
+{
+    // FNV-1a over the fields which affect the VAO format state
+    uint64_t hash = 0xcbf29ce484222325ull;
+    auto hash_value = [&hash](uint32_t value) {
+        for (uint32_t byte_idx = 0; byte_idx < 4; byte_idx++)
+        {
+            hash ^= (value >> (byte_idx * 8)) & 0xff;
+            hash *= 0x100000001b3ull;
+        }
+    };
+
+    hash_value(layout.count);
+    hash_value(layout.stride);
+    for (uint32_t idx = 0; idx < layout.count; idx++)
+    {
+        const GL_AttribElement& element = layout.elements[idx];
+        hash_value(element.component_count);
+        hash_value(element.gl_type);
+        hash_value((uint32_t)element.normalized);
+        hash_value(element.offset);
+    }
+
+    return hash;
+}
+
+
+GL_VertexFormat::GL_VertexFormat(const GL_LayoutTable& layout) :
+    m_gl_id(0), m_hash(hash_layout(layout)), m_stride(layout.stride), m_elements(layout.elements, layout.elements + layout.count)
+{
+    GL_CALL(glGenVertexArrays(1, &m_gl_id));
+    ASSERT(m_gl_id);
+
+    GL_CALL(glBindVertexArray(m_gl_id));
+    for (uint32_t idx = 0; idx < layout.count; idx++)
+    {
+        const GL_AttribElement& current_attrib = layout.elements[idx];
+
+        /**
+         * NOTE: integer attributes which aren't normalized would need `glVertexAttribIFormat`; like
+         * `GL_VertexArray`, every attribute here is read as floating point by the shader
+         */
+        GL_CALL(glVertexAttribFormat(
+            idx,
+            current_attrib.component_count,
+            current_attrib.gl_type,
+            current_attrib.normalized,
+            current_attrib.offset));
+        GL_CALL(glVertexAttribBinding(idx, 0));
+        GL_CALL(glEnableVertexAttribArray(idx));
+    }
+    GL_CALL(glBindVertexArray(0));
+}
+
+
+GL_VertexFormat::~GL_VertexFormat()
+{
+    GL_CALL(glDeleteVertexArrays(1, &m_gl_id));
+}
+
+
+bool GL_VertexFormat::matches(const GL_LayoutTable& layout) const
+{
+    if (layout.count != m_elements.size() || layout.stride != m_stride)
+        return false;
+
+    for (uint32_t idx = 0; idx < layout.count; idx++)
+    {
+        const GL_AttribElement& lhs = layout.elements[idx];
+        const GL_AttribElement& rhs = m_elements[idx];
+        if (lhs.component_count != rhs.component_count ||
+            lhs.gl_type != rhs.gl_type ||
+            lhs.normalized != rhs.normalized ||
+            lhs.offset != rhs.offset)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+void GL_VertexFormat::bind() const
+{
+    GL_CALL(glBindVertexArray(m_gl_id));
+}
+
+
+void GL_VertexFormat::unbind() const
+{
+    GL_CALL(glBindVertexArray(0));
+}
+
+
+const GL_VertexFormat* GL_VertexFormatCache::get(const GL_LayoutTable& layout)
+{
+    uint64_t hash = hash_layout(layout);
+
+    auto range = m_formats.equal_range(hash);
+    for (auto it = range.first; it != range.second; it++)
+    {
+        if (it->second->matches(layout))
+            return it->second.get();
+    }
+
+    return m_formats.emplace(hash, std::make_unique<GL_VertexFormat>(layout))->second.get();
+}
+
+
+void GL_VertexFormatCache::clear()
+{
+    m_formats.clear();
+}
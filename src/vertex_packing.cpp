@@ -0,0 +1,280 @@
+#include "vertex_packing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "simd_utils.h"
+
+
+static inline uint32_t float_bits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+
+static inline float bits_float(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+
+/**
+ * Round-to-nearest-even float -> half conversion (matches `_mm_cvtps_ph` with `_MM_FROUND_TO_NEAREST_INT`)
+ */
+static inline uint16_t float_to_half_bits(float value)
+{
+    const uint32_t f32_infinity = 255u << 23;
+    const uint32_t f16_overflow = (127u + 16u) << 23;
+    const uint32_t denormal_magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t bits = float_bits(value);
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half_bits;
+    if (bits >= f16_overflow)
+    {
+        // Infinity or NaN (quiet NaNs stay NaN)
+        half_bits = bits > f32_infinity ? 0x7e00 : 0x7c00;
+    }
+    else if (bits < (113u << 23))
+    {
+        // Denormal or zero; the FPU does the rounding by adding a magic constant
+        half_bits = (uint16_t)(float_bits(bits_float(bits) + bits_float(denormal_magic)) - denormal_magic);
+    }
+    else
+    {
+        uint32_t mantissa_odd = (bits >> 13) & 1;
+        bits += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        bits += mantissa_odd;
+        half_bits = (uint16_t)(bits >> 13);
+    }
+
+    return half_bits | (uint16_t)(sign >> 16);
+}
+
+
+static inline int32_t pack_snorm(float value, float scale)
+{
+    return (int32_t)std::nearbyint(std::clamp(value, -1.0f, 1.0f) * scale);
+}
+
+
+float unpack_half(GL_Half value)
+{
+    uint32_t sign = (uint32_t)(value.bits & 0x8000) << 16;
+    uint32_t exponent = (value.bits >> 10) & 0x1f;
+    uint32_t mantissa = value.bits & 0x3ff;
+
+    if (exponent == 0x1f)
+        return bits_float(sign | 0x7f800000u | (mantissa << 13));
+    if (exponent == 0)
+        return (sign ? -1.0f : 1.0f) * std::ldexp((float)mantissa, -24);
+
+    return bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+
+void pack_half(const float* src, GL_Half* dst, size_t count)
+{
+    size_t idx = 0;
+
+#if defined(SIMD_AVX2)
+    for (; idx + 8 <= count; idx += 8)
+    {
+        __m128i half_values = _mm256_cvtps_ph(_mm256_loadu_ps(src + idx), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128((__m128i*)(dst + idx), half_values);
+    }
+#endif
+
+#if defined(SIMD_F16C)
+    for (; idx + 4 <= count; idx += 4)
+    {
+        __m128i half_values = _mm_cvtps_ph(_mm_loadu_ps(src + idx), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storel_epi64((__m128i*)(dst + idx), half_values);
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        dst[idx].bits = float_to_half_bits(src[idx]);
+    }
+}
+
+
+void pack_snorm16(const float* src, int16_t* dst, size_t count)
+{
+    size_t idx = 0;
+
+#if defined(SIMD_AVX2)
+    const __m256 min_value_8 = _mm256_set1_ps(-1.0f);
+    const __m256 max_value_8 = _mm256_set1_ps(1.0f);
+    const __m256 scale_8 = _mm256_set1_ps(32767.0f);
+    for (; idx + 8 <= count; idx += 8)
+    {
+        __m256 values = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(src + idx), min_value_8), max_value_8);
+        __m256i integers = _mm256_cvtps_epi32(_mm256_mul_ps(values, scale_8));
+        __m128i shorts = _mm_packs_epi32(_mm256_castsi256_si128(integers), _mm256_extracti128_si256(integers, 1));
+        _mm_storeu_si128((__m128i*)(dst + idx), shorts);
+    }
+#endif
+
+#if defined(SIMD_SSE2)
+    const __m128 min_value = _mm_set1_ps(-1.0f);
+    const __m128 max_value = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; idx + 8 <= count; idx += 8)
+    {
+        __m128 values0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + idx), min_value), max_value);
+        __m128 values1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + idx + 4), min_value), max_value);
+        __m128i shorts = _mm_packs_epi32(_mm_cvtps_epi32(_mm_mul_ps(values0, scale)), _mm_cvtps_epi32(_mm_mul_ps(values1, scale)));
+        _mm_storeu_si128((__m128i*)(dst + idx), shorts);
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        dst[idx] = (int16_t)pack_snorm(src[idx], 32767.0f);
+    }
+}
+
+
+void pack_snorm8(const float* src, int8_t* dst, size_t count)
+{
+    size_t idx = 0;
+
+#if defined(SIMD_SSE2)
+    const __m128 min_value = _mm_set1_ps(-1.0f);
+    const __m128 max_value = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(127.0f);
+    for (; idx + 16 <= count; idx += 16)
+    {
+        __m128i integers[4];
+        for (uint32_t lane = 0; lane < 4; lane++)
+        {
+            __m128 values = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + idx + lane * 4), min_value), max_value);
+            integers[lane] = _mm_cvtps_epi32(_mm_mul_ps(values, scale));
+        }
+        __m128i bytes = _mm_packs_epi16(_mm_packs_epi32(integers[0], integers[1]), _mm_packs_epi32(integers[2], integers[3]));
+        _mm_storeu_si128((__m128i*)(dst + idx), bytes);
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        dst[idx] = (int8_t)pack_snorm(src[idx], 127.0f);
+    }
+}
+
+
+void pack_unorm16(const float* src, uint16_t* dst, size_t count)
+{
+    size_t idx = 0;
+
+#if defined(SIMD_SSE2)
+    /**
+     * NOTE: SSE2 has no unsigned 32 -> 16 bit pack, so values are biased into signed range, packed with
+     * saturation and flipped back by toggling the sign bit
+     */
+    const __m128 min_value = _mm_setzero_ps();
+    const __m128 max_value = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    const __m128i bias = _mm_set1_epi32(32768);
+    const __m128i sign_flip = _mm_set1_epi16((short)0x8000);
+    for (; idx + 8 <= count; idx += 8)
+    {
+        __m128 values0 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + idx), min_value), max_value);
+        __m128 values1 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + idx + 4), min_value), max_value);
+        __m128i integers0 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(values0, scale)), bias);
+        __m128i integers1 = _mm_sub_epi32(_mm_cvtps_epi32(_mm_mul_ps(values1, scale)), bias);
+        __m128i shorts = _mm_xor_si128(_mm_packs_epi32(integers0, integers1), sign_flip);
+        _mm_storeu_si128((__m128i*)(dst + idx), shorts);
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        dst[idx] = (uint16_t)std::nearbyint(std::clamp(src[idx], 0.0f, 1.0f) * 65535.0f);
+    }
+}
+
+
+void pack_snorm_2_10_10_10(const float* src, uint32_t src_components, GL_Packed_2_10_10_10* dst, size_t count)
+{
+    size_t idx = 0;
+
+#if defined(SIMD_SSE2)
+    const __m128 min_value = _mm_set1_ps(-1.0f);
+    const __m128 max_value = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128i mask_10 = _mm_set1_epi32(0x3ff);
+    const __m128i mask_2 = _mm_set1_epi32(0x3);
+    for (; idx + 4 <= count; idx += 4)
+    {
+        // Transpose 4 vectors into x/y/z/w lanes
+        const float* v0 = src + (idx + 0) * src_components;
+        const float* v1 = src + (idx + 1) * src_components;
+        const float* v2 = src + (idx + 2) * src_components;
+        const float* v3 = src + (idx + 3) * src_components;
+        __m128 x = _mm_set_ps(v3[0], v2[0], v1[0], v0[0]);
+        __m128 y = _mm_set_ps(v3[1], v2[1], v1[1], v0[1]);
+        __m128 z = _mm_set_ps(v3[2], v2[2], v1[2], v0[2]);
+        __m128 w = src_components == 4 ? _mm_set_ps(v3[3], v2[3], v1[3], v0[3]) : _mm_setzero_ps();
+
+        __m128i xi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, min_value), max_value), scale));
+        __m128i yi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, min_value), max_value), scale));
+        __m128i zi = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(z, min_value), max_value), scale));
+        __m128i wi = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(w, min_value), max_value));
+
+        __m128i packed = _mm_and_si128(xi, mask_10);
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(yi, mask_10), 10));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(zi, mask_10), 20));
+        packed = _mm_or_si128(packed, _mm_slli_epi32(_mm_and_si128(wi, mask_2), 30));
+        _mm_storeu_si128((__m128i*)(dst + idx), packed);
+    }
+#endif
+
+    for (; idx < count; idx++)
+    {
+        const float* vector = src + idx * src_components;
+        uint32_t x = (uint32_t)pack_snorm(vector[0], 511.0f) & 0x3ff;
+        uint32_t y = (uint32_t)pack_snorm(vector[1], 511.0f) & 0x3ff;
+        uint32_t z = (uint32_t)pack_snorm(vector[2], 511.0f) & 0x3ff;
+        uint32_t w = (uint32_t)(src_components == 4 ? pack_snorm(vector[3], 1.0f) : 0) & 0x3;
+        dst[idx].bits = x | (y << 10) | (z << 20) | (w << 30);
+    }
+}
+
+
+void pack_vertices(const float* positions, const float* normals, const float* uvs, GL_PackedVertex* dst, size_t count)
+{
+    // Convert in blocks small enough to stay in L1 before interleaving
+    const size_t block_size = 256;
+    GL_Half block_positions[block_size * 3];
+    GL_Packed_2_10_10_10 block_normals[block_size];
+    GL_Half block_uvs[block_size * 2];
+
+    const GL_Half half_one = { 0x3c00 };
+    for (size_t base = 0; base < count; base += block_size)
+    {
+        size_t block_count = std::min(block_size, count - base);
+        pack_half(positions + base * 3, block_positions, block_count * 3);
+        pack_snorm_2_10_10_10(normals + base * 3, 3, block_normals, block_count);
+        pack_half(uvs + base * 2, block_uvs, block_count * 2);
+
+        for (size_t idx = 0; idx < block_count; idx++)
+        {
+            GL_PackedVertex& vertex = dst[base + idx];
+            vertex.position[0] = block_positions[idx * 3 + 0];
+            vertex.position[1] = block_positions[idx * 3 + 1];
+            vertex.position[2] = block_positions[idx * 3 + 2];
+            vertex.position[3] = half_one;
+            vertex.normal = block_normals[idx];
+            vertex.uv[0] = block_uvs[idx * 2 + 0];
+            vertex.uv[1] = block_uvs[idx * 2 + 1];
+        }
+    }
+}